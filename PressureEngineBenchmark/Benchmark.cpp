@@ -0,0 +1,247 @@
+#include <chrono>
+#include "PressureEngineCore/PressureEngine.h"
+
+// Microbenchmarks for engine internals that do not need a window or GL context.
+// Build in release, results are printed to the console.
+
+namespace PressureEngineBenchmark {
+
+	using namespace Pressure;
+
+	class Benchmark {
+
+	private:
+		Random<float> r;
+
+	public:
+		Benchmark() : r(0, 1) {
+			frustumCulling();
+			hierarchicalCulling();
+			visibleShareCulling();
+			multiViewCulling();
+		}
+
+	private:
+		// Batched SIMD sphere test against the scalar per sphere path.
+		void frustumCulling() {
+			const unsigned int count = 1 << 20;
+			const unsigned int iterations = 20;
+
+			std::vector<float> x(count), y(count), z(count), radii(count);
+			for (unsigned int i = 0; i < count; i++) {
+				x[i] = r.next() * 1000 - 500;
+				y[i] = r.next() * 100 - 50;
+				z[i] = r.next() * 1000 - 500;
+				radii[i] = r.next() * 5;
+			}
+			std::vector<unsigned int> visible(count);
+
+			ViewFrustum frustum;
+			Vector3f position(0, 10, 0);
+			Matrix4f projectionView = createProjectionMatrix(16.f / 9.f);
+			projectionView.mul(Matrix4f().createViewMatrix(position, 10, 30, 0));
+			frustum.extractPlanes(projectionView);
+
+			unsigned int scalarVisible = 0;
+			double scalarTime = measure(iterations, [&]() {
+				scalarVisible = 0;
+				for (unsigned int i = 0; i < count; i++)
+					scalarVisible += frustum.sphereInFrustum(Vector3f(x[i], y[i], z[i]), radii[i]);
+			});
+
+			unsigned int batchedVisible = 0;
+			double batchedTime = measure(iterations, [&]() {
+				batchedVisible = frustum.cullSpheres(x.data(), y.data(), z.data(), radii.data(), count, visible.data());
+			});
+
+			std::cout << "Frustum culling, " << count << " spheres (" << batchedVisible << " visible):" << std::endl;
+			std::cout << "  scalar:  " << count / scalarTime / 1e6 << " M spheres/s" << std::endl;
+			std::cout << "  batched: " << count / batchedTime / 1e6 << " M spheres/s (" << scalarTime / batchedTime << "x)" << std::endl;
+			if (scalarVisible != batchedVisible)
+				std::cout << "  MISMATCH: scalar path found " << scalarVisible << " visible." << std::endl;
+		}
+
+		// AABBTree queries against the linear batched test over the whole scene.
+		// The world grows with the entity count at a constant density, so the visible count levels off once the world outgrows the far plane.
+		void hierarchicalCulling() {
+			const unsigned int iterations = 100;
+
+			ViewFrustum frustum;
+			Vector3f position(0, 10, 0);
+			Matrix4f projectionView = createProjectionMatrix(16.f / 9.f);
+			projectionView.mul(Matrix4f().createViewMatrix(position, 10, 30, 0));
+			frustum.extractPlanes(projectionView);
+
+			std::cout << "Hierarchical culling:" << std::endl;
+			for (unsigned int count : { 1000, 10000, 100000 }) {
+				const float extent = 4000 * std::sqrt(count / 100000.f);
+				std::vector<AABB> bounds;
+				std::vector<float> x(count), y(count), z(count), radii(count);
+				for (unsigned int i = 0; i < count; i++) {
+					Vector3f center(r.next() * extent - extent / 2, r.next() * 20, r.next() * extent - extent / 2);
+					float size = 1 + r.next() * 4;
+					bounds.emplace_back(Vector3f(center.x - size, center.y - size, center.z - size), Vector3f(center.x + size, center.y + size, center.z + size));
+					x[i] = center.x;
+					y[i] = center.y;
+					z[i] = center.z;
+					radii[i] = bounds.back().getRadius();
+				}
+				std::vector<unsigned int> visible(count);
+
+				AABBTree tree;
+				double buildTime = measure(1, [&]() {
+					tree.clear();
+					for (unsigned int i = 0; i < count; i++)
+						tree.insert(bounds[i], i);
+				});
+
+				unsigned int linearVisible = 0;
+				double linearTime = measure(iterations, [&]() {
+					linearVisible = frustum.cullSpheres(x.data(), y.data(), z.data(), radii.data(), count, visible.data());
+				});
+
+				unsigned int treeVisible = 0;
+				double treeTime = measure(iterations, [&]() {
+					treeVisible = 0;
+					tree.query(frustum, [&](unsigned int) { treeVisible++; });
+				});
+
+				std::cout << "  " << count << " entities, " << linearVisible << " visible (" << treeVisible << " through the tree), build " << buildTime * 1e3 << " ms:" << std::endl;
+				std::cout << "    linear: " << linearTime * 1e6 << " us" << std::endl;
+				std::cout << "    tree:   " << treeTime * 1e6 << " us (" << linearTime / treeTime << "x)" << std::endl;
+			}
+		}
+
+		// AABBTree queries against the linear batched test at a fixed entity count while the world grows, so the visible share drops.
+		// The share where the tree starts to win is SceneVisibility::LINEAR_SCAN_SHARE.
+		void visibleShareCulling() {
+			const unsigned int count = 100000;
+			const unsigned int iterations = 100;
+
+			ViewFrustum frustum;
+			Vector3f position(0, 10, 0);
+			Matrix4f projectionView = createProjectionMatrix(16.f / 9.f);
+			projectionView.mul(Matrix4f().createViewMatrix(position, 10, 30, 0));
+			frustum.extractPlanes(projectionView);
+
+			std::cout << "Visible share culling, " << count << " entities:" << std::endl;
+			for (float extent : { 2000.f, 2828.f, 3266.f, 3578.f, 4000.f, 5657.f, 8000.f, 11314.f, 16000.f, 22627.f }) {
+				std::vector<float> x(count), y(count), z(count), radii(count);
+				AABBTree tree;
+				for (unsigned int i = 0; i < count; i++) {
+					Vector3f center(r.next() * extent - extent / 2, r.next() * 20, r.next() * extent - extent / 2);
+					float size = 1 + r.next() * 4;
+					AABB bounds(Vector3f(center.x - size, center.y - size, center.z - size), Vector3f(center.x + size, center.y + size, center.z + size));
+					tree.insert(bounds, i);
+					x[i] = center.x;
+					y[i] = center.y;
+					z[i] = center.z;
+					radii[i] = bounds.getRadius();
+				}
+				std::vector<unsigned int> visible(count);
+
+				unsigned int linearVisible = 0;
+				double linearTime = measure(iterations, [&]() {
+					linearVisible = frustum.cullSpheres(x.data(), y.data(), z.data(), radii.data(), count, visible.data());
+				});
+
+				unsigned int treeVisible = 0;
+				double treeTime = measure(iterations, [&]() {
+					treeVisible = 0;
+					tree.query(frustum, [&](unsigned int) { treeVisible++; });
+				});
+
+				std::cout << "  " << linearVisible * 100.f / count << "% visible (" << linearVisible << ", " << treeVisible << " through the tree):" << std::endl;
+				std::cout << "    linear: " << linearTime * 1e6 << " us" << std::endl;
+				std::cout << "    tree:   " << treeTime * 1e6 << " us (" << linearTime / treeTime << "x)" << std::endl;
+			}
+		}
+
+		// One traversal testing several frustums per node against a separate query per view, like the main, water and shadow passes.
+		void multiViewCulling() {
+			const unsigned int count = 100000;
+			const unsigned int iterations = 100;
+			const float extent = 4000;
+
+			AABBTree tree;
+			for (unsigned int i = 0; i < count; i++) {
+				Vector3f center(r.next() * extent - extent / 2, r.next() * 20, r.next() * extent - extent / 2);
+				float size = 1 + r.next() * 4;
+				tree.insert(AABB(Vector3f(center.x - size, center.y - size, center.z - size), Vector3f(center.x + size, center.y + size, center.z + size)), i);
+			}
+
+			std::cout << "Multi-view culling, " << count << " entities:" << std::endl;
+			for (unsigned int viewCount : { 2, 4, 8 }) {
+				// Cameras close to each other, so the frustums overlap as much as main, reflection and shadow views do.
+				std::vector<ViewFrustum> frustums(viewCount);
+				std::vector<const ViewFrustum*> pointers;
+				std::vector<unsigned int> planeMasks(viewCount, ViewFrustum::ALL_PLANES);
+				Vector3f position(0, 10, 0);
+				for (unsigned int v = 0; v < viewCount; v++) {
+					Matrix4f projectionView = createProjectionMatrix(16.f / 9.f);
+					projectionView.mul(Matrix4f().createViewMatrix(position, 10 + v * 5.f, 30 + v * 10.f, 0));
+					frustums[v].extractPlanes(projectionView);
+					pointers.push_back(&frustums[v]);
+				}
+
+				unsigned int separateVisible = 0;
+				double separateTime = measure(iterations, [&]() {
+					separateVisible = 0;
+					for (const ViewFrustum& frustum : frustums)
+						tree.query(frustum, [&](unsigned int) { separateVisible++; });
+				});
+
+				unsigned int combinedVisible = 0;
+				double combinedTime = measure(iterations, [&]() {
+					combinedVisible = 0;
+					tree.query(pointers.data(), planeMasks.data(), (1 << viewCount) - 1, tree.getRoot(), [&](unsigned int, unsigned int viewMask) {
+						for (; viewMask; viewMask &= viewMask - 1)
+							combinedVisible++;
+					});
+				});
+
+				std::cout << "  " << viewCount << " views, " << separateVisible << " visible:" << std::endl;
+				std::cout << "    separate: " << separateTime * 1e6 << " us" << std::endl;
+				std::cout << "    combined: " << combinedTime * 1e6 << " us (" << separateTime / combinedTime << "x)" << std::endl;
+				if (separateVisible != combinedVisible)
+					std::cout << "  MISMATCH: combined query found " << combinedVisible << " visible." << std::endl;
+			}
+		}
+
+		// Same as Matrix4f::createProjectionMatrix without needing a window.
+		static Matrix4f createProjectionMatrix(const float aspectRatio) {
+			float yScale = 1.f / std::tan((float)Math::toRadians(PRESSURE_FOV / 2.f));
+			float frustumLength = PRESSURE_FAR_PLANE - PRESSURE_NEAR_PLANE;
+
+			Matrix4f projection;
+			projection.set(0, 0, yScale / aspectRatio);
+			projection.set(1, 1, yScale);
+			projection.set(2, 2, -((PRESSURE_FAR_PLANE + PRESSURE_NEAR_PLANE) / frustumLength));
+			projection.set(2, 3, -1.f);
+			projection.set(3, 2, -((2 * PRESSURE_FAR_PLANE * PRESSURE_NEAR_PLANE) / frustumLength));
+			projection.set(3, 3, 0.f);
+			return projection;
+		}
+
+		// Average seconds per iteration.
+		template <typename Function>
+		static double measure(const unsigned int iterations, Function function) {
+			function(); // Warm up.
+			auto start = std::chrono::high_resolution_clock::now();
+			for (unsigned int i = 0; i < iterations; i++)
+				function();
+			std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+			return elapsed.count() / iterations;
+		}
+
+	};
+
+}
+
+int main() {
+
+	PressureEngineBenchmark::Benchmark b;
+
+	return 0;
+
+}
\ No newline at end of file
@@ -1,4 +1,6 @@
 #pragma once
+#include <chrono>
+#include <atomic>
 
 #include "../../PressureEngineCore/Src/DllExport.h"
 #include "../../PressureEngineCore/Src/Constants.h"
@@ -8,6 +10,7 @@
 #include "../../PressureEngineCore/Src/Input\Input.h"
 #include "../../PressureEngineCore/Src/Graphics\GraphicsCommon.h"
 #include "../../PressureEngineCore/Src/Services\Properties.h"
+#include "../../PressureEngineCore/Src/Services\ThreadPool.h"
 #include <Windows.h>
 #include "../../PressureEngineCore/Src/Graphics\PostProcessing\PostProcessing.h"
 
@@ -17,17 +20,32 @@ namespace Pressure {
 
 	private:
 		bool m_Initialized = false;
+		std::unique_ptr<ThreadPool> m_ThreadPool = nullptr;
 		std::unique_ptr<Window> m_Window = nullptr;
 		std::unique_ptr<Loader> m_Loader = nullptr;
 		std::unique_ptr<Camera> m_Camera = nullptr;
+		// Copy of m_Camera the renderers look through, only changed between frames.
+		std::unique_ptr<Camera> m_RenderCamera = nullptr;
 		std::unique_ptr<MasterRenderer> m_Renderer = nullptr;
 		std::unique_ptr<GuiRenderer> m_GuiRenderer = nullptr;
 		std::unique_ptr<FrameBuffer> m_FrameBuffer = nullptr;
 		std::unique_ptr<FrameBuffer> m_OutputBuffer = nullptr;
 		std::unique_ptr<FrameBuffer> m_LightScatterBuffer = nullptr;
 
-		std::vector<Light> m_Lights;
-		std::vector<GuiTexture> m_Guis;
+		// Frame recorded until the render thread starts, it has snapshots of its own.
+		std::unique_ptr<FrameSnapshot> m_Frame = nullptr;
+		std::unique_ptr<RenderThread> m_RenderThread = nullptr;
+
+		std::chrono::steady_clock::time_point m_InitStart;
+		// Written by the thread drawing the frame, read by the game thread.
+		std::atomic<float> m_TimeToFirstFrame { 0 };
+		std::atomic<unsigned int> m_OccludedCount { 0 };
+		std::atomic<unsigned int> m_TriangleCount { 0 };
+		std::atomic<unsigned int> m_ShadowTriangleCount { 0 };
+		std::atomic<unsigned int> m_DrawCallCount { 0 };
+		std::atomic<unsigned int> m_StateChangeCount { 0 };
+		std::atomic<float> m_DepthPrePassTime { 0 };
+		std::atomic<float> m_EntityPassTime { 0 };
 
 	public:
 		// Always call this before anything else.
@@ -36,10 +54,15 @@ namespace Pressure {
 		// Called at start of every tick;
 		void tick();
 
-		// Adds to renderbatch.
-		void process(Entity& entity);
-		void process(std::vector<Entity>& entities);
+		// Entities are retained between frames, only call update() when an entity changes.
+		SceneHandle add(const Entity& entity);
+		std::vector<SceneHandle> add(const std::vector<Entity>& entities);
+		void remove(const SceneHandle& handle);
+		void update(const SceneHandle& handle, const Entity& entity);
+		// Belongs to the render thread once it runs.
+		Scene& getScene();
 
+		// Adds to renderbatch.
 		void process(Water& water);
 		void process(std::vector<Water>& waters);
 
@@ -51,12 +74,36 @@ namespace Pressure {
 		void process(std::vector<GuiTexture>& guis);
 
 		// Renders the scene after all elements are processed.
+		// With the render thread running this only hands the frame over and waits for the previous one to be drawn.
 		void render();
+		// Draws on a thread of its own from here on, one frame behind tick() and render(). Load every asset first,
+		// the calling thread gives up the GL context.
+		void startRenderThread();
+		inline bool isRenderThreadRunning() const { return m_RenderThread != nullptr; }
+		// Entities the occlusion culling removed from the last frame.
+		unsigned int getOccludedCount() const;
+		// Triangles the main entity pass and the shadow maps drew in the last frame, with the levels of detail picked.
+		unsigned int getTriangleCount() const;
+		unsigned int getShadowTriangleCount() const;
+		// Draw calls and vertex array, texture, culling and shader changes of the main entity pass in the last frame.
+		unsigned int getDrawCallCount() const;
+		unsigned int getStateChangeCount() const;
+		// Depth-only pass over opaque entities before they are shaded, starts out as the depthPrePass property says.
+		void setDepthPrePass(const bool enabled);
+		// GPU milliseconds of the entity depth pre-pass and colour pass of the main view, a few frames behind.
+		float getDepthPrePassTime() const;
+		float getEntityPassTime() const;
+		// Milliseconds from the start of init() to the end of the first render(), 0 before that.
+		inline float getTimeToFirstFrame() const { return m_TimeToFirstFrame; }
 
 		// Loads model.
 		RawModel loadObjModel(const char* fileName); // Filename excluding .obj extension.
+		// Entities of an occluder hide what is behind them from the camera on the CPU. Meant for large closed meshes like terrain and buildings.
+		RawModel loadOccluderModel(const char* fileName);
 		ModelTexture loadTexture(const char* filePath); // Filename including extension.
 		TexturedModel loadModel(const char* objName, const char* texturePath);
+		// Bakes billboards of the model, its entities are drawn with them from distance on.
+		void addImpostor(const TexturedModel& model, const float distance);
 		ParticleTexture loadParticleTexture(const char* filePath, const unsigned int numberOfRows, const bool additiveBlending = false);
 
 		Water generateWater(const Vector3f& position) const;
@@ -70,6 +117,9 @@ namespace Pressure {
 
 	private:
 		void enableErrorCallbacks();
+		FrameSnapshot& getFrame();
+		// Draws a recorded frame, on the render thread if it runs.
+		void drawFrame(FrameSnapshot& frame);
 
 	};
 
@@ -4,16 +4,24 @@
 namespace Pressure {
 
 	Entity::Entity(const TexturedModel& model, const Vector3f& position, const Vector3f& rotation, const float scale)
-		: m_Model(TexturedModel(model.getRawModel(), model.getTexture())), m_Rotation(rotation), m_RotationSpeed(0), m_Scale(scale), m_Bounds(model.getRawModel().getBounds().transform(position).scale(scale)), m_Position(position), m_Speed(Vector3f(0)), m_Acceleration(Vector3f(0))
-	{}
+		: m_Model(model), m_Rotation(rotation), m_RotationSpeed(0), m_Scale(scale), m_Bounds(model.getRawModel().getBounds()), m_Position(position), m_Speed(Vector3f(0)), m_Acceleration(Vector3f(0)) {
+		updateBounds();
+	}
 
 	void Entity::tick() {
+		if (!isMoving())
+			return;
 		m_Speed.add(m_Acceleration);
 		m_Position.add(m_Speed);
 		m_Rotation.add(m_RotationSpeed);
+		updateBounds();
+	}
+
+	bool Entity::isMoving() const {
+		return m_Speed != Vector3f(0) || m_Acceleration != Vector3f(0) || m_RotationSpeed != Vector3f(0);
 	}
 
-	TexturedModel Entity::getTexturedModel() const {
+	const TexturedModel& Entity::getTexturedModel() const {
 		return m_Model;
 	}
 
@@ -47,10 +55,12 @@ namespace Pressure {
 
 	void Entity::rotate(const float x, const float y, const float z) {
 		m_Rotation.add(x, y, z);
+		updateBounds();
 	}
 
 	void Entity::setRotation(const float x, const float y, const float z) {
 		m_Rotation.set(x, y, z);
+		updateBounds();
 	}
 
 	void Entity::setRotationSpeed(const float x, const float y, const float z) {
@@ -59,18 +69,22 @@ namespace Pressure {
 
 	void Entity::addScale(const float xyz) {
 		m_Scale += xyz;
+		updateBounds();
 	}
 
 	void Entity::setScale(const float xyz) {
 		this->m_Scale = xyz;
+		updateBounds();
 	}
 
 	void Entity::move(const float x, const float y, const float z) {
 		m_Position.add(x, y, z);
+		updateBounds();
 	}
 
 	void Entity::setPosition(const float x, const float y, const float z) {
 		m_Position.set(x, y, z);
+		updateBounds();
 	}
 
 	void Entity::setSpeed(const float x, const float y, const float z) {
@@ -81,4 +95,24 @@ namespace Pressure {
 		m_Acceleration.set(x, y, z);
 	}
 
+	void Entity::updateBounds() {
+		AABB modelBounds = m_Model.getRawModel().getBounds();
+		Vector3f min = modelBounds.getMin();
+		Vector3f max = modelBounds.getMax();
+		Matrix4f transformation = Matrix4f().createTransformationMatrix(m_Position, m_Rotation, m_Scale);
+
+		// Transforms an AABB by taking the extent of every column along each axis (Arvo's method).
+		Vector3f worldMin, worldMax;
+		for (int row = 0; row < 3; row++) {
+			worldMin[row] = worldMax[row] = transformation.get(3, row);
+			for (int col = 0; col < 3; col++) {
+				float a = transformation.get(col, row) * min[col];
+				float b = transformation.get(col, row) * max[col];
+				worldMin[row] += a < b ? a : b;
+				worldMax[row] += a < b ? b : a;
+			}
+		}
+		m_Bounds = AABB(worldMin, worldMax);
+	}
+
 }
\ No newline at end of file
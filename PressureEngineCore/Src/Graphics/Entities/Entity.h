@@ -23,8 +23,10 @@ namespace Pressure {
 		Entity(const TexturedModel& model, const Vector3f& position, const Vector3f& rotation, const float scale);
 
 		void tick();
+		// Whether tick() will change the entity.
+		bool isMoving() const;
 
-		TexturedModel getTexturedModel() const;
+		const TexturedModel& getTexturedModel() const;
 		Vector3f getRotation() const;
 		Vector3f getRotationSpeed() const;
 		float getScale() const;
@@ -47,6 +49,10 @@ namespace Pressure {
 		void setSpeed(const float x, const float y, const float z);
 		void setAcceleration(const float x, const float y, const float z);
 
+	private:
+		// Recomputes the world bounds from the model bounds and the current transformation.
+		void updateBounds();
+
 	};
 
 }
\ No newline at end of file
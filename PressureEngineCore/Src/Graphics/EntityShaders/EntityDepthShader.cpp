@@ -0,0 +1,27 @@
+#include "EntityDepthShader.h"
+#include "EntityShader.h"
+#include "EntityShaderSource.h"
+#include "EntityInstanceBuffer.h"
+
+namespace Pressure {
+
+	EntityDepthShader::EntityDepthShader(const unsigned int features) 
+		: m_Features(features) {
+		const std::string defines = (features & EntityShader::FEATURE_WIND) ? "#define WIND\n" : "";
+		Shader::loadShaders(addDefines(EntityShaderSource::depthVertexShader, defines), addDefines(EntityShaderSource::depthFragmentShader, defines));
+	}
+
+	void EntityDepthShader::bindAttributes() {
+		Shader::bindAttribute(0, "position");
+		Shader::bindAttribute(EntityInstanceBuffer::TRANSFORMATION_ATTRIBUTE, "transformationMatrix");
+	}
+
+	void EntityDepthShader::getAllUniformLocations() {
+		location_windModifier = Shader::getUniformLocation("windModifier");
+	}
+
+	void EntityDepthShader::loadWindModifier(const float windModifier) {
+		Shader::loadFloat(location_windModifier, windModifier);
+	}
+
+}
\ No newline at end of file
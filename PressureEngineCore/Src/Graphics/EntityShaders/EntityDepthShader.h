@@ -0,0 +1,30 @@
+#pragma once
+#include "../Shaders/Shader.h"
+
+namespace Pressure {
+
+	// Writes only the depth of opaque entities, for the pre-pass of EntityRenderer.
+	// Of the EntityShader features only FEATURE_WIND changes the depth, so it is the only one with a variant.
+	class EntityDepthShader : public Shader {
+
+	private:
+		const unsigned int m_Features;
+
+	public:
+		EntityDepthShader(const unsigned int features);
+
+		inline unsigned int getFeatures() const { return m_Features; }
+
+	protected:
+		virtual void bindAttributes() override;
+		virtual void getAllUniformLocations() override;
+
+	public:
+		void loadWindModifier(const float windModifier);
+
+	private:
+		int location_windModifier;
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "EntityInstanceBuffer.h"
+
+namespace Pressure {
+
+	const unsigned int EntityInstanceBuffer::TRANSFORMATION_ATTRIBUTE = 3;
+	const unsigned int EntityInstanceBuffer::INSTANCE_DATA_LENGTH = 16;
+
+	EntityInstanceBuffer::EntityInstanceBuffer()
+		: m_vbo(nullptr, INSTANCE_DATA_LENGTH * sizeof(float)) {
+		m_vbo.unbind();
+	}
+
+	void EntityInstanceBuffer::bind(const VertexArray& vertexArray) {
+		vertexArray.bind();
+		if (m_PreparedArrays.find(vertexArray.getID()) != m_PreparedArrays.end())
+			return;
+
+		for (unsigned int i = 0; i < 4; i++) {
+			m_vbo.addInstancedAttribute(TRANSFORMATION_ATTRIBUTE + i, 4, INSTANCE_DATA_LENGTH, i * 4);
+			glEnableVertexAttribArray(TRANSFORMATION_ATTRIBUTE + i);
+		}
+		m_PreparedArrays.insert(vertexArray.getID());
+	}
+
+	void EntityInstanceBuffer::upload(const float* instances, const unsigned int count) {
+		if (count > 0)
+			m_vbo.update(instances, count * INSTANCE_DATA_LENGTH * sizeof(float));
+	}
+
+	unsigned int EntityInstanceBuffer::upload(const std::vector<float>& instances) {
+		unsigned int count = instances.size() / INSTANCE_DATA_LENGTH;
+		upload(instances.data(), count);
+		return count;
+	}
+
+	void EntityInstanceBuffer::cleanUp() {
+		m_vbo.del();
+	}
+
+	void EntityInstanceBuffer::writeInstance(const Entity& entity, float* dest) {
+		Matrix4f matrix = Matrix4f().createTransformationMatrix(entity.getPosition(), entity.getRotation(), entity.getScale());
+		for (unsigned int i = 0; i < 16; i++)
+			dest[i] = matrix.get(i);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <unordered_set>
+#include "../GLObjects/GLObjects.h"
+#include "../Entities/Entity.h"
+
+namespace Pressure {
+
+	// Per-instance data for instanced entity draws.
+	// Layout: mat4 transformationMatrix (attributes 3-6). Wind and fake lighting are per model, compiled into the EntityShader variant.
+	class EntityInstanceBuffer {
+
+	public:
+		const static unsigned int TRANSFORMATION_ATTRIBUTE;
+		const static unsigned int INSTANCE_DATA_LENGTH;
+
+	private:
+		VertexBuffer m_vbo;
+
+		// Vertex arrays that already have the instanced attributes pointed at m_vbo.
+		std::unordered_set<unsigned int> m_PreparedArrays;
+
+	public:
+		EntityInstanceBuffer();
+
+		// Binds the vertex array and attaches the instanced attributes to it the first time it is seen.
+		void bind(const VertexArray& vertexArray);
+
+		// Uploads count instances of INSTANCE_DATA_LENGTH floats each, as written by writeInstance().
+		void upload(const float* instances, const unsigned int count);
+		// Uploads already packed instance data directly, returns the instance count.
+		unsigned int upload(const std::vector<float>& instances);
+
+		void cleanUp();
+
+		// Packs the per-instance data of an entity into dest.
+		static void writeInstance(const Entity& entity, float* dest);
+
+	};
+
+}
\ No newline at end of file
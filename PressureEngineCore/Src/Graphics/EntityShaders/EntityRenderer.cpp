@@ -1,36 +1,96 @@
 #include "EntityRenderer.h"
+#include <algorithm>
 #include "../Textures\TextureManager.h"
-#include "../MasterRenderer.h"
+#include "../../Services/Properties.h"
 
 namespace Pressure {
+
+	const unsigned int EntityRenderer::KEY_CHUNK_SIZE = 1024;
+	const unsigned int EntityRenderer::FILL_CHUNK_SIZE = 4096;
+	const unsigned int EntityRenderer::DEPTH_PROGRAM = 1u << 31;
+	const unsigned int EntityRenderer::NO_PROGRAM = ~0u;
 	
-	EntityRenderer::EntityRenderer(EntityShader& shader, GLFWwindow* window)
-		: m_Shader(shader), m_Window(window), m_WindModifier(0) {
-		updateProjectionMatrix(shader);
-	}
-
-	void EntityRenderer::render(std::unordered_map<TexturedModel, std::vector<Entity>>& entities, Camera& camera) {
-		Matrix4f viewMatrix = Matrix4f().createViewMatrix(camera.getPosition(), camera.getPitch(), camera.getYaw(), camera.getRoll());
-		m_Shader.loadViewMatrix(viewMatrix);
-		ViewFrustum::Inst().extractPlanes(m_ProjectionMatrix.mul(viewMatrix, Matrix4f()));
-		for (auto const& model : entities) {
-			prepareTexturedModel(model.first);
-			std::vector<Entity>& batch = entities[model.first];
-			for (Entity& entity : batch) {
-				if (ViewFrustum::Inst().sphereInFrustum(entity.getBounds().getCenter(), entity.getBounds().getRadius() * 1.1f)) {
-					m_Shader.loadTransformationMatrix(Matrix4f().createTransformationMatrix(entity.getPosition(), entity.getRotation(), entity.getScale()));
-					glDrawElements(GL_TRIANGLES, model.first.getRawModel().getVertexCount(), GL_UNSIGNED_INT, 0);
-				}
+	EntityRenderer::EntityRenderer(EntityInstanceBuffer& instances, const Window& window, ThreadPool& threadPool, const bool multiDraw)
+		: m_Shader(nullptr), m_Instances(instances), m_Window(window), m_ThreadPool(threadPool), m_WindModifier(0), m_WaterLodBias(std::stof(Properties::get("lodWaterBias"))), m_MultiDraw(multiDraw),
+		m_DepthShader(nullptr), m_DepthPrePass(Properties::get("depthPrePass") == "1") {
+		updateProjectionMatrix();
+	}
+
+	void EntityRenderer::prepare(const Scene& scene, const Vector3f& cameraPosition, const std::vector<SceneEntry>& visible, const unsigned int passFeatures, const RenderQueue::Pass pass) {
+		PassData& data = m_Passes[pass];
+		data.features = passFeatures;
+		buildQueue(data, scene.getBatches(), cameraPosition, visible, pass);
+		fillInstanceData(data, scene.getBatches());
+	}
+
+	void EntityRenderer::record(const Scene& scene, const FrameUniforms& uniforms, const unsigned int view, const RenderQueue::Pass pass) {
+		const std::vector<SceneBatch>& batches = scene.getBatches();
+		PassData& data = m_Passes[pass];
+		data.statistics = Statistics();
+		data.list.clear();
+		uniforms.bindView(view, data.list);
+
+		// Nothing is known to be bound when the replay starts, except the culling MasterRenderer leaves enabled.
+		RecordState state = { NO_PROGRAM, 0, ~0u, false, 0, 0 };
+		if (m_MultiDraw)
+			buildCommands(data, batches);
+
+		// The water passes draw far less, only the main pass is worth a pre-pass and timing.
+		const bool mainPass = pass == RenderQueue::PASS_MAIN;
+		const unsigned int opaqueCount = getOpaqueCount(data, batches);
+		const bool prePass = m_DepthPrePass && mainPass && opaqueCount > 0;
+		if (prePass) {
+			data.list.beginTimer(m_DepthTimer);
+			recordDepth(data, state, batches, opaqueCount);
+			data.list.endTimer(m_DepthTimer);
+		}
+
+		if (mainPass)
+			data.list.beginTimer(m_ColorTimer);
+		if (m_MultiDraw) {
+			unsigned int opaqueSegments = 0;
+			while (opaqueSegments < data.segments.size() && !batches[data.segments[opaqueSegments].batch].model.getTexture().hasTransparency())
+				opaqueSegments++;
+			recordSegments(data, state, batches, 0, opaqueSegments);
+			if (prePass) {
+				data.list.depthFunc(GL_LESS);
+				data.list.depthMask(true);
 			}
-			unbindTexturedModel(model.first.getRawModel());
+			recordSegments(data, state, batches, opaqueSegments, data.segments.size());
+		} else {
+			recordBatches(data, state, batches, 0, opaqueCount);
+			if (prePass) {
+				data.list.depthFunc(GL_LESS);
+				data.list.depthMask(true);
+			}
+			recordBatches(data, state, batches, opaqueCount, data.queue.getItems().size());
+		}
+
+		if (!data.queue.getItems().empty()) {
+			data.list.cullFace(GL_BACK);
+			data.list.bindVertexArray(nullptr);
 		}
+		if (mainPass)
+			data.list.endTimer(m_ColorTimer);
+	}
+
+	void EntityRenderer::render(const RenderQueue::Pass pass) {
+		m_Shader = nullptr;
+		m_DepthShader = nullptr;
+		m_Passes[pass].list.replay(*this);
+	}
+
+	void EntityRenderer::updateProjectionMatrix() {
+		m_ProjectionMatrix.createProjectionMatrix(m_Window.getWidth(), m_Window.getHeight());
 	}
 
-	void EntityRenderer::updateProjectionMatrix(EntityShader& shader) {
-		m_ProjectionMatrix.createProjectionMatrix(m_Window);
-		shader.start();
-		shader.loadProjectionmatrix(m_ProjectionMatrix);
-		shader.stop();
+	void EntityRenderer::cleanUp() {
+		m_Shaders.cleanUp();
+		m_DepthShaders.cleanUp();
+		m_DepthTimer.del();
+		m_ColorTimer.del();
+		for (PassData& data : m_Passes)
+			data.commands.del();
 	}
 
 	void EntityRenderer::tick() {
@@ -39,30 +99,233 @@ namespace Pressure {
 			m_WindModifier -= 360;
 	}
 
-	void EntityRenderer::prepareTexturedModel(const TexturedModel& texturedModel) {
-		RawModel& model = texturedModel.getRawModel();
-		model.getVertexArray().bind();
-		glEnableVertexAttribArray(0);
-		glEnableVertexAttribArray(1);
-		glEnableVertexAttribArray(2);
-		glActiveTexture(GL_TEXTURE0);
-		if (texturedModel.getTexture().hasTransparency()) 
-			MasterRenderer::disableCulling();
-		if (texturedModel.getRawModel().isWindAffected())
-			m_Shader.loadWindModifier(m_WindModifier);
-		else m_Shader.loadWindModifier(0);
-		m_Shader.loadShineVariables(texturedModel.getTexture().getShineDamper(), texturedModel.getTexture().getReflectivity());
-		m_Shader.loadFakeLighting(texturedModel.getTexture().useFakeLighting());
-		TextureManager::Inst()->BindTexture(texturedModel.getTexture().getID());
-		setTexParams();
-	}
-
-	void EntityRenderer::unbindTexturedModel(const RawModel& model) {
-		MasterRenderer::enableCulling();
-		glDisableVertexAttribArray(0);
-		glDisableVertexAttribArray(1);
-		glDisableVertexAttribArray(2);
-		model.getVertexArray().unbind();
+	void EntityRenderer::bindProgram(const unsigned int program) {
+		if (program & DEPTH_PROGRAM) {
+			m_DepthShader = &m_DepthShaders.get(program & ~DEPTH_PROGRAM);
+			m_DepthShader->start();
+			if (program & EntityShader::FEATURE_WIND)
+				m_DepthShader->loadWindModifier(m_WindModifier);
+			return;
+		}
+
+		m_Shader = &m_Shaders.get(program);
+		m_Shader->start();
+		if (program & EntityShader::FEATURE_WIND)
+			m_Shader->loadWindModifier(m_WindModifier);
+	}
+
+	void EntityRenderer::bindVertexArray(const VertexArray* vertexArray) {
+		if (vertexArray)
+			m_Instances.bind(*vertexArray);
+		else
+			GLState::bindVertexArray(0);
+	}
+
+	void EntityRenderer::bindTexture(const unsigned int texture) {
+		GLState::activeTexture(GL_TEXTURE0);
+		TextureManager::Inst()->BindTexture(texture);
+		// Sampler parameters belong to the texture, they only have to be set once.
+		if (m_ConfiguredTextures.insert(texture).second)
+			setTexParams();
+	}
+
+	void EntityRenderer::loadMaterial(const float shineDamper, const float reflectivity) {
+		m_Shader->loadShineVariables(shineDamper, reflectivity);
+	}
+
+	void EntityRenderer::uploadInstances(const float* instances, const unsigned int count) {
+		m_Instances.upload(instances, count);
+	}
+
+	void EntityRenderer::buildQueue(PassData& data, const std::vector<SceneBatch>& batches, const Vector3f& cameraPosition, const std::vector<SceneEntry>& visible, const RenderQueue::Pass pass) {
+		// Share of the screen height a sphere of radius 1 at distance 1 spans.
+		const float lodScale = m_ProjectionMatrix.get(1, 1) * (pass == RenderQueue::PASS_MAIN ? 1 : m_WaterLodBias);
+		data.queue.resize(visible.size());
+		m_ThreadPool.parallelFor(visible.size(), KEY_CHUNK_SIZE, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				const SceneEntry& entry = visible[i];
+				const SceneBatch& batch = batches[entry.batch];
+				float dx = batch.centerX[entry.entry] - cameraPosition.getX();
+				float dy = batch.centerY[entry.entry] - cameraPosition.getY();
+				float dz = batch.centerZ[entry.entry] - cameraPosition.getZ();
+				float depth = std::sqrt(dx * dx + dy * dy + dz * dz);
+				unsigned int lod = batch.model.selectLod(batch.radius[entry.entry] * lodScale / std::max(depth, 0.001f));
+				// The levels of a mesh get neighbouring keys, so each is drawn as its own group.
+				uint64_t key = RenderQueue::makeKey(pass, batch.model.getTexture().hasTransparency(), EntityShader::getModelFeatures(batch.model), batch.model.getTexture().getID(),
+					batch.model.getRawModel().getMeshID() * RawModel::MAX_LODS + lod, depth);
+				data.queue.set(i, key, entry.batch, entry.entry, lod);
+			}
+		});
+		data.queue.sort();
+	}
+
+	void EntityRenderer::fillInstanceData(PassData& data, const std::vector<SceneBatch>& batches) {
+		const std::vector<RenderQueue::Item>& items = data.queue.getItems();
+		const unsigned int length = EntityInstanceBuffer::INSTANCE_DATA_LENGTH;
+		data.instanceData.resize(items.size() * length);
+		m_ThreadPool.parallelFor(items.size(), FILL_CHUNK_SIZE, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				const float* instance = &batches[items[i].batch].instanceData[items[i].entry * length];
+				std::copy(instance, instance + length, &data.instanceData[i * length]);
+			}
+		});
+	}
+
+	unsigned int EntityRenderer::getOpaqueCount(const PassData& data, const std::vector<SceneBatch>& batches) const {
+		const std::vector<RenderQueue::Item>& items = data.queue.getItems();
+		unsigned int count = 0;
+		while (count < items.size() && !batches[items[count].batch].model.getTexture().hasTransparency())
+			count++;
+		return count;
+	}
+
+	void EntityRenderer::recordDepth(PassData& data, RecordState& state, const std::vector<SceneBatch>& batches, const unsigned int opaqueCount) {
+		data.list.colorMask(false);
+
+		if (m_MultiDraw) {
+			// Without textures and shine, only a change of vertex array or wind splits the opaque commands.
+			const std::vector<DrawSegment>& segments = data.segments;
+			for (unsigned int i = 0; i < segments.size() && !batches[segments[i].batch].model.getTexture().hasTransparency();) {
+				const DrawSegment& first = segments[i];
+				const RawModel& model = batches[first.batch].model.getRawModel();
+				unsigned int count = 0;
+				while (i < segments.size() && !batches[segments[i].batch].model.getTexture().hasTransparency()
+					&& batches[segments[i].batch].model.getRawModel().getVertexArray().getID() == model.getVertexArray().getID()
+					&& batches[segments[i].batch].model.getRawModel().isWindAffected() == model.isWindAffected())
+					count += segments[i++].count;
+				recordProgram(data, state, DEPTH_PROGRAM | (model.isWindAffected() ? EntityShader::FEATURE_WIND : 0));
+				recordVertexArray(data, state, model);
+				data.list.multiDraw(data.commands, first.first, count, model.getIndexType());
+				data.statistics.depthDrawCalls++;
+			}
+		} else {
+			const std::vector<RenderQueue::Item>& items = data.queue.getItems();
+			for (unsigned int i = 0; i < opaqueCount;) {
+				const unsigned int first = i;
+				const unsigned int lod = items[first].lod;
+				while (i < opaqueCount && items[i].batch == items[first].batch && items[i].lod == lod)
+					i++;
+				data.list.uploadInstances(&data.instanceData[first * EntityInstanceBuffer::INSTANCE_DATA_LENGTH], i - first);
+
+				const RawModel& model = batches[items[first].batch].model.getRawModel();
+				recordProgram(data, state, DEPTH_PROGRAM | (model.isWindAffected() ? EntityShader::FEATURE_WIND : 0));
+				recordVertexArray(data, state, model);
+				data.list.draw(model.getLodIndexCount(lod), model.getIndexType(), model.getLodFirstIndex(lod), i - first, model.getBaseVertex());
+				data.statistics.depthDrawCalls++;
+			}
+		}
+
+		data.list.colorMask(true);
+		// Opaque pixels only pass where their own depth made it into the buffer.
+		data.list.depthFunc(GL_EQUAL);
+		data.list.depthMask(false);
+	}
+
+	void EntityRenderer::recordBatches(PassData& data, RecordState& state, const std::vector<SceneBatch>& batches, const unsigned int begin, const unsigned int end) {
+		const std::vector<RenderQueue::Item>& items = data.queue.getItems();
+		for (unsigned int i = begin; i < end;) {
+			const unsigned int first = i;
+			const SceneBatch& batch = batches[items[first].batch];
+
+			// Consecutive items of the same batch and level become one instanced draw.
+			const unsigned int lod = items[first].lod;
+			while (i < end && items[i].batch == items[first].batch && items[i].lod == lod)
+				i++;
+			unsigned int instanceCount = i - first;
+			data.list.uploadInstances(&data.instanceData[first * EntityInstanceBuffer::INSTANCE_DATA_LENGTH], instanceCount);
+
+			recordTexturedModel(data, state, batch.model);
+			const RawModel& model = batch.model.getRawModel();
+			data.list.draw(model.getLodIndexCount(lod), model.getIndexType(), model.getLodFirstIndex(lod), instanceCount, model.getBaseVertex());
+			data.statistics.drawCalls++;
+			data.statistics.triangles += model.getLodIndexCount(lod) / 3 * instanceCount;
+		}
+	}
+
+	void EntityRenderer::buildCommands(PassData& data, const std::vector<SceneBatch>& batches) {
+		// All instances go up at once, each command finds its own through baseInstance.
+		const std::vector<RenderQueue::Item>& items = data.queue.getItems();
+		data.list.uploadInstances(data.instanceData.data(), items.size());
+
+		data.commands.clear();
+		data.segments.clear();
+		for (unsigned int i = 0; i < items.size();) {
+			const unsigned int first = i;
+			const SceneBatch& batch = batches[items[first].batch];
+			const unsigned int lod = items[first].lod;
+			while (i < items.size() && items[i].batch == items[first].batch && items[i].lod == lod)
+				i++;
+
+			if (data.segments.empty() || !hasSameState(batches[data.segments.back().batch].model, batch.model))
+				data.segments.push_back({ items[first].batch, data.commands.size(), 0 });
+			const RawModel& model = batch.model.getRawModel();
+			data.commands.push({ model.getLodIndexCount(lod), i - first, model.getLodFirstIndex(lod), model.getBaseVertex(), first });
+			data.segments.back().count++;
+			data.statistics.triangles += model.getLodIndexCount(lod) / 3 * (i - first);
+		}
+		if (!data.segments.empty())
+			data.list.uploadCommands(data.commands);
+	}
+
+	void EntityRenderer::recordSegments(PassData& data, RecordState& state, const std::vector<SceneBatch>& batches, const unsigned int begin, const unsigned int end) {
+		for (unsigned int i = begin; i < end; i++) {
+			const DrawSegment& segment = data.segments[i];
+			recordTexturedModel(data, state, batches[segment.batch].model);
+			// A segment never spans vertex arrays, so it has one index type.
+			data.list.multiDraw(data.commands, segment.first, segment.count, batches[segment.batch].model.getRawModel().getIndexType());
+			data.statistics.drawCalls++;
+		}
+	}
+
+	bool EntityRenderer::hasSameState(const TexturedModel& a, const TexturedModel& b) {
+		const ModelTexture& textureA = a.getTexture();
+		const ModelTexture& textureB = b.getTexture();
+		return a.getRawModel().getVertexArray().getID() == b.getRawModel().getVertexArray().getID() && textureA.getID() == textureB.getID()
+			&& EntityShader::getModelFeatures(a) == EntityShader::getModelFeatures(b)
+			&& textureA.hasTransparency() == textureB.hasTransparency() && textureA.getShineDamper() == textureB.getShineDamper()
+			&& textureA.getReflectivity() == textureB.getReflectivity();
+	}
+
+	void EntityRenderer::recordVertexArray(PassData& data, RecordState& state, const RawModel& model) {
+		if (model.getVertexArray().getID() != state.vertexArray) {
+			data.list.bindVertexArray(&model.getVertexArray());
+			state.vertexArray = model.getVertexArray().getID();
+			data.statistics.vertexArrayBinds++;
+		}
+	}
+
+	void EntityRenderer::recordProgram(PassData& data, RecordState& state, const unsigned int program) {
+		if (program == state.program)
+			return;
+		data.list.bindProgram(program);
+		state.program = program;
+		// Shine is kept per program, the new one has to be given it again.
+		state.shineDamper = -1;
+		state.reflectivity = -1;
+		if (!(program & DEPTH_PROGRAM))
+			data.statistics.shaderBinds++;
+	}
+
+	void EntityRenderer::recordTexturedModel(PassData& data, RecordState& state, const TexturedModel& texturedModel) {
+		recordVertexArray(data, state, texturedModel.getRawModel());
+		recordProgram(data, state, data.features | EntityShader::getModelFeatures(texturedModel));
+
+		const ModelTexture& texture = texturedModel.getTexture();
+		if (texture.hasTransparency() != state.cullingDisabled) {
+			data.list.cullFace(texture.hasTransparency() ? 0 : GL_BACK);
+			state.cullingDisabled = texture.hasTransparency();
+			data.statistics.cullingChanges++;
+		}
+		if (texture.getShineDamper() != state.shineDamper || texture.getReflectivity() != state.reflectivity) {
+			data.list.loadMaterial(texture.getShineDamper(), texture.getReflectivity());
+			state.shineDamper = texture.getShineDamper();
+			state.reflectivity = texture.getReflectivity();
+		}
+		if (texture.getID() != state.texture) {
+			data.list.bindTexture(texture.getID());
+			state.texture = texture.getID();
+			data.statistics.textureBinds++;
+		}
 	}
 
 	void EntityRenderer::setTexParams() const {
@@ -1,35 +1,158 @@
 #pragma once
-#include <unordered_map>
 #include <vector>
+#include <unordered_set>
 
 #include "EntityShader.h"
+#include "EntityDepthShader.h"
+#include "EntityInstanceBuffer.h"
+#include "../Shaders/ShaderVariants.h"
 #include "../../Math/Math.h"
 #include "../Entities\Entity.h"
 #include "../Models\RawModel.h"
 #include "../Models\TexturedModel.h"
-#include "../../Math/Geometry/ViewFrustum.h"
+#include "../Scene/Scene.h"
+#include "../Scene/RenderQueue.h"
+#include "../Window.h"
+#include "../Shaders/FrameUniforms.h"
+#include "../GLObjects/CommandList.h"
+#include "../../Services/ThreadPool.h"
 
 namespace Pressure {
 
-	const class EntityRenderer {
+	// Draws a pass in three steps: prepare() queues the entities, record() turns the queue into a CommandList
+	// without touching GL and render() replays it. Passes are recorded at the same time on the thread pool,
+	// the thread owning the context only prepares and replays them.
+	const class EntityRenderer : public CommandList::Executor {
+
+	public:
+		// State changes recorded for a pass.
+		struct Statistics {
+			unsigned int drawCalls = 0;
+			unsigned int vertexArrayBinds = 0;
+			unsigned int textureBinds = 0;
+			unsigned int cullingChanges = 0;
+			unsigned int shaderBinds = 0;
+			unsigned int triangles = 0;
+			// Draws of the depth pre-pass, not part of drawCalls.
+			unsigned int depthDrawCalls = 0;
+		};
 
 	private:
+		// Consecutive indirect commands drawn with the same state by one multi-draw call.
+		struct DrawSegment {
+			unsigned int batch;
+			unsigned int first;
+			unsigned int count;
+		};
+
+		// Everything a pass needs from prepare() to render(), kept apart so the passes can be recorded at once.
+		struct PassData {
+			RenderQueue queue;
+			// Instance data of every queued item in queue order, so each draw uploads one contiguous range.
+			std::vector<float> instanceData;
+			IndirectBuffer commands;
+			std::vector<DrawSegment> segments;
+			CommandList list;
+			Statistics statistics;
+			unsigned int features;
+		};
+
+		// State the recorded commands leave bound, so that only changes are recorded.
+		struct RecordState {
+			unsigned int program;
+			unsigned int vertexArray;
+			unsigned int texture;
+			bool cullingDisabled;
+			float shineDamper;
+			float reflectivity;
+		};
+
+		const static unsigned int KEY_CHUNK_SIZE;
+		const static unsigned int FILL_CHUNK_SIZE;
+		// The main pass and the two water passes.
+		const static unsigned int PASS_COUNT = 3;
+		// Set in the recorded program of the depth pre-pass, the rest are the features of the variant.
+		const static unsigned int DEPTH_PROGRAM;
+		const static unsigned int NO_PROGRAM;
+
 		Matrix4f m_ProjectionMatrix;
-		EntityShader m_Shader;
-		GLFWwindow* const m_Window;
+		// One program per combination of model and pass features, the sort key keeps the batches of a variant together.
+		ShaderVariants<EntityShader> m_Shaders;
+		EntityShader* m_Shader;
+		EntityInstanceBuffer& m_Instances;
+		const Window& m_Window;
+		ThreadPool& m_ThreadPool;
 
 		float m_WindModifier;
+		// Scales the screen size of the entities in the water passes, below 1 picks coarser levels of detail.
+		const float m_WaterLodBias;
+
+		PassData m_Passes[PASS_COUNT];
+
+		// Submit whole state groups with glMultiDrawElementsIndirect instead of a draw per batch.
+		const bool m_MultiDraw;
+		std::unordered_set<unsigned int> m_ConfiguredTextures;
+
+		// Lays down the depth of the opaque entities of the main pass first, so they are shaded once per pixel.
+		ShaderVariants<EntityDepthShader> m_DepthShaders;
+		EntityDepthShader* m_DepthShader;
+		bool m_DepthPrePass;
+		// GPU time of the depth pre-pass and the colour pass of the main view.
+		TimerQuery m_DepthTimer;
+		TimerQuery m_ColorTimer;
 
 	public:
-		EntityRenderer(EntityShader& shader, GLFWwindow* window);
-		void render(std::unordered_map<TexturedModel, std::vector<Entity>>& entities, Camera& camera);
+		EntityRenderer(EntityInstanceBuffer& instances, const Window& window, ThreadPool& threadPool, const bool multiDraw);
+		// Queues the entities of visible, the list SceneVisibility computed for the view of the pass, split over the thread pool.
+		// passFeatures are the EntityShader features of the pass, combined with those of each model to pick the variant.
+		void prepare(const Scene& scene, const Vector3f& cameraPosition, const std::vector<SceneEntry>& visible, const unsigned int passFeatures, const RenderQueue::Pass pass);
+		// Records the draws of the prepared pass with the view of uniforms. Makes no GL calls and leaves the other passes alone,
+		// so each pass can be recorded on its own thread.
+		void record(const Scene& scene, const FrameUniforms& uniforms, const unsigned int view, const RenderQueue::Pass pass);
+		// Replays the recorded pass.
+		void render(const RenderQueue::Pass pass);
 
-		void updateProjectionMatrix(EntityShader& shader);
+		// The GPU copy goes out with the views in FrameUniforms.
+		void updateProjectionMatrix();
 		void tick();
+		void cleanUp();
+
+		inline void setDepthPrePass(const bool enabled) { m_DepthPrePass = enabled; }
+		inline bool isDepthPrePass() const { return m_DepthPrePass; }
+		// Milliseconds, a few frames behind.
+		inline float getDepthPassTime() const { return m_DepthPrePass ? m_DepthTimer.getMilliseconds() : 0; }
+		inline float getColorPassTime() const { return m_ColorTimer.getMilliseconds(); }
+
+		// Of the main pass.
+		inline const Statistics& getStatistics() const { return m_Passes[RenderQueue::PASS_MAIN].statistics; }
+		inline const Matrix4f& getProjectionMatrix() const { return m_ProjectionMatrix; }
+
+		// Replay of the recorded commands.
+		void bindProgram(const unsigned int program) override;
+		void bindVertexArray(const VertexArray* vertexArray) override;
+		void bindTexture(const unsigned int texture) override;
+		void loadMaterial(const float shineDamper, const float reflectivity) override;
+		void uploadInstances(const float* instances, const unsigned int count) override;
 
 	private:
-		void prepareTexturedModel(const TexturedModel& texturedModel);
-		void unbindTexturedModel(const RawModel& model);
+		// Picks the level of detail and builds the sort key of the visible entities on the worker threads, then sorts them.
+		void buildQueue(PassData& data, const std::vector<SceneBatch>& batches, const Vector3f& cameraPosition, const std::vector<SceneEntry>& visible, const RenderQueue::Pass pass);
+		void fillInstanceData(PassData& data, const std::vector<SceneBatch>& batches);
+		// Queued items before the first transparent one, which the sort key puts after all opaque ones.
+		unsigned int getOpaqueCount(const PassData& data, const std::vector<SceneBatch>& batches) const;
+		// Draws the opaque items with the depth shader, then sets up the depth test of the colour pass for them.
+		void recordDepth(PassData& data, RecordState& state, const std::vector<SceneBatch>& batches, const unsigned int opaqueCount);
+		// One instanced draw per batch and level of detail of the items [begin, end).
+		void recordBatches(PassData& data, RecordState& state, const std::vector<SceneBatch>& batches, const unsigned int begin, const unsigned int end);
+		// One command per batch and level of detail, grouped into segments of batches sharing all state.
+		void buildCommands(PassData& data, const std::vector<SceneBatch>& batches);
+		// One multi-draw per segment of [begin, end).
+		void recordSegments(PassData& data, RecordState& state, const std::vector<SceneBatch>& batches, const unsigned int begin, const unsigned int end);
+		static bool hasSameState(const TexturedModel& a, const TexturedModel& b);
+
+		void recordVertexArray(PassData& data, RecordState& state, const RawModel& model);
+		void recordProgram(PassData& data, RecordState& state, const unsigned int program);
+		void recordTexturedModel(PassData& data, RecordState& state, const TexturedModel& texturedModel);
 
 		void setTexParams() const;
 
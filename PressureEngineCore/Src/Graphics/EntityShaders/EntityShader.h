@@ -2,50 +2,58 @@
 #include "../Shaders/Shader.h"
 #include "../Entities/Camera.h"
 #include "../Entities/Light.h"
+#include "../Models/TexturedModel.h"
 
 namespace Pressure {
 
 	class EntityShader : public Shader {
 
 	public:
-		EntityShader();
+		// Features a variant is compiled with, see EntityShaderSource.
+		enum Feature : unsigned int {
+			// Per model, part of the sort key so batches sharing a variant are drawn together.
+			FEATURE_WIND = 1,
+			FEATURE_FAKE_LIGHTING = 2,
+			// Per pass.
+			FEATURE_CLIP_PLANE = 4,
+			FEATURE_SHADOWS = 8,
+			FEATURE_GEOMETRY_SHADER = 16
+		};
+		const static unsigned int MODEL_FEATURES = FEATURE_WIND | FEATURE_FAKE_LIGHTING;
+		// The number of lights, 1 - 4, is stored minus one in the two bits above the features.
+		const static unsigned int LIGHT_COUNT_SHIFT = 5;
+
+	private:
+		const unsigned int m_Features;
+
+	public:
+		EntityShader(const unsigned int features);
+
+		inline unsigned int getFeatures() const { return m_Features; }
+
+		static unsigned int getModelFeatures(const TexturedModel& model);
+		static unsigned int getLightCountFeature(const unsigned int lightCount);
 
 	protected:
 		virtual void bindAttributes() override;
 		virtual void getAllUniformLocations() override;
+		virtual void connectTextureUnits() override;
 
 	public:
-		//load uniforms.
-		void loadTransformationMatrix(Matrix4f& matrix);
-		void loadProjectionmatrix(Matrix4f& matrix);
-		void loadViewMatrix(Matrix4f& matrix);
-		void loadLights(std::vector<Light>& lights);
+		//load uniforms. The view, lights and shadow cascades come from the shared FrameData and ViewData blocks.
 		void loadShineVariables(float damper, float reflectivity);
-		void loadFakeLighting(bool useFakeLighting);
-		void loadClipPlane(const Vector4f& plane);
-		void loadToShadowMapSpace(Matrix4f& matrix);
-		void connectTextureUnits();
 		void loadWindModifier(const float windModifier);
-		void loadShadowDistance(float shadowDistance);
 
 	private:
+		static std::string getDefines(const unsigned int features);
+
 		//uniform locations.
-		int location_transformationMatrix;
-		int location_projectionMatrix;
-		int location_viewMatrix;
-		int location_lightPosition[4];
-		int location_lightColor[4];
-		int location_attenuation[4];
 		int location_shineDamper;
 		int location_reflectivity;
-		int location_fakeLighting;
-		int location_plane;
-		int location_toShadowMapSpace;
 		int location_shadowMap;
 		int location_textureSampler;
 		int location_windModifier;
-		int location_shadowDistance;
 
 	};
 
-}
+}
\ No newline at end of file
@@ -2,35 +2,56 @@
 
 namespace Pressure {
 		
+	// Compiled with the defines of EntityShader::getDefines(): WIND, FAKE_LIGHTING, CLIP_PLANE, SHADOWS,
+	// GEOMETRY_SHADER and LIGHT_COUNT.
 	const std::string EntityShaderSource::vertexShader = 
 R"(#version 330 core
 
+#ifdef GEOMETRY_SHADER
+#define FACE
+#else
+// Without the geometry shader a face takes these from its last vertex instead of their average.
+// It stays faceted, but the texture colour and the lighting of a face can change.
+#define FACE flat
+#endif
+
 in vec3 position;
 in vec2 textureCoords;
 in vec3 normal;
+in mat4 transformationMatrix;
 
 out VertexData {
-	vec2 pass_textureCoords;
-	vec3 surfaceNormal;
-	vec3 toLightVector[4];
+	FACE vec2 pass_textureCoords;
+	FACE vec3 surfaceNormal;
+	vec3 toLightVector[LIGHT_COUNT];
 	vec3 toCameraVector;
-	vec4 shadowCoords;
+	vec4 worldPosition; // w = view depth, used to pick the shadow cascade.
 } vertexOut;
 
-uniform mat4 transformationMatrix;
-uniform mat4 projectionMatrix;
-uniform mat4 viewMatrix;
-uniform vec3 lightPosition[4];
-uniform float useFakeLighting;
-uniform vec4 plane;
+// Has to match the depth pre-pass exactly for its GL_EQUAL depth test.
+invariant gl_Position;
+
+layout (std140) uniform FrameData {
+	vec4 lightPosition[4];
+	vec4 lightColor[4];
+	vec4 attenuation[4];
+	mat4 toShadowMapSpace[4];
+	vec4 cascadeDistances;
+	int cascadeCount;
+	float shadowMapSize;
+	float shadowDistance;
+};
+
+layout (std140) uniform ViewData {
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+	vec4 cameraPosition;
+	vec4 plane;
+};
+
+#ifdef WIND
 uniform float windModifier;
 
-uniform mat4 toShadowMapSpace;
-
-uniform float shadowDistance;
-
-const float transitionDistance = 10.0;
-
 float getWindX() {
 	return 0.2 * (0.4 * sin(4 * windModifier) + 0.2 * sin(7.2 * windModifier) + 0.4 * sin(-windModifier));
 }
@@ -38,34 +59,35 @@ float getWindX() {
 float getWindZ() {
 	return 0.2 * (0.4 * sin(4 * windModifier) + 0.4 * sin(6 * windModifier) + 0.2 * sin(-windModifier));
 }
+#endif
 
 void main(void) {
 
 	vec4 worldPosition = transformationMatrix * vec4(position, 1.0);
+#ifdef WIND
 	if (position.y > 0) {
 		worldPosition.xz = vec2(worldPosition.x + position.y * getWindX(), worldPosition.z + position.y * getWindZ());	
 	}
-	vertexOut.shadowCoords = toShadowMapSpace * worldPosition;
+#endif
+	vertexOut.worldPosition = vec4(worldPosition.xyz, -(viewMatrix * worldPosition).z);
 
+#ifdef CLIP_PLANE
 	gl_ClipDistance[0] = dot(worldPosition, plane);
+#endif
 
 	gl_Position = projectionMatrix * viewMatrix * worldPosition;
 	vertexOut.pass_textureCoords = textureCoords;
 
+#ifdef FAKE_LIGHTING
+	vertexOut.surfaceNormal = vec3(0.0, 1.0, 0.0);
+#else
 	vertexOut.surfaceNormal = (transformationMatrix * vec4(normal, 0.0)).xyz;
-	if (useFakeLighting > 0.5) {
-		vertexOut.surfaceNormal = vec3(0.0, 1.0, 0.0);
-	}
+#endif
 
-	for(int i = 0; i < 4; i++) {
-		vertexOut.toLightVector[i] = lightPosition[i] - worldPosition.xyz;	
+	for(int i = 0; i < LIGHT_COUNT; i++) {
+		vertexOut.toLightVector[i] = lightPosition[i].xyz - worldPosition.xyz;	
 	}
-	vertexOut.toCameraVector = (inverse(viewMatrix) * vec4(0.0, 0.0, 0.0, 1.0)).xyz - worldPosition.xyz;
-
-	float distance = length((viewMatrix * worldPosition).xyz);
-	distance = distance - (shadowDistance - transitionDistance);
-	distance = distance / transitionDistance;
-	vertexOut.shadowCoords.w = clamp(1.0 - distance, 0.0, 1.0);
+	vertexOut.toCameraVector = cameraPosition.xyz - worldPosition.xyz;
 
 })";
 
@@ -78,31 +100,35 @@ layout (triangle_strip, max_vertices = 3) out;
 in VertexData {
 	vec2 pass_textureCoords;
 	vec3 surfaceNormal;
-	vec3 toLightVector[4];
+	vec3 toLightVector[LIGHT_COUNT];
 	vec3 toCameraVector;
-	vec4 shadowCoords;
+	vec4 worldPosition; // w = view depth, used to pick the shadow cascade.
 } vertexIn[3];
 
 out VertexData {
 	vec2 pass_textureCoords;
 	vec3 surfaceNormal;
-	vec3 toLightVector[4];
+	vec3 toLightVector[LIGHT_COUNT];
 	vec3 toCameraVector;
-	vec4 shadowCoords;
+	vec4 worldPosition; // w = view depth, used to pick the shadow cascade.
 } vertexOut;
 
+invariant gl_Position;
+
 void main(void) {
 	for (int i = 0; i < 3; i++) {
 		vertexOut.pass_textureCoords = (vertexIn[0].pass_textureCoords + vertexIn[1].pass_textureCoords + vertexIn[2].pass_textureCoords) / 3;
 		//vertexOut.pass_textureCoords = vertexIn[i].pass_textureCoords;
 		vertexOut.toCameraVector = vertexIn[i].toCameraVector;
-		vertexOut.shadowCoords = vertexIn[i].shadowCoords;
+		vertexOut.worldPosition = vertexIn[i].worldPosition;
 
 		vertexOut.surfaceNormal = (vertexIn[0].surfaceNormal + vertexIn[1].surfaceNormal + vertexIn[2].surfaceNormal) / 3;
 		vertexOut.toLightVector = vertexIn[i].toLightVector;
 
 		gl_Position = gl_in[i].gl_Position;
+#ifdef CLIP_PLANE
 		gl_ClipDistance[0] = gl_in[i].gl_ClipDistance[0];
+#endif
 		EmitVertex();
 	}
 	EndPrimitive();
@@ -111,47 +137,81 @@ void main(void) {
 	const std::string EntityShaderSource::fragmentShader = 
 R"(#version 330 core
 
+#ifdef GEOMETRY_SHADER
+#define FACE
+#else
+#define FACE flat
+#endif
+
 in VertexData {
-	vec2 pass_textureCoords;
-	vec3 surfaceNormal;
-	vec3 toLightVector[4];
+	FACE vec2 pass_textureCoords;
+	FACE vec3 surfaceNormal;
+	vec3 toLightVector[LIGHT_COUNT];
 	vec3 toCameraVector;
-	vec4 shadowCoords;
+	vec4 worldPosition; // w = view depth, used to pick the shadow cascade.
 } vertexIn;
 
 layout (location = 0) out vec4 out_Color;
 layout (location = 1) out vec4 out_LightColor;
 
-uniform sampler2D textureSampler;
-uniform sampler2D shadowMap;
+layout (std140) uniform FrameData {
+	vec4 lightPosition[4];
+	vec4 lightColor[4];
+	vec4 attenuation[4];
+	mat4 toShadowMapSpace[4];
+	vec4 cascadeDistances;
+	int cascadeCount;
+	float shadowMapSize;
+	float shadowDistance;
+};
 
-uniform vec3 lightColor[4];
-uniform vec3 attenuation[4];
+uniform sampler2D textureSampler;
 uniform float shineDamper;
 uniform float reflectivity;
 
+#ifdef SHADOWS
+uniform sampler2DArray shadowMap;
+
 const int pcfCount = 2;
 const float totalTexels = (pcfCount * 2.0 + 1.0) * (pcfCount * 2.0 + 1.0);
+const float transitionDistance = 10.0;
 
-void main(void) {
+float getLightFactor() {
+	float depth = vertexIn.worldPosition.w;
+	int cascade = cascadeCount - 1;
+	for (int i = 0; i < cascadeCount - 1; i++) {
+		if (depth < cascadeDistances[i]) {
+			cascade = i;
+			break;
+		}
+	}
+	vec4 shadowCoords = toShadowMapSpace[cascade] * vec4(vertexIn.worldPosition.xyz, 1.0);
 
-	const float shadowMapSize = 8192;
 	float texelSize = 1.0 / shadowMapSize;
 	float total = 0.0;	
 
 	for(int x = -pcfCount; x <= pcfCount; x++) {	
 		for(int y = -pcfCount; y <= pcfCount; y++) {
-			float objectNearestLight = texture(shadowMap, vertexIn.shadowCoords.xy + vec2(x, y) * texelSize).r;
-			if(vertexIn.shadowCoords.z > objectNearestLight) {
+			float objectNearestLight = texture(shadowMap, vec3(shadowCoords.xy + vec2(x, y) * texelSize, cascade)).r;
+			if(shadowCoords.z > objectNearestLight) {
 				total += 1.0;
 			}
 		}	
 	}
 
 	total /= totalTexels;
-	float lightFactor = 1.0 - (total * vertexIn.shadowCoords.w);
-	lightFactor = max(lightFactor, 0.1);
+	float fade = clamp(1.0 - (depth - (shadowDistance - transitionDistance)) / transitionDistance, 0.0, 1.0);
+	return max(1.0 - (total * fade), 0.1);
+}
+#endif
 
+void main(void) {
+
+#ifdef SHADOWS
+	float lightFactor = getLightFactor();
+#else
+	float lightFactor = 1.0;
+#endif
 
 	vec3 unitNormal = normalize(vertexIn.surfaceNormal);
 	vec3 unitVectorToCamera = normalize(vertexIn.toCameraVector);
@@ -159,7 +219,7 @@ void main(void) {
 	vec3 totalDiffuse = vec3(0.0);
 	vec3 totalSpecular = vec3(0.0);
 
-	for(int i = 0; i < 4; i++) {
+	for(int i = 0; i < LIGHT_COUNT; i++) {
 		float distance = length(vertexIn.toLightVector[i]);
 		float attFactor = attenuation[i].x + (attenuation[i].y * distance) + (attenuation[i].z * distance * distance);
 		vec3 unitLightVector = normalize(vertexIn.toLightVector[i]);
@@ -170,11 +230,11 @@ void main(void) {
 		float specularFactor = dot(reflectedLightDirection, unitVectorToCamera);
 		specularFactor = max(specularFactor, 0.0);
 		float dampedFactor = pow(specularFactor, shineDamper);
-		totalDiffuse += (brightness * lightColor[i]) / attFactor;
+		totalDiffuse += (brightness * lightColor[i].xyz) / attFactor;
 		if (i == 0) { // Only lower the sun's light with shadows.			
 			totalDiffuse = max(totalDiffuse * lightFactor, 0.3);
 		}
-		totalSpecular += (dampedFactor * reflectivity * lightColor[i]) / attFactor;
+		totalSpecular += (dampedFactor * reflectivity * lightColor[i].xyz) / attFactor;
 	}
 
 	vec4 textureColor = texture(textureSampler, vertexIn.pass_textureCoords);
@@ -186,8 +246,55 @@ void main(void) {
 	out_LightColor = vec4(0.0, 0.0, 0.0, 1.0);
 	//out_Color = vec4(totalDiffuse, 1.0) * textureColor;
 	//out_Color = vec4(lightFactor);
-	//out_Color = vertexIn.shadowCoords;
 
+})";
+
+	// Compiled with WIND defined for wind affected models, the only pass it runs in has no clip plane.
+	const std::string EntityShaderSource::depthVertexShader =
+R"(#version 330 core
+
+in vec3 position;
+in mat4 transformationMatrix;
+
+// Computed the same way as in the vertex shader of the colour pass, which tests against it with GL_EQUAL.
+invariant gl_Position;
+
+layout (std140) uniform ViewData {
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+	vec4 cameraPosition;
+	vec4 plane;
+};
+
+#ifdef WIND
+uniform float windModifier;
+
+float getWindX() {
+	return 0.2 * (0.4 * sin(4 * windModifier) + 0.2 * sin(7.2 * windModifier) + 0.4 * sin(-windModifier));
+}
+
+float getWindZ() {
+	return 0.2 * (0.4 * sin(4 * windModifier) + 0.4 * sin(6 * windModifier) + 0.2 * sin(-windModifier));
+}
+#endif
+
+void main(void) {
+
+	vec4 worldPosition = transformationMatrix * vec4(position, 1.0);
+#ifdef WIND
+	if (position.y > 0) {
+		worldPosition.xz = vec2(worldPosition.x + position.y * getWindX(), worldPosition.z + position.y * getWindZ());	
+	}
+#endif
+
+	gl_Position = projectionMatrix * viewMatrix * worldPosition;
+
+})";
+
+	const std::string EntityShaderSource::depthFragmentShader =
+R"(#version 330 core
+
+void main(void) {
 })";
 
 }
\ No newline at end of file
@@ -8,6 +8,9 @@ namespace Pressure {
 		const static std::string vertexShader;
 		const static std::string geometryShader;
 		const static std::string fragmentShader;
+		// Position only, for the depth pre-pass.
+		const static std::string depthVertexShader;
+		const static std::string depthFragmentShader;
 
 	};
 
@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include <list>
+#include <map>
+
+#include "Entities\Entity.h"
+#include "Entities\Light.h"
+#include "Entities\Camera.h"
+#include "Water\Water.h"
+#include "Guis\GuiTexture.h"
+#include "Particles\Particle.h"
+#include "Particles\ParticleTexture.h"
+#include "Scene\Scene.h"
+
+namespace Pressure {
+
+	// Everything the render thread needs for one frame, recorded by the game thread and not touched by it again
+	// until the render thread is done with it.
+	struct FrameSnapshot {
+
+		// Scene changes in the order the game thread made them, replayed onto the Scene before drawing.
+		struct SceneEdit {
+			enum Type : unsigned char {
+				ADD,
+				UPDATE,
+				REMOVE
+			};
+
+			Type type;
+			SceneHandle handle;
+			// Index into entities, unused by REMOVE.
+			unsigned int entity;
+		};
+
+		std::vector<SceneEdit> edits;
+		std::vector<Entity> entities;
+
+		Camera camera;
+		std::vector<Light> lights;
+		std::vector<Water> water;
+		std::vector<GuiTexture> guis;
+		std::map<ParticleTexture, std::list<Particle>> particles;
+
+		// Game ticks since the previous snapshot, the wind and the waves advance by as many.
+		unsigned int ticks = 0;
+		bool resized = false;
+		// Window size read on the game thread, GLFW only answers there. Only set when resized.
+		int width = 0;
+		int height = 0;
+
+		void clear() {
+			edits.clear();
+			entities.clear();
+			lights.clear();
+			water.clear();
+			guis.clear();
+			particles.clear();
+			ticks = 0;
+			resized = false;
+		}
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "CommandList.h"
+#include "GLState.h"
+
+namespace Pressure {
+
+	CommandList::CommandList()
+		: m_DrawCount(0) {
+	}
+
+	void CommandList::clear() {
+		m_Commands.clear();
+		m_DrawCount = 0;
+	}
+
+	void CommandList::bindProgram(const unsigned int program) {
+		push(BIND_PROGRAM).value = program;
+	}
+
+	void CommandList::bindVertexArray(const VertexArray* vertexArray) {
+		push(BIND_VERTEX_ARRAY).vertexArray = vertexArray;
+	}
+
+	void CommandList::bindTexture(const unsigned int texture) {
+		push(BIND_TEXTURE).value = texture;
+	}
+
+	void CommandList::bindUniformRange(const UniformBuffer& buffer, const unsigned int binding, const unsigned int offset, const unsigned int size) {
+		push(BIND_UNIFORM_RANGE).range = { &buffer, binding, offset, size };
+	}
+
+	void CommandList::loadMaterial(const float shineDamper, const float reflectivity) {
+		push(LOAD_MATERIAL).material = { shineDamper, reflectivity };
+	}
+
+	void CommandList::uploadInstances(const float* instances, const unsigned int count) {
+		push(UPLOAD_INSTANCES).instances = { instances, count };
+	}
+
+	void CommandList::uploadCommands(IndirectBuffer& commands) {
+		push(UPLOAD_COMMANDS).commands = &commands;
+	}
+
+	void CommandList::cullFace(const unsigned int face) {
+		push(CULL_FACE).value = face;
+	}
+
+	void CommandList::depthFunc(const unsigned int func) {
+		push(DEPTH_FUNC).value = func;
+	}
+
+	void CommandList::depthMask(const bool mask) {
+		push(DEPTH_MASK).flag = mask;
+	}
+
+	void CommandList::colorMask(const bool mask) {
+		push(COLOR_MASK).flag = mask;
+	}
+
+	void CommandList::beginTimer(TimerQuery& timer) {
+		push(BEGIN_TIMER).timer = &timer;
+	}
+
+	void CommandList::endTimer(TimerQuery& timer) {
+		push(END_TIMER).timer = &timer;
+	}
+
+	void CommandList::draw(const unsigned int count, const unsigned int indexType, const unsigned int firstIndex, const unsigned int instanceCount, const int baseVertex) {
+		push(DRAW).draw = { count, indexType, firstIndex, instanceCount, baseVertex };
+		m_DrawCount++;
+	}
+
+	void CommandList::multiDraw(const IndirectBuffer& commands, const unsigned int first, const unsigned int count, const unsigned int indexType) {
+		push(MULTI_DRAW).multiDraw = { &commands, first, count, indexType };
+		m_DrawCount++;
+	}
+
+	void CommandList::replay(Executor& executor) const {
+		for (const Command& command : m_Commands) {
+			switch (command.type) {
+			case BIND_PROGRAM:
+				executor.bindProgram(command.value);
+				break;
+			case BIND_VERTEX_ARRAY:
+				executor.bindVertexArray(command.vertexArray);
+				break;
+			case BIND_TEXTURE:
+				executor.bindTexture(command.value);
+				break;
+			case BIND_UNIFORM_RANGE:
+				command.range.buffer->bindRange(command.range.binding, command.range.offset, command.range.size);
+				break;
+			case LOAD_MATERIAL:
+				executor.loadMaterial(command.material.shineDamper, command.material.reflectivity);
+				break;
+			case UPLOAD_INSTANCES:
+				executor.uploadInstances(command.instances.data, command.instances.count);
+				break;
+			case UPLOAD_COMMANDS:
+				command.commands->upload();
+				break;
+			case CULL_FACE:
+				GLState::setEnabled(GL_CULL_FACE, command.value != 0);
+				if (command.value != 0)
+					GLState::cullFace(command.value);
+				break;
+			case DEPTH_FUNC:
+				GLState::depthFunc(command.value);
+				break;
+			case DEPTH_MASK:
+				GLState::depthMask(command.flag);
+				break;
+			case COLOR_MASK:
+				glColorMask(command.flag, command.flag, command.flag, command.flag);
+				break;
+			case BEGIN_TIMER:
+				command.timer->begin();
+				break;
+			case END_TIMER:
+				command.timer->end();
+				break;
+			case DRAW:
+				glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.draw.count, command.draw.indexType,
+					(const void*)(command.draw.firstIndex * getIndexSize(command.draw.indexType)), command.draw.instanceCount, command.draw.baseVertex);
+				break;
+			case MULTI_DRAW:
+				command.multiDraw.buffer->draw(command.multiDraw.first, command.multiDraw.count, command.multiDraw.indexType);
+				break;
+			}
+		}
+	}
+
+	CommandList::Command& CommandList::push(const Type type) {
+		m_Commands.emplace_back();
+		m_Commands.back().type = type;
+		return m_Commands.back();
+	}
+
+	unsigned int CommandList::getIndexSize(const unsigned int indexType) {
+		return indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+	}
+
+}
\ No newline at end of file
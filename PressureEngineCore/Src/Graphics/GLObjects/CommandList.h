@@ -0,0 +1,143 @@
+#pragma once
+#include <vector>
+
+#include "../../Common.h"
+#include "VertexArray.h"
+#include "IndirectBuffer.h"
+#include "UniformBuffer.h"
+#include "TimerQuery.h"
+
+namespace Pressure {
+
+	// Draw submission of one pass, recorded on any thread and replayed in order on the thread owning the context.
+	// Recording makes no GL calls. Commands only hold plain values and pointers to objects that outlive the replay,
+	// what only the recording renderer knows how to do, like picking a program variant, goes through an Executor.
+	class CommandList {
+
+	public:
+		// Carries out the commands that need the renderer which recorded them.
+		class Executor {
+
+		public:
+			// The meaning of program is up to the renderer, like the features of a shader variant.
+			virtual void bindProgram(const unsigned int program) = 0;
+			// nullptr unbinds the vertex array.
+			virtual void bindVertexArray(const VertexArray* vertexArray) = 0;
+			virtual void bindTexture(const unsigned int texture) = 0;
+			virtual void loadMaterial(const float shineDamper, const float reflectivity) = 0;
+			virtual void uploadInstances(const float* instances, const unsigned int count) = 0;
+
+		protected:
+			~Executor() = default;
+
+		};
+
+	private:
+		enum Type : unsigned char {
+			BIND_PROGRAM,
+			BIND_VERTEX_ARRAY,
+			BIND_TEXTURE,
+			BIND_UNIFORM_RANGE,
+			LOAD_MATERIAL,
+			UPLOAD_INSTANCES,
+			UPLOAD_COMMANDS,
+			CULL_FACE,
+			DEPTH_FUNC,
+			DEPTH_MASK,
+			COLOR_MASK,
+			BEGIN_TIMER,
+			END_TIMER,
+			DRAW,
+			MULTI_DRAW
+		};
+
+		struct Draw {
+			unsigned int count;
+			unsigned int indexType;
+			unsigned int firstIndex;
+			unsigned int instanceCount;
+			int baseVertex;
+		};
+
+		struct MultiDraw {
+			const IndirectBuffer* buffer;
+			unsigned int first;
+			unsigned int count;
+			unsigned int indexType;
+		};
+
+		struct UniformRange {
+			const UniformBuffer* buffer;
+			unsigned int binding;
+			unsigned int offset;
+			unsigned int size;
+		};
+
+		struct Instances {
+			const float* data;
+			unsigned int count;
+		};
+
+		struct Material {
+			float shineDamper;
+			float reflectivity;
+		};
+
+		struct Command {
+			Type type;
+			union {
+				unsigned int value;
+				bool flag;
+				const VertexArray* vertexArray;
+				IndirectBuffer* commands;
+				TimerQuery* timer;
+				Draw draw;
+				MultiDraw multiDraw;
+				UniformRange range;
+				Instances instances;
+				Material material;
+			};
+		};
+
+		std::vector<Command> m_Commands;
+		unsigned int m_DrawCount;
+
+	public:
+		CommandList();
+
+		void clear();
+
+		void bindProgram(const unsigned int program);
+		void bindVertexArray(const VertexArray* vertexArray);
+		void bindTexture(const unsigned int texture);
+		// Makes [offset, offset + size) of the buffer the block at binding.
+		void bindUniformRange(const UniformBuffer& buffer, const unsigned int binding, const unsigned int offset, const unsigned int size);
+		void loadMaterial(const float shineDamper, const float reflectivity);
+		// The data is read when replayed, it has to stay untouched until then.
+		void uploadInstances(const float* instances, const unsigned int count);
+		// Uploads what was pushed into the buffer, for the multi-draws after it.
+		void uploadCommands(IndirectBuffer& commands);
+		// 0 disables face culling.
+		void cullFace(const unsigned int face);
+		void depthFunc(const unsigned int func);
+		void depthMask(const bool mask);
+		void colorMask(const bool mask);
+		void beginTimer(TimerQuery& timer);
+		void endTimer(TimerQuery& timer);
+		// firstIndex counts indices, not bytes.
+		void draw(const unsigned int count, const unsigned int indexType, const unsigned int firstIndex, const unsigned int instanceCount, const int baseVertex);
+		void multiDraw(const IndirectBuffer& commands, const unsigned int first, const unsigned int count, const unsigned int indexType);
+
+		void replay(Executor& executor) const;
+
+		inline bool empty() const { return m_Commands.empty(); }
+		inline unsigned int size() const { return m_Commands.size(); }
+		inline unsigned int getDrawCount() const { return m_DrawCount; }
+
+	private:
+		Command& push(const Type type);
+		static unsigned int getIndexSize(const unsigned int indexType);
+
+	};
+
+}
\ No newline at end of file
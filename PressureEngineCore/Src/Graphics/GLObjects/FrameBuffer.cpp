@@ -1,14 +1,15 @@
 #include "FrameBuffer.h"
+#include "GLState.h"
 
 namespace Pressure {
 
-	FrameBuffer::FrameBuffer(Window& window, unsigned int width, unsigned int height, unsigned int targetCount, unsigned int samples, DepthBufferType depthType) 
+	FrameBuffer::FrameBuffer(Window& window, unsigned int width, unsigned int height, unsigned int targetCount, unsigned int samples, DepthBufferType depthType, const bool alpha) 
 		: m_Window(window), m_Width(width), m_Height(height), m_TargetCount(targetCount) {
 		
 		createFrameBuffer();
 
 		if (samples <= 1) {
-			createColorTextureAttachments(targetCount);
+			createColorTextureAttachments(targetCount, alpha);
 			m_MultiSampled = false;
 		} else {
 			createMultisampleColorBufferAttachments(targetCount, samples);
@@ -24,36 +25,36 @@ namespace Pressure {
 	}
 
 	FrameBuffer::~FrameBuffer() {
-		glDeleteFramebuffers(1, &m_ID);		
-		if (m_ColorTextureIDs.size())
-			glDeleteTextures(m_ColorTextureIDs.size(), &m_ColorTextureIDs[0]);
+		GLState::deleteFramebuffer(m_ID);
+		for (unsigned int texture : m_ColorTextureIDs)
+			GLState::deleteTexture(texture);
 		if (m_ColorBufferIDs.size())
 			glDeleteRenderbuffers(m_ColorBufferIDs.size(), &m_ColorBufferIDs[0]);
-		glDeleteTextures(1, &m_DepthTextureID);
+		GLState::deleteTexture(m_DepthTextureID);
 		glDeleteRenderbuffers(1, &m_DepthBufferID);
 	}
 	
 	void FrameBuffer::bind() const {
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_ID);
+		GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, m_ID);
 		glViewport(0, 0, m_Width, m_Height);
 	}
 
 	void FrameBuffer::unbind() const {
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 		glViewport(0, 0, m_Window.getWidth(), m_Window.getHeight());
 	}
 
 	void FrameBuffer::resolve(unsigned int readBuffer, FrameBuffer& buffer) {
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, buffer.getID());
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_ID);
+		GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, buffer.getID());
+		GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, m_ID);
 		glReadBuffer(GL_COLOR_ATTACHMENT0 + readBuffer);
 		glBlitFramebuffer(0, 0, m_Width, m_Height, 0, 0, buffer.getWidth(), buffer.getHeight(), GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 		unbind();
 	}
 
 	void FrameBuffer::resolve(unsigned int readBuffer) {
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_ID);
+		GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, m_ID);
 		glReadBuffer(GL_COLOR_ATTACHMENT0 + readBuffer);
 		glDrawBuffer(GL_BACK);
 		glBlitFramebuffer(0, 0, m_Width, m_Height, 0, 0, m_Window.getWidth(), m_Window.getHeight(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
@@ -86,7 +87,7 @@ namespace Pressure {
 
 	void FrameBuffer::createFrameBuffer() {
 		glGenFramebuffers(1, &m_ID);
-		glBindFramebuffer(GL_FRAMEBUFFER, m_ID);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, m_ID);
 		determineDrawBuffers();
 	}
 
@@ -99,13 +100,13 @@ namespace Pressure {
 		glDrawBuffers(m_TargetCount, &drawBuffers[0]);
 	}
 
-	void FrameBuffer::createColorTextureAttachments(unsigned int count) {
+	void FrameBuffer::createColorTextureAttachments(unsigned int count, const bool alpha) {
 		m_ColorTextureIDs.resize(count);
 		glGenTextures(count, &m_ColorTextureIDs[0]);
 		
 		for (unsigned int i = 0; i < count; i++) {
-			glBindTexture(GL_TEXTURE_2D, m_ColorTextureIDs[i]);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			GLState::bindTexture(GL_TEXTURE_2D, m_ColorTextureIDs[i]);
+			glTexImage2D(GL_TEXTURE_2D, 0, alpha ? GL_RGBA : GL_RGB, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, m_ColorTextureIDs[i], 0);
@@ -125,7 +126,7 @@ namespace Pressure {
 
 	void FrameBuffer::createDepthTextureAttachment() {
 		glGenTextures(1, &m_DepthTextureID);
-		glBindTexture(GL_TEXTURE_2D, m_DepthTextureID);
+		GLState::bindTexture(GL_TEXTURE_2D, m_DepthTextureID);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32, m_Width, m_Height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -35,7 +35,8 @@ namespace Pressure {
 		bool m_MultiSampled;
 
 	public:
-		FrameBuffer(Window& window, unsigned int width, unsigned int height, unsigned int targetCount, unsigned int samples, DepthBufferType depthType);
+		// Color textures only keep an alpha channel when asked to.
+		FrameBuffer(Window& window, unsigned int width, unsigned int height, unsigned int targetCount, unsigned int samples, DepthBufferType depthType, const bool alpha = false);
 		~FrameBuffer();
 
 		void bind() const;
@@ -55,7 +56,7 @@ namespace Pressure {
 		void createFrameBuffer();
 		void determineDrawBuffers();
 
-		void createColorTextureAttachments(unsigned int count);
+		void createColorTextureAttachments(unsigned int count, const bool alpha);
 		void createMultisampleColorBufferAttachments(unsigned int count, unsigned int samples);
 
 		void createDepthTextureAttachment();
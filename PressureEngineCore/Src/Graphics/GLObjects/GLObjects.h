@@ -1,4 +1,9 @@
 #pragma once
 
 #include "VertexArray.h"
-#include "IndexBuffer.h"
\ No newline at end of file
+#include "IndexBuffer.h"
+#include "IndirectBuffer.h"
+#include "UniformBuffer.h"
+#include "TimerQuery.h"
+#include "CommandList.h"
+#include "GLState.h"
\ No newline at end of file
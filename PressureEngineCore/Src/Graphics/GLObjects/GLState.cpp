@@ -0,0 +1,192 @@
+#include "GLState.h"
+
+namespace Pressure {
+
+	const unsigned int GLState::UNKNOWN = ~0u;
+
+	unsigned int GLState::s_Program = GLState::UNKNOWN;
+	unsigned int GLState::s_VertexArray = GLState::UNKNOWN;
+	unsigned int GLState::s_ActiveUnit = GLState::UNKNOWN;
+	unsigned int GLState::s_Textures[GLState::TEXTURE_UNITS][GLState::TARGET_COUNT];
+	unsigned int GLState::s_DrawFramebuffer = GLState::UNKNOWN;
+	unsigned int GLState::s_ReadFramebuffer = GLState::UNKNOWN;
+	unsigned int GLState::s_Capabilities[GLState::CAPABILITY_COUNT];
+	unsigned int GLState::s_BlendSource = GLState::UNKNOWN;
+	unsigned int GLState::s_BlendDestination = GLState::UNKNOWN;
+	unsigned int GLState::s_CullFace = GLState::UNKNOWN;
+	unsigned int GLState::s_DepthMask = GLState::UNKNOWN;
+	unsigned int GLState::s_DepthFunc = GLState::UNKNOWN;
+
+	GLState::Counters GLState::s_Counters;
+
+	void GLState::useProgram(const unsigned int program) {
+		if (change(s_Program, program))
+			glUseProgram(program);
+	}
+
+	void GLState::bindVertexArray(const unsigned int vertexArray) {
+		if (change(s_VertexArray, vertexArray))
+			glBindVertexArray(vertexArray);
+	}
+
+	void GLState::activeTexture(const unsigned int unit) {
+		if (change(s_ActiveUnit, unit))
+			glActiveTexture(unit);
+	}
+
+	void GLState::bindTexture(const unsigned int target, const unsigned int texture) {
+		int index = getTextureTarget(target);
+		unsigned int unit = s_ActiveUnit - GL_TEXTURE0;
+		if (index < 0 || unit >= TEXTURE_UNITS) {
+			glBindTexture(target, texture);
+			s_Counters.issued++;
+		} else if (change(s_Textures[unit][index], texture)) {
+			glBindTexture(target, texture);
+		}
+	}
+
+	void GLState::bindTexture(const unsigned int unit, const unsigned int target, const unsigned int texture) {
+		activeTexture(unit);
+		bindTexture(target, texture);
+	}
+
+	void GLState::bindFramebuffer(const unsigned int target, const unsigned int framebuffer) {
+		if (target == GL_FRAMEBUFFER) {
+			if (s_DrawFramebuffer == framebuffer && s_ReadFramebuffer == framebuffer) {
+				s_Counters.skipped++;
+				return;
+			}
+			s_DrawFramebuffer = s_ReadFramebuffer = framebuffer;
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+			s_Counters.issued++;
+		} else if (change(target == GL_READ_FRAMEBUFFER ? s_ReadFramebuffer : s_DrawFramebuffer, framebuffer)) {
+			glBindFramebuffer(target, framebuffer);
+		}
+	}
+
+	void GLState::setEnabled(const unsigned int capability, const bool enabled) {
+		int index = getCapability(capability);
+		if (index < 0)
+			s_Counters.issued++;
+		else if (!change(s_Capabilities[index], enabled))
+			return;
+
+		if (enabled)
+			glEnable(capability);
+		else
+			glDisable(capability);
+	}
+
+	void GLState::blendFunc(const unsigned int source, const unsigned int destination) {
+		if (s_BlendSource == source && s_BlendDestination == destination) {
+			s_Counters.skipped++;
+			return;
+		}
+		s_BlendSource = source;
+		s_BlendDestination = destination;
+		glBlendFunc(source, destination);
+		s_Counters.issued++;
+	}
+
+	void GLState::cullFace(const unsigned int face) {
+		if (change(s_CullFace, face))
+			glCullFace(face);
+	}
+
+	void GLState::depthMask(const bool mask) {
+		if (change(s_DepthMask, mask))
+			glDepthMask(mask);
+	}
+
+	void GLState::depthFunc(const unsigned int func) {
+		if (change(s_DepthFunc, func))
+			glDepthFunc(func);
+	}
+
+	void GLState::deleteProgram(const unsigned int program) {
+		// A program in use is only deleted once another one is used, do not skip that call.
+		glDeleteProgram(program);
+		if (s_Program == program)
+			s_Program = UNKNOWN;
+	}
+
+	void GLState::deleteVertexArray(const unsigned int vertexArray) {
+		glDeleteVertexArrays(1, &vertexArray);
+		if (s_VertexArray == vertexArray)
+			s_VertexArray = 0;
+	}
+
+	void GLState::deleteTexture(const unsigned int texture) {
+		glDeleteTextures(1, &texture);
+		for (unsigned int unit = 0; unit < TEXTURE_UNITS; unit++) {
+			for (unsigned int target = 0; target < TARGET_COUNT; target++) {
+				if (s_Textures[unit][target] == texture)
+					s_Textures[unit][target] = 0;
+			}
+		}
+	}
+
+	void GLState::deleteFramebuffer(const unsigned int framebuffer) {
+		glDeleteFramebuffers(1, &framebuffer);
+		if (s_DrawFramebuffer == framebuffer)
+			s_DrawFramebuffer = 0;
+		if (s_ReadFramebuffer == framebuffer)
+			s_ReadFramebuffer = 0;
+	}
+
+	void GLState::invalidate() {
+		s_Program = s_VertexArray = s_ActiveUnit = UNKNOWN;
+		for (unsigned int unit = 0; unit < TEXTURE_UNITS; unit++) {
+			for (unsigned int target = 0; target < TARGET_COUNT; target++)
+				s_Textures[unit][target] = UNKNOWN;
+		}
+		s_DrawFramebuffer = s_ReadFramebuffer = UNKNOWN;
+		for (unsigned int i = 0; i < CAPABILITY_COUNT; i++)
+			s_Capabilities[i] = UNKNOWN;
+		s_BlendSource = s_BlendDestination = UNKNOWN;
+		s_CullFace = s_DepthMask = s_DepthFunc = UNKNOWN;
+	}
+
+	bool GLState::change(unsigned int& current, const unsigned int value) {
+		if (current == value) {
+			s_Counters.skipped++;
+			return false;
+		}
+		current = value;
+		s_Counters.issued++;
+		return true;
+	}
+
+	int GLState::getTextureTarget(const unsigned int target) {
+		switch (target) {
+		case GL_TEXTURE_2D:
+			return TARGET_2D;
+		case GL_TEXTURE_2D_ARRAY:
+			return TARGET_2D_ARRAY;
+		case GL_TEXTURE_CUBE_MAP:
+			return TARGET_CUBE_MAP;
+		default:
+			return -1;
+		}
+	}
+
+	int GLState::getCapability(const unsigned int capability) {
+		switch (capability) {
+		case GL_BLEND:
+			return CAPABILITY_BLEND;
+		case GL_CULL_FACE:
+			return CAPABILITY_CULL_FACE;
+		case GL_DEPTH_TEST:
+			return CAPABILITY_DEPTH_TEST;
+		case GL_DEPTH_CLAMP:
+			return CAPABILITY_DEPTH_CLAMP;
+		case GL_CLIP_DISTANCE0:
+			return CAPABILITY_CLIP_DISTANCE0;
+		case GL_MULTISAMPLE:
+			return CAPABILITY_MULTISAMPLE;
+		default:
+			return -1;
+		}
+	}
+
+}
\ No newline at end of file
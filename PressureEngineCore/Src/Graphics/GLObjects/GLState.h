@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../../Common.h"
+
+namespace Pressure {
+
+	// Shadow copy of the GL state the renderers change most, so that calls which would not change anything are dropped.
+	// Everything that binds programs, vertex arrays, textures or framebuffers, or toggles the tracked capabilities,
+	// has to go through here, otherwise the shadow copy goes stale. invalidate() recovers from code that did not.
+	class GLState {
+
+	public:
+		// Calls that reached the driver and calls that were dropped, since the last resetCounters().
+		struct Counters {
+			unsigned int issued = 0;
+			unsigned int skipped = 0;
+		};
+
+		const static unsigned int TEXTURE_UNITS = 16;
+
+	private:
+		// Texture targets tracked per unit, other targets are always passed through.
+		enum TextureTarget {
+			TARGET_2D,
+			TARGET_2D_ARRAY,
+			TARGET_CUBE_MAP,
+			TARGET_COUNT
+		};
+
+		// Capabilities that can be toggled through setEnabled.
+		enum Capability {
+			CAPABILITY_BLEND,
+			CAPABILITY_CULL_FACE,
+			CAPABILITY_DEPTH_TEST,
+			CAPABILITY_DEPTH_CLAMP,
+			CAPABILITY_CLIP_DISTANCE0,
+			CAPABILITY_MULTISAMPLE,
+			CAPABILITY_COUNT
+		};
+
+		// Stands for a value that is not known, the next call always reaches the driver.
+		const static unsigned int UNKNOWN;
+
+		static unsigned int s_Program;
+		static unsigned int s_VertexArray;
+		static unsigned int s_ActiveUnit;
+		static unsigned int s_Textures[TEXTURE_UNITS][TARGET_COUNT];
+		static unsigned int s_DrawFramebuffer;
+		static unsigned int s_ReadFramebuffer;
+		static unsigned int s_Capabilities[CAPABILITY_COUNT];
+		static unsigned int s_BlendSource;
+		static unsigned int s_BlendDestination;
+		static unsigned int s_CullFace;
+		static unsigned int s_DepthMask;
+		static unsigned int s_DepthFunc;
+
+		static Counters s_Counters;
+
+	public:
+		static void useProgram(const unsigned int program);
+		static void bindVertexArray(const unsigned int vertexArray);
+		static void activeTexture(const unsigned int unit);
+		// Binds to the active unit.
+		static void bindTexture(const unsigned int target, const unsigned int texture);
+		static void bindTexture(const unsigned int unit, const unsigned int target, const unsigned int texture);
+		// target is GL_FRAMEBUFFER, GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER.
+		static void bindFramebuffer(const unsigned int target, const unsigned int framebuffer);
+
+		static void setEnabled(const unsigned int capability, const bool enabled);
+		inline static void enable(const unsigned int capability) { setEnabled(capability, true); }
+		inline static void disable(const unsigned int capability) { setEnabled(capability, false); }
+		static void blendFunc(const unsigned int source, const unsigned int destination);
+		static void cullFace(const unsigned int face);
+		static void depthMask(const bool mask);
+		static void depthFunc(const unsigned int func);
+
+		// Deleting a bound object resets its binding to 0, these keep the shadow copy in line.
+		static void deleteProgram(const unsigned int program);
+		static void deleteVertexArray(const unsigned int vertexArray);
+		static void deleteTexture(const unsigned int texture);
+		static void deleteFramebuffer(const unsigned int framebuffer);
+
+		// Forgets everything, for example after a new context was made current.
+		static void invalidate();
+
+		inline static const Counters& getCounters() { return s_Counters; }
+		inline static void resetCounters() { s_Counters = Counters(); }
+
+	private:
+		// Returns true and counts an issued call if value differs from current, which is updated. Counts a skipped call otherwise.
+		static bool change(unsigned int& current, const unsigned int value);
+		static int getTextureTarget(const unsigned int target);
+		static int getCapability(const unsigned int capability);
+
+	};
+
+}
\ No newline at end of file
@@ -5,12 +5,19 @@
 namespace Pressure {
 
 	IndexBuffer::IndexBuffer(const unsigned int* data, const unsigned int count) 
-		: m_Count(count) {
+		: m_Count(count), m_Type(GL_UNSIGNED_INT) {
 		glGenBuffers(1, &m_ID);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(int), data, GL_STATIC_DRAW);
 	}
 
+	IndexBuffer::IndexBuffer(const unsigned short* data, const unsigned int count)
+		: m_Count(count), m_Type(GL_UNSIGNED_SHORT) {
+		glGenBuffers(1, &m_ID);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(short), data, GL_STATIC_DRAW);
+	}
+
 	void IndexBuffer::bind() const {
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
 	}
@@ -7,15 +7,19 @@ namespace Pressure {
 	private:
 		unsigned int m_ID;
 		unsigned int m_Count;
+		unsigned int m_Type;
 
 	public:
 		IndexBuffer(const unsigned int* data, const unsigned int count);
+		IndexBuffer(const unsigned short* data, const unsigned int count);
 
 		void bind() const;
 		void unbind() const;
 		void del() const;
 
 		inline unsigned int count() const { return m_Count; }
+		// GL_UNSIGNED_INT or GL_UNSIGNED_SHORT.
+		inline unsigned int getType() const { return m_Type; }
 
 	};
 
@@ -0,0 +1,32 @@
+#include "IndirectBuffer.h"
+
+namespace Pressure {
+
+	IndirectBuffer::IndirectBuffer() {
+		glGenBuffers(1, &m_ID);
+	}
+
+	void IndirectBuffer::clear() {
+		m_Commands.clear();
+	}
+
+	void IndirectBuffer::push(const DrawElementsCommand& command) {
+		m_Commands.push_back(command);
+	}
+
+	void IndirectBuffer::upload() {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_ID);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Commands.size() * sizeof(DrawElementsCommand), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, m_Commands.size() * sizeof(DrawElementsCommand), m_Commands.data());
+	}
+
+	void IndirectBuffer::draw(const unsigned int first, const unsigned int count, const unsigned int indexType) const {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_ID);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, (const void*)(first * sizeof(DrawElementsCommand)), count, 0);
+	}
+
+	void IndirectBuffer::del() const {
+		glDeleteBuffers(1, &m_ID);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include "../../Common.h"
+
+namespace Pressure {
+
+	// Layout of one glMultiDrawElementsIndirect command.
+	struct DrawElementsCommand {
+		unsigned int count;
+		unsigned int instanceCount;
+		unsigned int firstIndex;
+		int baseVertex;
+		unsigned int baseInstance;
+	};
+
+	// Draw commands of a pass, collected on the CPU and uploaded once before the pass is drawn.
+	class IndirectBuffer {
+
+	private:
+		unsigned int m_ID;
+		std::vector<DrawElementsCommand> m_Commands;
+
+	public:
+		IndirectBuffer();
+
+		void clear();
+		void push(const DrawElementsCommand& command);
+		void upload();
+		// Draws the commands [first, first + count) with the currently bound vertex array, whose indices are of indexType.
+		void draw(const unsigned int first, const unsigned int count, const unsigned int indexType) const;
+		void del() const;
+
+		inline unsigned int size() const { return m_Commands.size(); }
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "TimerQuery.h"
+
+namespace Pressure {
+
+	TimerQuery::TimerQuery()
+		: m_Issued(), m_Current(0), m_Milliseconds(0) {
+		glGenQueries(LATENCY, m_IDs);
+	}
+
+	void TimerQuery::begin() {
+		if (m_Issued[m_Current]) {
+			int available = 0;
+			glGetQueryObjectiv(m_IDs[m_Current], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available) {
+				GLuint64 elapsed = 0;
+				glGetQueryObjectui64v(m_IDs[m_Current], GL_QUERY_RESULT, &elapsed);
+				m_Milliseconds = elapsed / 1000000.f;
+			}
+		}
+		glBeginQuery(GL_TIME_ELAPSED, m_IDs[m_Current]);
+	}
+
+	void TimerQuery::end() {
+		glEndQuery(GL_TIME_ELAPSED);
+		m_Issued[m_Current] = true;
+		m_Current = (m_Current + 1) % LATENCY;
+	}
+
+	void TimerQuery::del() const {
+		glDeleteQueries(LATENCY, m_IDs);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../../Common.h"
+
+namespace Pressure {
+
+	// GPU time spent between begin() and end(). Results are read LATENCY uses later, by when they are long
+	// available, so timing never waits for the GPU. Only one query can be running at a time.
+	class TimerQuery {
+
+	private:
+		const static unsigned int LATENCY = 4;
+
+		unsigned int m_IDs[LATENCY];
+		bool m_Issued[LATENCY];
+		unsigned int m_Current;
+		float m_Milliseconds;
+
+	public:
+		TimerQuery();
+
+		void begin();
+		void end();
+		void del() const;
+
+		// Time of the section LATENCY uses ago, 0 until the first result came in.
+		inline float getMilliseconds() const { return m_Milliseconds; }
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "UniformBuffer.h"
+
+namespace Pressure {
+
+	UniformBuffer::UniformBuffer(const unsigned int size)
+		: m_Size(size) {
+		glGenBuffers(1, &m_ID);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_ID);
+		glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	void UniformBuffer::update(const void* data, const unsigned int size) {
+		glBindBuffer(GL_UNIFORM_BUFFER, m_ID);
+		glBufferData(GL_UNIFORM_BUFFER, m_Size, nullptr, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	void UniformBuffer::bindRange(const unsigned int binding, const unsigned int offset, const unsigned int size) const {
+		glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_ID, offset, size);
+	}
+
+	void UniformBuffer::del() const {
+		glDeleteBuffers(1, &m_ID);
+	}
+
+	unsigned int UniformBuffer::getOffsetAlignment() {
+		int alignment = 256;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		return alignment;
+	}
+
+}
\ No newline at end of file
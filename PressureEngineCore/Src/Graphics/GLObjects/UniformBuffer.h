@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../../Common.h"
+
+namespace Pressure {
+
+	// Buffer of std140 uniform blocks shared by every program that declares them.
+	class UniformBuffer {
+
+	private:
+		unsigned int m_ID;
+		unsigned int m_Size;
+
+	public:
+		UniformBuffer(const unsigned int size);
+
+		// Replaces the first size bytes, the buffer is orphaned so draws still reading the old contents do not stall.
+		void update(const void* data, const unsigned int size);
+		// Makes [offset, offset + size) the block at binding, offset has to be a multiple of getOffsetAlignment().
+		void bindRange(const unsigned int binding, const unsigned int offset, const unsigned int size) const;
+		void del() const;
+
+		inline unsigned int getSize() const { return m_Size; }
+		static unsigned int getOffsetAlignment();
+
+	};
+
+}
\ No newline at end of file
@@ -6,19 +6,19 @@ namespace Pressure {
 
 	VertexArray::VertexArray() {
 		glGenVertexArrays(1, &m_ID);
-		glBindVertexArray(m_ID);
+		GLState::bindVertexArray(m_ID);
 	}
 
 	void VertexArray::bind() const {
-		glBindVertexArray(m_ID);
+		GLState::bindVertexArray(m_ID);
 	}
 	
 	void VertexArray::unbind() const {
-		glBindVertexArray(NULL);
+		GLState::bindVertexArray(NULL);
 	}
 
 	void VertexArray::del() const {
-		glDeleteVertexArrays(1, &m_ID);
+		GLState::deleteVertexArray(m_ID);
 	}
 
 	unsigned int VertexArray::getID() const {
@@ -32,7 +32,9 @@ namespace Pressure {
 		for (unsigned int i = 0; i < elements.size(); i++) {
 			const auto& element = elements[i];
 			element.buffer.bind();
-			glVertexAttribPointer(i, element.count, element.type, element.normalized, 0, 0);			
+			glVertexAttribPointer(i, element.count, element.type, element.normalized, element.stride, (const void*)element.offset);
+			// Enabled attributes are part of the vertex array, so the renderers do not have to toggle them per draw.
+			glEnableVertexAttribArray(i);
 		}		
 	}
 
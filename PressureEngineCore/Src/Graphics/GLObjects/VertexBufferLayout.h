@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "VertexBuffer.h"
+#include "VertexFormat.h"
 #include "../../DllExport.h"
 
 namespace Pressure {
@@ -11,6 +12,9 @@ namespace Pressure {
 		unsigned int type;
 		unsigned int count;
 		bool normalized;
+		// Both 0 for a tightly packed stream of its own.
+		unsigned int stride;
+		unsigned int offset;
 	};
 
 	class PRESSURE_API VertexBufferLayout {
@@ -30,10 +34,19 @@ namespace Pressure {
 
 		template<>
 		void push<float>(const unsigned int count, const VertexBuffer& buffer) {
-			m_Elements.push_back({ buffer, GL_FLOAT, count, false });
+			m_Elements.push_back({ buffer, GL_FLOAT, count, false, 0, 0 });
 			m_Stride += count * sizeof(float);
 		}
 
+		// Adds every attribute of the format, interleaved in the one buffer.
+		void push(const VertexBuffer& buffer, const VertexFormat& format) {
+			for (unsigned int i = 0; i < VertexFormat::ATTRIBUTE_COUNT; i++) {
+				const VertexFormat::Attribute& attribute = format.getAttribute(i);
+				m_Elements.push_back({ buffer, attribute.type, attribute.count, attribute.normalized, format.getStride(), attribute.offset });
+			}
+			m_Stride += format.getStride();
+		}
+
 		inline std::vector<VertexBufferElement>& getElements() const { return (std::vector<VertexBufferElement>&)m_Elements; }
 		inline unsigned int getStride() const { return m_Stride; }		
 
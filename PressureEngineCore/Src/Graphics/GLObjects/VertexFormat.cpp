@@ -0,0 +1,119 @@
+#include "VertexFormat.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Pressure {
+
+	VertexFormat::VertexFormat(const TexCoordEncoding texCoords, const NormalEncoding normals)
+		: m_TexCoords(texCoords), m_Normals(normals) {
+		m_Attributes[0] = { GL_FLOAT, 3, false, 0 };
+		m_Stride = 3 * sizeof(float);
+
+		if (texCoords == TEXCOORD_FLOAT)
+			m_Attributes[1] = { GL_FLOAT, 2, false, m_Stride };
+		else if (texCoords == TEXCOORD_HALF_FLOAT)
+			m_Attributes[1] = { GL_HALF_FLOAT, 2, false, m_Stride };
+		else
+			m_Attributes[1] = { GL_UNSIGNED_SHORT, 2, true, m_Stride };
+		m_Stride += texCoords == TEXCOORD_FLOAT ? 2 * sizeof(float) : 2 * sizeof(uint16_t);
+
+		// The w component is unused, the shaders only read xyz.
+		if (normals == NORMAL_FLOAT)
+			m_Attributes[2] = { GL_FLOAT, 3, false, m_Stride };
+		else
+			m_Attributes[2] = { GL_INT_2_10_10_10_REV, 4, true, m_Stride };
+		m_Stride += normals == NORMAL_FLOAT ? 3 * sizeof(float) : sizeof(uint32_t);
+	}
+
+	VertexFormat VertexFormat::choose(const std::vector<float>& textureCoords, const bool quantize) {
+		if (!quantize)
+			return VertexFormat(TEXCOORD_FLOAT, NORMAL_FLOAT);
+
+		float min = 0, max = 0;
+		for (float value : textureCoords) {
+			min = std::min(min, value);
+			max = std::max(max, value);
+		}
+		if (min >= 0 && max <= 1)
+			return VertexFormat(TEXCOORD_NORMALIZED_SHORT, NORMAL_INT_2_10_10_10);
+		// Half floats have 11 bits of precision, beyond 2 a texel of a large texture is no longer addressable.
+		if (min >= -2 && max <= 2)
+			return VertexFormat(TEXCOORD_HALF_FLOAT, NORMAL_INT_2_10_10_10);
+		return VertexFormat(TEXCOORD_FLOAT, NORMAL_INT_2_10_10_10);
+	}
+
+	void VertexFormat::pack(const std::vector<float>& positions, const std::vector<float>& textureCoords, const std::vector<float>& normals, const unsigned int vertexCount,
+		std::vector<unsigned char>& dest) const {
+		unsigned int begin = dest.size();
+		dest.resize(begin + vertexCount * m_Stride);
+		for (unsigned int i = 0; i < vertexCount; i++) {
+			unsigned char* vertex = &dest[begin + i * m_Stride];
+			std::memcpy(vertex, &positions[i * 3], 3 * sizeof(float));
+
+			float u = i * 2 + 1 < textureCoords.size() ? textureCoords[i * 2] : 0;
+			float v = i * 2 + 1 < textureCoords.size() ? textureCoords[i * 2 + 1] : 0;
+			unsigned char* texCoords = vertex + m_Attributes[1].offset;
+			if (m_TexCoords == TEXCOORD_FLOAT) {
+				float uv[2] = { u, v };
+				std::memcpy(texCoords, uv, sizeof(uv));
+			} else {
+				uint16_t uv[2];
+				if (m_TexCoords == TEXCOORD_HALF_FLOAT) {
+					uv[0] = toHalf(u);
+					uv[1] = toHalf(v);
+				} else {
+					uv[0] = (uint16_t)(std::min(std::max(u, 0.f), 1.f) * 65535 + 0.5f);
+					uv[1] = (uint16_t)(std::min(std::max(v, 0.f), 1.f) * 65535 + 0.5f);
+				}
+				std::memcpy(texCoords, uv, sizeof(uv));
+			}
+
+			float normal[3] = { 0, 0, 0 };
+			if (i * 3 + 2 < normals.size())
+				std::memcpy(normal, &normals[i * 3], sizeof(normal));
+			unsigned char* normalDest = vertex + m_Attributes[2].offset;
+			if (m_Normals == NORMAL_FLOAT) {
+				std::memcpy(normalDest, normal, sizeof(normal));
+			} else {
+				uint32_t packed = packNormal(normal[0], normal[1], normal[2]);
+				std::memcpy(normalDest, &packed, sizeof(packed));
+			}
+		}
+	}
+
+	uint16_t VertexFormat::toHalf(const float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		uint32_t sign = (bits >> 16) & 0x8000;
+		int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+		uint32_t mantissa = bits & 0x7FFFFF;
+
+		if (exponent <= 0) {
+			// Denormal half, values below its range become zero.
+			if (exponent < -10)
+				return (uint16_t)sign;
+			mantissa |= 0x800000;
+			unsigned int shift = 14 - exponent;
+			uint32_t half = mantissa >> shift;
+			if ((mantissa >> (shift - 1)) & 1)
+				half++;
+			return (uint16_t)(sign | half);
+		}
+		if (exponent >= 31)
+			return (uint16_t)(sign | 0x7C00);
+
+		// Rounding may carry into the exponent, which still gives the correctly rounded value.
+		uint32_t half = sign | (exponent << 10) | (mantissa >> 13);
+		if (mantissa & 0x1000)
+			half++;
+		return (uint16_t)half;
+	}
+
+	uint32_t VertexFormat::packNormal(const float x, const float y, const float z) {
+		auto pack = [](const float value) {
+			return (uint32_t)((int)std::round(std::min(std::max(value, -1.f), 1.f) * 511) & 0x3FF);
+		};
+		return pack(x) | (pack(y) << 10) | (pack(z) << 20);
+	}
+
+}
\ No newline at end of file
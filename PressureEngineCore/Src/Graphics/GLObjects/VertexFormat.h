@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "../../Common.h"
+
+namespace Pressure {
+
+	// Interleaved vertex stream of textured meshes: position, texture coordinates and normal at attributes 0, 1 and 2.
+	// Positions stay full floats. Texture coordinates can go down to two 16-bit values and normals to one packed
+	// 2_10_10_10 value, 20 bytes per vertex instead of 32. The GL expands both, the shaders read them unchanged.
+	class VertexFormat {
+
+	public:
+		enum TexCoordEncoding {
+			TEXCOORD_FLOAT,
+			TEXCOORD_HALF_FLOAT,
+			// Unsigned normalized, only for coordinates within [0, 1].
+			TEXCOORD_NORMALIZED_SHORT
+		};
+
+		enum NormalEncoding {
+			NORMAL_FLOAT,
+			NORMAL_INT_2_10_10_10
+		};
+
+		struct Attribute {
+			unsigned int type;
+			unsigned int count;
+			bool normalized;
+			unsigned int offset;
+		};
+
+		const static unsigned int ATTRIBUTE_COUNT = 3;
+
+	private:
+		TexCoordEncoding m_TexCoords;
+		NormalEncoding m_Normals;
+		Attribute m_Attributes[ATTRIBUTE_COUNT];
+		unsigned int m_Stride;
+
+	public:
+		VertexFormat(const TexCoordEncoding texCoords = TEXCOORD_FLOAT, const NormalEncoding normals = NORMAL_FLOAT);
+
+		// Smallest format that keeps the texture coordinates precise: normalized shorts within [0, 1],
+		// half floats up to 2 and floats for coordinates tiling further. Full floats when quantize is off.
+		static VertexFormat choose(const std::vector<float>& textureCoords, const bool quantize);
+
+		// Appends vertexCount interleaved vertices to dest. Missing texture coordinates or normals are written as zero.
+		void pack(const std::vector<float>& positions, const std::vector<float>& textureCoords, const std::vector<float>& normals, const unsigned int vertexCount,
+			std::vector<unsigned char>& dest) const;
+
+		inline const Attribute& getAttribute(const unsigned int attribute) const { return m_Attributes[attribute]; }
+		inline unsigned int getStride() const { return m_Stride; }
+
+		inline bool operator==(const VertexFormat& other) const { return m_TexCoords == other.m_TexCoords && m_Normals == other.m_Normals; }
+		inline bool operator!=(const VertexFormat& other) const { return !(*this == other); }
+
+	private:
+		static uint16_t toHalf(const float value);
+		static uint32_t packNormal(const float x, const float y, const float z);
+
+	};
+
+}
\ No newline at end of file
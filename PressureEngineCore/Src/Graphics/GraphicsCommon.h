@@ -4,6 +4,7 @@
 #include "OBJLoader.h"
 #include "Window.h"
 #include "MasterRenderer.h"
+#include "RenderThread.h"
 #include "Particles\ParticleMaster.h"
 #include "Particles\ParticleSystem.h"
 #include "Guis\GuiRenderer.h"
@@ -15,24 +15,21 @@ namespace Pressure {
 	void GuiRenderer::render(std::vector<GuiTexture>& guis) {
 		m_Shader.start();
 		m_Quad.getVertexArray().bind();
-		glEnableVertexAttribArray(0);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glDisable(GL_DEPTH_TEST);
+		GLState::enable(GL_BLEND);
+		GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLState::disable(GL_DEPTH_TEST);
 		for (auto& gui : guis) {
-			glActiveTexture(GL_TEXTURE0);
+			GLState::activeTexture(GL_TEXTURE0);
 			if(gui.isTextureManaged())
 				TextureManager::Inst()->BindTexture(gui.getTexture());
 			else 
-				glBindTexture(GL_TEXTURE_2D, gui.getTexture());
+				GLState::bindTexture(GL_TEXTURE_2D, gui.getTexture());
 			m_Shader.loadTransformation(Matrix4f().createTransformationMatrix(gui.getPosition(), gui.getScale()));
 			glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Quad.getVertexCount());
 		}
-		glDisable(GL_BLEND);
-		glEnable(GL_DEPTH_TEST);
-		glDisableVertexAttribArray(0);
+		GLState::disable(GL_BLEND);
+		GLState::enable(GL_DEPTH_TEST);
 		m_Quad.getVertexArray().unbind();
-		m_Shader.stop();
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "Impostor.h"
+#include "../MasterRenderer.h"
+#include "../Textures/TextureManager.h"
+#include "../GLObjects/GLState.h"
+
+namespace Pressure {
+
+	const unsigned int Impostor::VIEWS = 8;
+
+	Impostor::Impostor(Window& window, const TexturedModel& model, ImpostorBakeShader& shader, const unsigned int resolution, const float distance)
+		: m_Atlas(window, VIEWS * resolution, resolution, 2, 1, FrameBuffer::DepthBufferType::RENDER_BUFFER, true), m_Distance(distance) {
+		bake(model, shader, resolution);
+	}
+
+	void Impostor::bake(const TexturedModel& model, ImpostorBakeShader& shader, const unsigned int resolution) {
+		const RawModel& rawModel = model.getRawModel();
+		const AABB bounds = rawModel.getBounds();
+		Vector3f size;
+		bounds.getMax().sub(bounds.getMin(), size);
+		// Every view covers the widest the model gets around its vertical axis.
+		const float radius = std::sqrt(size.getX() * size.getX() + size.getZ() * size.getZ()) / 2;
+		m_Width = radius * 2;
+		m_Height = size.getY();
+
+		m_Atlas.bind();
+		// The default clear color is transparent black, which the impostor shader relies on.
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		GLState::enable(GL_DEPTH_TEST);
+		GLState::disable(GL_CLIP_DISTANCE0);
+		GLState::disable(GL_BLEND);
+		MasterRenderer::disableCulling();
+
+		shader.start();
+		shader.loadBounds(bounds.getCenter(), Vector2f(radius, m_Height / 2));
+		rawModel.getVertexArray().bind();
+		GLState::activeTexture(GL_TEXTURE0);
+		TextureManager::Inst()->BindTexture(model.getTexture().getID());
+		for (unsigned int i = 0; i < VIEWS; i++) {
+			glViewport(i * resolution, 0, resolution, resolution);
+			shader.loadAngle(2 * Math::PI * i / VIEWS);
+			glDrawElementsBaseVertex(GL_TRIANGLES, rawModel.getVertexCount(), rawModel.getIndexType(), (const void*)(rawModel.getFirstIndex() * rawModel.getIndexSize()),
+				rawModel.getBaseVertex());
+		}
+		rawModel.getVertexArray().unbind();
+		MasterRenderer::enableCulling();
+		m_Atlas.unbind();
+
+		for (unsigned int i = 0; i < 2; i++) {
+			GLState::bindTexture(GL_TEXTURE_2D, m_Atlas.getColorTexture(i));
+			glGenerateMipmap(GL_TEXTURE_2D);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+#include "../Models/TexturedModel.h"
+#include "../GLObjects/FrameBuffer.h"
+#include "ImpostorBakeShader.h"
+
+namespace Pressure {
+
+	// A model baked from VIEWS directions around its vertical axis into one row of an atlas, color in the first
+	// texture and model space normals in the second. Drawn as a camera facing quad past the given distance.
+	class Impostor {
+
+	public:
+		const static unsigned int VIEWS;
+
+	private:
+		FrameBuffer m_Atlas;
+		// Size of the quad in model space.
+		float m_Width;
+		float m_Height;
+		float m_Distance;
+
+	public:
+		Impostor(Window& window, const TexturedModel& model, ImpostorBakeShader& shader, const unsigned int resolution, const float distance);
+
+		inline unsigned int getColorAtlas() const { return m_Atlas.getColorTexture(0); }
+		inline unsigned int getNormalAtlas() const { return m_Atlas.getColorTexture(1); }
+		inline float getWidth() const { return m_Width; }
+		inline float getHeight() const { return m_Height; }
+		inline float getDistance() const { return m_Distance; }
+
+	private:
+		void bake(const TexturedModel& model, ImpostorBakeShader& shader, const unsigned int resolution);
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "ImpostorBakeShader.h"
+#include "ImpostorShaderSource.h"
+
+namespace Pressure {
+
+	ImpostorBakeShader::ImpostorBakeShader() {
+		Shader::loadShaders(ImpostorShaderSource::bakeVertexShader, ImpostorShaderSource::bakeFragmentShader);
+	}
+
+	void ImpostorBakeShader::getAllUniformLocations() {
+		location_angle = Shader::getUniformLocation("angle");
+		location_center = Shader::getUniformLocation("center");
+		location_extent = Shader::getUniformLocation("extent");
+	}
+
+	void ImpostorBakeShader::bindAttributes() {
+		Shader::bindAttribute(0, "position");
+		Shader::bindAttribute(1, "textureCoords");
+		Shader::bindAttribute(2, "normal");
+	}
+
+	void ImpostorBakeShader::loadAngle(const float angle) {
+		Shader::loadFloat(location_angle, angle);
+	}
+
+	void ImpostorBakeShader::loadBounds(const Vector3f& center, const Vector2f& extent) {
+		Shader::loadVector(location_center, center);
+		Shader::loadVector(location_extent, extent);
+	}
+
+}
\ No newline at end of file
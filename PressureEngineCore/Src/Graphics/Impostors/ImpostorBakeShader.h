@@ -0,0 +1,29 @@
+#pragma once
+#include "../Shaders/Shader.h"
+
+namespace Pressure {
+
+	// Renders a model into one view of an impostor atlas.
+	class ImpostorBakeShader : public Shader {
+
+	public:
+		ImpostorBakeShader();
+
+	protected:
+		virtual void getAllUniformLocations() override;
+		virtual void bindAttributes() override;
+
+	public:
+		// Angle of the view around the vertical axis, in radians.
+		void loadAngle(const float angle);
+		// Center of the model bounds and the radius and half height the view covers.
+		void loadBounds(const Vector3f& center, const Vector2f& extent);
+
+	private:
+		int location_angle;
+		int location_center;
+		int location_extent;
+
+	};
+
+}
\ No newline at end of file
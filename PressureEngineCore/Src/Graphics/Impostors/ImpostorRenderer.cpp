@@ -0,0 +1,112 @@
+#include "ImpostorRenderer.h"
+#include <algorithm>
+#include "../MasterRenderer.h"
+#include "../GLObjects/GLState.h"
+#include "../../Services/Properties.h"
+
+namespace Pressure {
+
+	const std::vector<float> ImpostorRenderer::VERTICES = { -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f, -0.5f };
+	const unsigned int ImpostorRenderer::INSTANCE_DATA_LENGTH = 8;
+	const float ImpostorRenderer::FADE_RANGE = 0.1f;
+	const int ImpostorRenderer::NO_IMPOSTOR = -1;
+
+	ImpostorRenderer::ImpostorRenderer(Window& window, Loader& loader)
+		: m_Window(window), m_Quad(loader.loadToVao(VERTICES, 2)), m_vbo(nullptr, INSTANCE_DATA_LENGTH),
+		m_Resolution(std::stoi(Properties::get("impostorResolution"))) {
+		m_Quad.getVertexArray().bind();
+		m_vbo.addInstancedAttribute(1, 4, INSTANCE_DATA_LENGTH, 0);
+		m_vbo.addInstancedAttribute(2, 4, INSTANCE_DATA_LENGTH, 4);
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glEnableVertexAttribArray(2);
+		m_Quad.getVertexArray().unbind();
+	}
+
+	void ImpostorRenderer::add(const TexturedModel& model, const float distance) {
+		if (m_ImpostorLookup.find(model) != m_ImpostorLookup.end())
+			return;
+		m_ImpostorLookup[model] = m_Impostors.size();
+		m_Impostors.push_back(std::make_unique<Impostor>(m_Window, model, m_BakeShader, m_Resolution, distance));
+		m_Instances.resize(m_Impostors.size());
+		// Batches already known might use the new impostor.
+		m_BatchImpostors.clear();
+	}
+
+	const std::vector<SceneEntry>& ImpostorRenderer::prepare(const Scene& scene, const std::vector<SceneEntry>& visible, const Vector3f& cameraPosition) {
+		for (std::vector<float>& instances : m_Instances)
+			instances.clear();
+		if (m_Impostors.empty())
+			return visible;
+
+		const std::vector<SceneBatch>& batches = scene.getBatches();
+		while (m_BatchImpostors.size() < batches.size())
+			m_BatchImpostors.push_back(getImpostor(batches[m_BatchImpostors.size()]));
+
+		m_Meshes.clear();
+		for (const SceneEntry& entry : visible) {
+			const int index = m_BatchImpostors[entry.batch];
+			if (index == NO_IMPOSTOR) {
+				m_Meshes.push_back(entry);
+				continue;
+			}
+
+			const SceneBatch& batch = batches[entry.batch];
+			const Impostor& impostor = *m_Impostors[index];
+			const float dx = batch.centerX[entry.entry] - cameraPosition.getX();
+			const float dy = batch.centerY[entry.entry] - cameraPosition.getY();
+			const float dz = batch.centerZ[entry.entry] - cameraPosition.getZ();
+			const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+			if (distance < impostor.getDistance())
+				m_Meshes.push_back(entry);
+
+			const float fadeStart = impostor.getDistance() * (1 - FADE_RANGE);
+			if (distance <= fadeStart)
+				continue;
+			const Entity& entity = batch.entities[entry.entry];
+			std::vector<float>& instances = m_Instances[index];
+			instances.push_back(batch.centerX[entry.entry]);
+			instances.push_back(batch.centerY[entry.entry]);
+			instances.push_back(batch.centerZ[entry.entry]);
+			instances.push_back(impostor.getWidth() * entity.getScale());
+			instances.push_back(impostor.getHeight() * entity.getScale());
+			instances.push_back((float) Math::toRadians(entity.getRotation().getY()));
+			instances.push_back(std::min((distance - fadeStart) / (impostor.getDistance() - fadeStart), 1.f));
+			instances.push_back(0);
+		}
+		return m_Meshes;
+	}
+
+	void ImpostorRenderer::render() {
+		m_Shader.start();
+		m_Shader.loadViewCount((float) Impostor::VIEWS);
+		m_Quad.getVertexArray().bind();
+		// The quads turn around the vertical axis only, so they can be seen from behind when looking down.
+		MasterRenderer::disableCulling();
+		for (unsigned int i = 0; i < m_Impostors.size(); i++) {
+			if (m_Instances[i].empty())
+				continue;
+			GLState::activeTexture(GL_TEXTURE0);
+			GLState::bindTexture(GL_TEXTURE_2D, m_Impostors[i]->getColorAtlas());
+			GLState::activeTexture(GL_TEXTURE1);
+			GLState::bindTexture(GL_TEXTURE_2D, m_Impostors[i]->getNormalAtlas());
+			m_vbo.update(&m_Instances[i][0], m_Instances[i].size() * sizeof(float));
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, m_Quad.getVertexCount(), m_Instances[i].size() / INSTANCE_DATA_LENGTH);
+		}
+		MasterRenderer::enableCulling();
+		m_Quad.getVertexArray().unbind();
+	}
+
+	void ImpostorRenderer::cleanUp() {
+		m_Shader.cleanUp();
+		m_BakeShader.cleanUp();
+		m_vbo.del();
+		m_Impostors.clear();
+	}
+
+	int ImpostorRenderer::getImpostor(const SceneBatch& batch) const {
+		auto it = m_ImpostorLookup.find(batch.model);
+		return it == m_ImpostorLookup.end() ? NO_IMPOSTOR : it->second;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "../Loader.h"
+#include "../Window.h"
+#include "../Models/RawModel.h"
+#include "../Scene/Scene.h"
+#include "Impostor.h"
+#include "ImpostorShader.h"
+#include "ImpostorBakeShader.h"
+
+namespace Pressure {
+
+	// Replaces distant entities of the models given to add() by billboards, drawn with one instanced call per model.
+	class ImpostorRenderer {
+
+	private:
+		const static std::vector<float> VERTICES;
+		const static unsigned int INSTANCE_DATA_LENGTH;
+		// Share of the distance before it over which an impostor fades in, while the mesh is still drawn.
+		const static float FADE_RANGE;
+		const static int NO_IMPOSTOR;
+
+		// An impostor only depends on how the model looks, so copies with other level of detail thresholds share it.
+		struct SameLook {
+			bool operator()(const TexturedModel& a, const TexturedModel& b) const { return a.sharesMeshAndTexture(b); }
+		};
+
+		Window& m_Window;
+		RawModel m_Quad;
+		ImpostorShader m_Shader;
+		ImpostorBakeShader m_BakeShader;
+		VertexBuffer m_vbo;
+		// Size of a view in the atlases.
+		const unsigned int m_Resolution;
+
+		std::vector<std::unique_ptr<Impostor>> m_Impostors;
+		std::unordered_map<TexturedModel, unsigned int, std::hash<TexturedModel>, SameLook> m_ImpostorLookup;
+		// Impostor of every scene batch, NO_IMPOSTOR for batches only drawn as meshes.
+		std::vector<int> m_BatchImpostors;
+
+		// Filled by prepare().
+		std::vector<SceneEntry> m_Meshes;
+		std::vector<std::vector<float>> m_Instances;
+
+	public:
+		ImpostorRenderer(Window& window, Loader& loader);
+
+		// Bakes the atlas of a model, its entities are drawn as impostors from distance on.
+		void add(const TexturedModel& model, const float distance);
+		// Sorts the visible entities into meshes and impostors, returns the ones still drawn as meshes.
+		const std::vector<SceneEntry>& prepare(const Scene& scene, const std::vector<SceneEntry>& visible, const Vector3f& cameraPosition);
+		// Draws the impostors of the last prepare() call with the view bound in FrameUniforms.
+		void render();
+		void cleanUp();
+
+	private:
+		int getImpostor(const SceneBatch& batch) const;
+
+	};
+
+}
\ No newline at end of file
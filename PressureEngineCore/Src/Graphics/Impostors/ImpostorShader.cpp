@@ -0,0 +1,31 @@
+#include "ImpostorShader.h"
+#include "ImpostorShaderSource.h"
+
+namespace Pressure {
+
+	ImpostorShader::ImpostorShader() {
+		Shader::loadShaders(ImpostorShaderSource::vertexShader, ImpostorShaderSource::fragmentShader);
+	}
+
+	void ImpostorShader::getAllUniformLocations() {
+		location_viewCount = Shader::getUniformLocation("viewCount");
+		location_colorAtlas = Shader::getUniformLocation("colorAtlas");
+		location_normalAtlas = Shader::getUniformLocation("normalAtlas");
+	}
+
+	void ImpostorShader::bindAttributes() {
+		Shader::bindAttribute(0, "position");
+		Shader::bindAttribute(1, "centerWidth");
+		Shader::bindAttribute(2, "heightYawFade");
+	}
+
+	void ImpostorShader::loadViewCount(const float viewCount) {
+		Shader::loadFloat(location_viewCount, viewCount);
+	}
+
+	void ImpostorShader::connectTextureUnits() {
+		Shader::loadInt(location_colorAtlas, 0);
+		Shader::loadInt(location_normalAtlas, 1);
+	}
+
+}
\ No newline at end of file
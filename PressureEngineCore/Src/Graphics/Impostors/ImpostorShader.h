@@ -0,0 +1,26 @@
+#pragma once
+#include "../Shaders/Shader.h"
+
+namespace Pressure {
+
+	class ImpostorShader : public Shader {
+
+	public:
+		ImpostorShader();
+
+	protected:
+		virtual void getAllUniformLocations() override;
+		virtual void bindAttributes() override;
+
+	public:
+		void loadViewCount(const float viewCount);
+		void connectTextureUnits() override;
+
+	private:
+		int location_viewCount;
+		int location_colorAtlas;
+		int location_normalAtlas;
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "ImpostorShaderSource.h"
+
+namespace Pressure {
+
+	const std::string ImpostorShaderSource::bakeVertexShader =
+R"(#version 330 core
+
+in vec3 position;
+in vec2 textureCoords;
+in vec3 normal;
+
+out vec2 pass_textureCoords;
+out vec3 pass_normal;
+
+uniform float angle;
+uniform vec3 center;
+uniform vec2 extent; // x = radius around the vertical axis, y = half height.
+
+void main(void) {
+
+	// Orthographic camera circling the vertical axis at angle, looking at the center.
+	vec3 p = position - center;
+	float s = sin(angle);
+	float c = cos(angle);
+	gl_Position = vec4((c * p.x - s * p.z) / extent.x, p.y / extent.y, -(s * p.x + c * p.z) / extent.x, 1.0);
+
+	pass_textureCoords = textureCoords;
+	pass_normal = normal;
+
+})";
+
+	const std::string ImpostorShaderSource::bakeFragmentShader =
+R"(#version 330 core
+
+in vec2 pass_textureCoords;
+in vec3 pass_normal;
+
+layout (location = 0) out vec4 out_Color;
+layout (location = 1) out vec4 out_Normal;
+
+uniform sampler2D textureSampler;
+
+void main(void) {
+
+	vec4 color = texture(textureSampler, pass_textureCoords);
+	if (color.a < 0.5) {
+		discard;
+	}
+	out_Color = vec4(color.rgb, 1.0);
+	out_Normal = vec4(normalize(pass_normal) * 0.5 + 0.5, 1.0);
+
+})";
+
+	const std::string ImpostorShaderSource::vertexShader =
+R"(#version 330 core
+
+in vec2 position;
+in vec4 centerWidth;
+in vec4 heightYawFade;
+
+out vec2 atlasCoords1;
+out vec2 atlasCoords2;
+out float viewBlend;
+out vec3 worldPosition;
+out float yaw;
+out float fade;
+
+layout (std140) uniform ViewData {
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+	vec4 cameraPosition;
+	vec4 plane;
+};
+
+uniform float viewCount;
+
+const float PI = 3.1415926535;
+
+void main(void) {
+
+	// Turns around the vertical axis only, so trees stay upright when seen from above.
+	vec2 toCamera = cameraPosition.xz - centerWidth.xz;
+	float cameraAngle = atan(toCamera.x, toCamera.y);
+	vec3 right = vec3(cos(cameraAngle), 0.0, -sin(cameraAngle));
+	worldPosition = centerWidth.xyz + right * position.x * centerWidth.w + vec3(0.0, position.y * heightYawFade.x, 0.0);
+	gl_Position = projectionMatrix * viewMatrix * vec4(worldPosition, 1.0);
+
+	// Blends the two baked views closest to the angle the model is seen from.
+	float view = mod((cameraAngle - heightYawFade.y) / (2.0 * PI) * viewCount, viewCount);
+	float first = floor(view);
+	viewBlend = view - first;
+	vec2 cell = position + vec2(0.5);
+	atlasCoords1 = vec2((first + cell.x) / viewCount, cell.y);
+	atlasCoords2 = vec2((mod(first + 1.0, viewCount) + cell.x) / viewCount, cell.y);
+
+	yaw = heightYawFade.y;
+	fade = heightYawFade.z;
+
+})";
+
+	const std::string ImpostorShaderSource::fragmentShader =
+R"(#version 330 core
+
+in vec2 atlasCoords1;
+in vec2 atlasCoords2;
+in float viewBlend;
+in vec3 worldPosition;
+in float yaw;
+in float fade;
+
+layout (location = 0) out vec4 out_Color;
+layout (location = 1) out vec4 out_LightColor;
+
+layout (std140) uniform FrameData {
+	vec4 lightPosition[4];
+	vec4 lightColor[4];
+	vec4 attenuation[4];
+	mat4 toShadowMapSpace[4];
+	vec4 cascadeDistances;
+	int cascadeCount;
+	float shadowMapSize;
+	float shadowDistance;
+};
+
+uniform sampler2D colorAtlas;
+uniform sampler2D normalAtlas;
+
+void main(void) {
+
+	vec4 color = mix(texture(colorAtlas, atlasCoords1), texture(colorAtlas, atlasCoords2), viewBlend);
+	// Fades in with a screen-door pattern while the mesh is still drawn behind it.
+	float threshold = fract(sin(dot(gl_FragCoord.xy, vec2(12.9898, 78.233))) * 43758.5453);
+	if (color.a < 0.5 || fade < threshold) {
+		discard;
+	}
+
+	// The atlas is cleared to transparent black, which filtering blends into the edges.
+	color.rgb /= color.a;
+
+	vec3 normal = mix(texture(normalAtlas, atlasCoords1).xyz, texture(normalAtlas, atlasCoords2).xyz, viewBlend) * 2.0 - 1.0;
+	float s = sin(yaw);
+	float c = cos(yaw);
+	normal = normalize(vec3(c * normal.x + s * normal.z, normal.y, -s * normal.x + c * normal.z));
+
+	// Only the sun, without shadows, which are hardly visible at impostor distances.
+	float brightness = max(dot(normal, normalize(lightPosition[0].xyz - worldPosition)), 0.0);
+	vec3 diffuse = max(brightness * lightColor[0].xyz, 0.3);
+
+	out_Color = vec4(diffuse * color.rgb, 1.0);
+	out_LightColor = vec4(0.0, 0.0, 0.0, 1.0);
+
+})";
+
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+
+namespace Pressure {
+
+	struct ImpostorShaderSource {
+
+		const static std::string bakeVertexShader;
+		const static std::string bakeFragmentShader;
+		const static std::string vertexShader;
+		const static std::string fragmentShader;
+
+	};
+
+}
\ No newline at end of file
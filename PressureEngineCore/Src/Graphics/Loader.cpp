@@ -1,8 +1,20 @@
 #include "Loader.h"
 #include <string>
+#include <algorithm>
 #include "Textures\TextureManager.h"
+#include "Models\MeshSimplifier.h"
+#include "../Services/Properties.h"
 
 namespace Pressure {
+
+	const unsigned int Loader::MIN_LOD_INDICES = 3 * 128;
+
+	Loader::Loader()
+		: m_Quantize(Properties::get("vertexQuantization") == "1"), m_LodLevels(std::min(std::max(std::stoi(Properties::get("lodLevels")), 0), (int)RawModel::MAX_LODS - 1)) {
+		// Texture coordinates of the arena meshes have to be within [0, 1] when quantized, the rest get their own vertex array.
+		if (Properties::get("multiDrawIndirect") == "1" && GeometryArena::isSupported())
+			m_Arena = std::make_unique<GeometryArena>(m_Quantize ? VertexFormat(VertexFormat::TEXCOORD_NORMALIZED_SHORT, VertexFormat::NORMAL_INT_2_10_10_10) : VertexFormat());
+	}
 		
 	Loader::~Loader() {
 		for (auto& array : m_VertexArrays) {
@@ -10,40 +22,56 @@ namespace Pressure {
 		}
 		for (auto& layout : m_VertexBufferLayouts) {
 			for (auto& element : layout.getElements()) {
-				element.buffer.del();
+				// Interleaved attributes share a buffer, only the first one owns it.
+				if (element.offset == 0)
+					element.buffer.del();
 			}
 		}
 		for (auto& buffer : m_IndexBuffers) {
 			buffer.del();
 		}
+		if (m_Arena)
+			m_Arena->cleanUp();
 		TextureManager::Inst()->UnloadAllTextures();
 	}
 
 	RawModel Loader::loadToVao(const std::vector<float>& positions, const std::vector<float>& textureCoords, const std::vector<float>& normals, const std::vector<unsigned int>& indices) {
+		const unsigned int vertexCount = positions.size() / 3;
+		VertexFormat format = VertexFormat::choose(textureCoords, m_Quantize);
+		generateLods(positions, textureCoords, normals, indices);
+		if (m_Arena && m_Arena->accepts(format, vertexCount)) {
+			ArenaMesh mesh = m_Arena->add(positions, textureCoords, normals, m_LodIndices);
+			mesh.indexCount = indices.size();
+			RawModel model(m_Arena->getVertexArray(), mesh, calculateAABB(positions));
+			addLods(model);
+			return model;
+		}
+
+		m_VertexScratch.clear();
+		format.pack(positions, textureCoords, normals, vertexCount, m_VertexScratch);
 		VertexBufferLayout layout;
-		layout.push<float>(3, VertexBuffer(&positions[0], positions.size() * sizeof(float)));
-		layout.push<float>(2, VertexBuffer(&textureCoords[0], positions.size() * sizeof(float)));
-		layout.push<float>(3, VertexBuffer(&normals[0], positions.size() * sizeof(float)));
+		layout.push(VertexBuffer(m_VertexScratch.data(), m_VertexScratch.size()), format);
 		VertexArray va;
-		m_IndexBuffers.emplace_back(&indices[0], indices.size());
+		unsigned int indexType = loadIndices(m_LodIndices, vertexCount);
 		va.bindLayout(layout);
 		m_VertexBufferLayouts.push_back(layout);
 		va.unbind();
 		m_VertexArrays.push_back(va);
-		Vector3f min, max;
-		return RawModel(va, indices.size(), calculateAABB(positions));
+		RawModel model(va, indices.size(), calculateAABB(positions), indexType);
+		addLods(model);
+		return model;
 	}
 
 	RawModel Loader::loadToVao(const std::vector<float>& positions, const std::vector<unsigned int>& indices) {
 		VertexBufferLayout layout;
 		layout.push<float>(3, VertexBuffer(&positions[0], positions.size() * sizeof(float)));
 		VertexArray va;
-		m_IndexBuffers.emplace_back(&indices[0], indices.size());
+		unsigned int indexType = loadIndices(indices, positions.size() / 3);
 		va.bindLayout(layout);
 		m_VertexBufferLayouts.push_back(layout);
 		va.unbind();
 		m_VertexArrays.push_back(va);		
-		return RawModel(va, indices.size(), calculateAABB(positions));
+		return RawModel(va, indices.size(), calculateAABB(positions), indexType);
 	}
 
 	RawModel Loader::loadToVao(const std::vector<float>& positions, const unsigned int dimensions) {
@@ -85,15 +113,56 @@ namespace Pressure {
 
 	AABB Loader::calculateAABB(const std::vector<float>& positions, unsigned int dimensions) {
 		Vector3f min = 0, max = 0;
+		if (positions.size() < dimensions)
+			return AABB(min, max);
+
+		for (unsigned int j = 0; j < dimensions; j++)
+			min[j] = max[j] = positions[j];
 		for (unsigned int i = 0; i < positions.size() / dimensions; i++) {
 			for (unsigned int j = 0; j < dimensions; j++) {
-				if (positions[i + j] < min[j])
-					min[j] = positions[i + j];
-				else if (positions[i + j] > max[j])
-					max[j] = positions[i + j];
+				float value = positions[i * dimensions + j];
+				if (value < min[j])
+					min[j] = value;
+				if (value > max[j])
+					max[j] = value;
 			}
 		}
 		return AABB(min, max);
 	}
 
-}
+	unsigned int Loader::loadIndices(const std::vector<unsigned int>& indices, const unsigned int vertexCount) {
+		if (vertexCount > 1 << 16) {
+			m_IndexBuffers.emplace_back(&indices[0], indices.size());
+			return GL_UNSIGNED_INT;
+		}
+		m_IndexScratch.assign(indices.begin(), indices.end());
+		m_IndexBuffers.emplace_back(&m_IndexScratch[0], indices.size());
+		return GL_UNSIGNED_SHORT;
+	}
+
+	void Loader::generateLods(const std::vector<float>& positions, const std::vector<float>& textureCoords, const std::vector<float>& normals, const std::vector<unsigned int>& indices) {
+		m_LodIndices.assign(indices.begin(), indices.end());
+		m_LodCounts.assign(1, indices.size());
+		if (indices.size() < MIN_LOD_INDICES)
+			return;
+
+		for (unsigned int level = 0; level < m_LodLevels; level++) {
+			m_LodScratch.assign(m_LodIndices.end() - m_LodCounts.back(), m_LodIndices.end());
+			MeshSimplifier::simplify(positions, textureCoords, normals, m_LodScratch, m_LodCounts.back() / 6 * 3);
+			// A level that barely differs from the last one is not worth switching to.
+			if (m_LodScratch.size() > m_LodCounts.back() * 3 / 4)
+				break;
+			m_LodIndices.insert(m_LodIndices.end(), m_LodScratch.begin(), m_LodScratch.end());
+			m_LodCounts.push_back(m_LodScratch.size());
+		}
+	}
+
+	void Loader::addLods(RawModel& model) const {
+		unsigned int firstIndex = model.getFirstIndex();
+		for (unsigned int lod = 1; lod < m_LodCounts.size(); lod++) {
+			firstIndex += m_LodCounts[lod - 1];
+			model.addLod(firstIndex, m_LodCounts[lod]);
+		}
+	}
+
+}
\ No newline at end of file
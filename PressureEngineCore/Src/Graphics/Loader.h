@@ -1,21 +1,38 @@
 #pragma once
 #include <vector>
 #include <array>
+#include <memory>
 #include "Models\RawModel.h"
+#include "Models\GeometryArena.h"
 
 namespace Pressure {
 
 	class Loader {
 
 	private:
+		// Meshes with fewer indices are drawn at full detail from every distance.
+		const static unsigned int MIN_LOD_INDICES;
+
 		std::vector<VertexArray> m_VertexArrays;
 		std::vector<VertexBufferLayout> m_VertexBufferLayouts;
 		std::vector<IndexBuffer> m_IndexBuffers;
+		// Holds the textured meshes when multi-draw indirect is on.
+		std::unique_ptr<GeometryArena> m_Arena;
+		bool m_Quantize;
+		std::vector<unsigned char> m_VertexScratch;
+		std::vector<unsigned short> m_IndexScratch;
+		// Simplified levels generated for every textured mesh.
+		unsigned int m_LodLevels;
+		// Indices of all levels of the mesh being loaded back to back, and the index count of each level.
+		std::vector<unsigned int> m_LodIndices;
+		std::vector<unsigned int> m_LodCounts;
+		std::vector<unsigned int> m_LodScratch;
 
 		// Do i even need this?
 		std::vector<unsigned int> m_Textures;
 
 	public:
+		Loader();
 		~Loader();
 
 		RawModel loadToVao(const std::vector<float>& positions, const std::vector<float>& textureCoords, const std::vector<float>& normals, const std::vector<unsigned int>& indices);
@@ -24,8 +41,17 @@ namespace Pressure {
 		unsigned int loadTexture(const char* filePath);
 		unsigned int loadCubeMap(const char* filePath);
 
+		// nullptr unless the renderers submit with multi-draw indirect.
+		inline GeometryArena* getGeometryArena() const { return m_Arena.get(); }
+
 	private:
 		AABB calculateAABB(const std::vector<float>& positions, unsigned int dimensions = 3);
+		// Creates and binds the index buffer, 16-bit when every index fits. Returns the index type.
+		unsigned int loadIndices(const std::vector<unsigned int>& indices, const unsigned int vertexCount);
+		// Fills m_LodIndices and m_LodCounts, each level halving the triangles of the one before until simplification stalls.
+		void generateLods(const std::vector<float>& positions, const std::vector<float>& textureCoords, const std::vector<float>& normals, const std::vector<unsigned int>& indices);
+		// Points the levels of the model at the ranges generateLods() put behind its full detail indices.
+		void addLods(RawModel& model) const;
 		
 	};
 
@@ -1,32 +1,29 @@
 #include "MasterRenderer.h"
 #include "Water\WaterRenderer.h"
 #include "Particles\ParticleMaster.h"
+#include "../Services/Properties.h"
 
 namespace Pressure {
 
-	MasterRenderer::MasterRenderer(Window& window, Loader& loader, Camera& camera)
-		: shader(), renderer(shader, window.getWindow()), skyboxRenderer(loader, window.getWindow()), shadowMapRenderer(camera, window), waterRenderer(window), entities() {
+	MasterRenderer::MasterRenderer(Window& window, Loader& loader, Camera& camera, ThreadPool& threadPool)
+		: instanceBuffer(), renderer(instanceBuffer, window, threadPool, loader.getGeometryArena() != nullptr),
+		skyboxRenderer(loader, window), shadowMapRenderer(camera, window, instanceBuffer, loader.getGeometryArena() != nullptr), waterRenderer(window), impostorRenderer(window, loader), scene(), threadPool(threadPool), mainView(0), reflectionView(0), refractionView(0), mainViewShare(1), occludedCount(0),
+		uniforms(), mainViewUniforms(0), reflectionViewUniforms(0), refractionViewUniforms(0) {
+		obliqueClipping = Properties::get("waterObliqueClipping") == "1";
+		occlusionCulling = Properties::get("occlusionCulling") == "1";
+		geometryShader = Properties::get("entityGeometryShader") == "1";
 		enableCulling();
 	}
 
 	void MasterRenderer::render(std::vector<Light>& lights, Camera& camera) {
 		prepare();
-		shadowMapRenderer.setShadowDistance(25 + camera.getDistanceFromAnchor() * 1.5f);
-		shader.start();
-		shader.connectTextureUnits();
-		glDisable(GL_CLIP_DISTANCE0);
-		shader.loadClipPlane(Vector4f(0, -1, 0, 1000000)); // Bit of a hack, as some drivers do not support disabling clip distance.
-		shader.loadLights(lights);
-		shader.loadToShadowMapSpace(shadowMapRenderer.getToShadowMapSpaceMatrix());
-		shader.loadShadowDistance(shadowMapRenderer.getShadowDistance());
-		renderer.render(entities, camera);
-		shader.stop();
-		skyboxRenderer.render(camera);
+		GLState::disable(GL_CLIP_DISTANCE0);
+		renderer.render(RenderQueue::PASS_MAIN);
+		impostorRenderer.render();
+		skyboxRenderer.render();
 		if (water.size() > 0) {
-			waterRenderer.render(water, lights, camera);
+			waterRenderer.render(water);
 		}
-		ParticleMaster::renderParticles(camera);
-		entities.clear();
 		water.clear();
 	}
 
@@ -35,38 +32,121 @@ namespace Pressure {
 		renderer.tick();
 	}
 
-	void MasterRenderer::renderShadowMap(Light& sun) {
-		shadowMapRenderer.render(entities, sun);
+	void MasterRenderer::cullViews(std::vector<Light>& lights, Camera& camera) {
+		visibility.clear();
+		uniforms.clearViews();
+		Matrix4f viewMatrix = Matrix4f().createViewMatrix(camera.getPosition(), camera.getPitch(), camera.getYaw(), camera.getRoll());
+		Matrix4f projectionView;
+		// The camera and water views come first, so they always fit. Only the shadow views can run out.
+		mainView = visibility.addView(renderer.getProjectionMatrix().mul(viewMatrix, projectionView));
+		// The trees only pay off when they reject most of the scene, the camera tends to see too much of it for that.
+		if (mainViewShare >= SceneVisibility::LINEAR_SCAN_SHARE)
+			visibility.setLinearScan(mainView);
+		const Matrix4f cameraProjectionView = projectionView;
+		// Bit of a hack, as some drivers do not support disabling clip distance.
+		mainViewUniforms = uniforms.addView(renderer.getProjectionMatrix(), viewMatrix, camera.getPosition(), Vector4f(0, -1, 0, 1000000));
+
+		// The water passes only get what ends up on the kept side of their clip plane, roughly half the scene each.
+		// Refraction looks through the main camera, the reflection camera is mirrored the same way renderWaterFrameBuffers() does.
+		if (water.size() > 0) {
+			refractionView = visibility.addView(projectionView);
+			visibility.setClipPlane(refractionView, getRefractionClipPlane());
+			refractionViewUniforms = uniforms.addView(obliqueClipping ? getObliqueProjection(viewMatrix, getRefractionClipPlane()) : renderer.getProjectionMatrix(),
+				viewMatrix, camera.getPosition(), getRefractionClipPlane());
+
+			float distance = 2 * (camera.getPosition().getY() - water[0].getPosition().getY());
+			camera.getPosition().y -= distance;
+			camera.invertPitch();
+			viewMatrix = Matrix4f().createViewMatrix(camera.getPosition(), camera.getPitch(), camera.getYaw(), camera.getRoll());
+			reflectionView = visibility.addView(renderer.getProjectionMatrix().mul(viewMatrix, projectionView));
+			visibility.setClipPlane(reflectionView, getReflectionClipPlane());
+			reflectionViewUniforms = uniforms.addView(obliqueClipping ? getObliqueProjection(viewMatrix, getReflectionClipPlane()) : renderer.getProjectionMatrix(),
+				viewMatrix, camera.getPosition(), getReflectionClipPlane());
+			camera.getPosition().y += distance;
+			camera.invertPitch();
+		}
+
+		if (lights.size() > 0) {
+			shadowMapRenderer.setShadowDistance(25 + camera.getDistanceFromAnchor() * 1.5f);
+			shadowMapRenderer.prepareViews(scene, lights[0], visibility);
+		}
+		uniforms.loadLights(lights);
+		loadShadowUniforms();
+		uniforms.upload();
+		visibility.cull(scene, threadPool);
+		mainViewShare = scene.getEntityCount() > 0 ? (float) visibility.getVisible(mainView).size() / scene.getEntityCount() : 1.f;
+
+		occludedCount = 0;
+		if (occlusionCulling && occlusionCuller.hasOccluders()) {
+			// The refraction is seen through the main camera, so the same occluders hide its entities.
+			occlusionCuller.rasterize(scene, cameraProjectionView, visibility.getVisible(mainView), threadPool);
+			occludedCount = occlusionCuller.cull(scene, visibility.getVisible(mainView), threadPool);
+			if (water.size() > 0)
+				occlusionCuller.cull(scene, visibility.getVisible(refractionView), threadPool);
+		}
+	}
+
+	void MasterRenderer::recordPasses(std::vector<Light>& lights, Camera& camera) {
+		// The entity passes split their queues over the pool themselves, so they are prepared one after the other.
+		const std::vector<SceneEntry>& meshes = impostorRenderer.prepare(scene, visibility.getVisible(mainView), camera.getPosition());
+		renderer.prepare(scene, camera.getPosition(), meshes, getEntityFeatures(lights, false), RenderQueue::PASS_MAIN);
+		if (water.size() > 0) {
+			Vector3f reflectionPosition = camera.getPosition();
+			reflectionPosition.y -= 2 * (camera.getPosition().getY() - water[0].getPosition().getY());
+			renderer.prepare(scene, reflectionPosition, visibility.getVisible(reflectionView), getEntityFeatures(lights, !obliqueClipping), RenderQueue::PASS_REFLECTION);
+			renderer.prepare(scene, camera.getPosition(), visibility.getVisible(refractionView), getEntityFeatures(lights, !obliqueClipping), RenderQueue::PASS_REFRACTION);
+		}
+
+		// Recording does not touch GL, so every entity pass and shadow view gets a job of its own.
+		const unsigned int passCount = water.size() > 0 ? 3 : 1;
+		const unsigned int shadowCount = lights.size() > 0 ? shadowMapRenderer.getRecordCount() : 0;
+		threadPool.parallelFor(passCount + shadowCount, 1, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				if (i == 0)
+					renderer.record(scene, uniforms, mainViewUniforms, RenderQueue::PASS_MAIN);
+				else if (i == 1 && passCount > 1)
+					renderer.record(scene, uniforms, reflectionViewUniforms, RenderQueue::PASS_REFLECTION);
+				else if (i == 2 && passCount > 2)
+					renderer.record(scene, uniforms, refractionViewUniforms, RenderQueue::PASS_REFRACTION);
+				else
+					shadowMapRenderer.record(scene, visibility, i - passCount);
+			}
+		});
 	}
 
-	void MasterRenderer::processEntity(Entity& entity) {
-		TexturedModel& entityModel = entity.getTexturedModel();
-		std::vector<Entity>& batch = entities[entityModel];
-		batch.push_back(entity);
+	void MasterRenderer::renderShadowMap() {
+		shadowMapRenderer.render();
 	}
 
 	void MasterRenderer::processWater(Water& water) {
 		this->water.push_back(water);
 	}
 
+	void MasterRenderer::addImpostor(const TexturedModel& model, const float distance) {
+		impostorRenderer.add(model, distance);
+	}
+
+	void MasterRenderer::addOccluder(const RawModel& model, const std::vector<float>& positions, const std::vector<unsigned int>& indices) {
+		occlusionCuller.addOccluder(model, positions, indices);
+	}
+
 	void MasterRenderer::updateProjectionMatrix() {
-		renderer.updateProjectionMatrix(shader);
+		renderer.updateProjectionMatrix();
 		skyboxRenderer.updateProjectionMatrix();
-		waterRenderer.updateProjectionmatrix();
 	}
 
 	void MasterRenderer::enableCulling() {
-		glEnable(GL_CULL_FACE);
-		glCullFace(GL_BACK);
+		GLState::enable(GL_CULL_FACE);
+		GLState::cullFace(GL_BACK);
 	}
 
 	void MasterRenderer::enableFrontFaceCulling() {
-		glEnable(GL_CULL_FACE);
-		glCullFace(GL_FRONT);
+		GLState::enable(GL_CULL_FACE);
+		GLState::cullFace(GL_FRONT);
 	}
 
 	void MasterRenderer::disableCulling() {
-		glDisable(GL_CULL_FACE);
+		GLState::disable(GL_CULL_FACE);
 	}
 
 	unsigned int MasterRenderer::getShadowMapTexture() {
@@ -77,54 +157,90 @@ namespace Pressure {
 		return renderer;
 	}
 
+	Scene& MasterRenderer::getScene() {
+		return scene;
+	}
+
 	void MasterRenderer::cleanUp() {
-		shader.cleanUp();
+		renderer.cleanUp();
+		instanceBuffer.cleanUp();
+		uniforms.cleanUp();
+		impostorRenderer.cleanUp();
 	}
 
 	void MasterRenderer::prepare() {
-		glEnable(GL_DEPTH_TEST);
-		glEnable(GL_CLIP_DISTANCE0);
-		glEnable(GL_MULTISAMPLE);
+		GLState::enable(GL_DEPTH_TEST);
+		GLState::enable(GL_CLIP_DISTANCE0);
+		GLState::enable(GL_MULTISAMPLE);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, shadowMapRenderer.getShadowMap());
+		GLState::activeTexture(GL_TEXTURE1);
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, shadowMapRenderer.getShadowMap());
+	}
+
+	void MasterRenderer::loadShadowUniforms() {
+		for (unsigned int i = 0; i < shadowMapRenderer.getCascadeCount(); i++) {
+			uniforms.loadShadowCascade(i, shadowMapRenderer.getToShadowMapSpaceMatrix(i), shadowMapRenderer.getCascadeDistance(i));
+		}
+		uniforms.loadShadowParameters(shadowMapRenderer.getCascadeCount(), (float)shadowMapRenderer.getShadowMapSize(), shadowMapRenderer.getShadowDistance());
+	}
+
+	unsigned int MasterRenderer::getEntityFeatures(const std::vector<Light>& lights, const bool clipPlane) const {
+		unsigned int features = EntityShader::getLightCountFeature(lights.size());
+		// The shadow map is only drawn for the sun, the first light.
+		if (lights.size() > 0)
+			features |= EntityShader::FEATURE_SHADOWS;
+		if (clipPlane)
+			features |= EntityShader::FEATURE_CLIP_PLANE;
+		if (geometryShader)
+			features |= EntityShader::FEATURE_GEOMETRY_SHADER;
+		return features;
 	}
 
 	void MasterRenderer::renderWaterFrameBuffers(std::vector<Light>& lights, Camera& camera) {
 		if (water.size() == 0)
 			return;
 
-		// Reflection rendering.
+		// Reflection rendering, the recorded pass binds the mirrored view.
 		waterRenderer.getReflectionBuffer().bind();
-		float distance = 2 * (camera.getPosition().getY() - water[0].getPosition().getY()); // Set up checking for which water is in frame.
-		camera.getPosition().y -= distance;
-		camera.invertPitch();
 		prepare();
-		shader.start();
-		shader.connectTextureUnits();
-		shader.loadClipPlane(Vector4f(0, 1, 0, -water[0].getPosition().getY() + 0.1f)); 
-		shader.loadLights(lights);
-		shader.loadToShadowMapSpace(shadowMapRenderer.getToShadowMapSpaceMatrix());
-		renderer.render(entities, camera);
-		shader.stop();
-		skyboxRenderer.render(camera);
+		if (obliqueClipping)
+			GLState::disable(GL_CLIP_DISTANCE0);
+		renderer.render(RenderQueue::PASS_REFLECTION);
+		skyboxRenderer.render();
 		//ParticleMaster::renderParticles(camera); // Refractionrendering too, clipplane?
-		camera.getPosition().y += distance;
-		camera.invertPitch();
 
 		// Refraction rendering.
 		waterRenderer.getRefractionBuffer().bind();
 		prepare();
-		shader.start();
-		shader.connectTextureUnits();
-		shader.loadClipPlane(Vector4f(0,-1, 0, water[0].getPosition().getY() + 0.2f));
-		shader.loadLights(lights);
-		shader.loadToShadowMapSpace(shadowMapRenderer.getToShadowMapSpaceMatrix());
-		renderer.render(entities, camera);
-		shader.stop();
-		skyboxRenderer.render(camera);
+		if (obliqueClipping)
+			GLState::disable(GL_CLIP_DISTANCE0);
+		renderer.render(RenderQueue::PASS_REFRACTION);
+		skyboxRenderer.render();
 
 		waterRenderer.getRefractionBuffer().unbind();
 	}
 
+	Vector4f MasterRenderer::getReflectionClipPlane() const {
+		return Vector4f(0, 1, 0, -water[0].getPosition().getY() + 0.1f);
+	}
+
+	Vector4f MasterRenderer::getRefractionClipPlane() const {
+		return Vector4f(0, -1, 0, water[0].getPosition().getY() + 0.2f);
+	}
+
+	Matrix4f MasterRenderer::getObliqueProjection(const Matrix4f& viewMatrix, const Vector4f& clipPlane) const {
+		// Planes go to view space with the inverse transpose of the view matrix.
+		Matrix4f inverseView = viewMatrix;
+		inverseView.invert();
+		Vector4f viewPlane;
+		viewPlane.x = inverseView.get(0, 0) * clipPlane.x + inverseView.get(0, 1) * clipPlane.y + inverseView.get(0, 2) * clipPlane.z + inverseView.get(0, 3) * clipPlane.w;
+		viewPlane.y = inverseView.get(1, 0) * clipPlane.x + inverseView.get(1, 1) * clipPlane.y + inverseView.get(1, 2) * clipPlane.z + inverseView.get(1, 3) * clipPlane.w;
+		viewPlane.z = inverseView.get(2, 0) * clipPlane.x + inverseView.get(2, 1) * clipPlane.y + inverseView.get(2, 2) * clipPlane.z + inverseView.get(2, 3) * clipPlane.w;
+		viewPlane.w = inverseView.get(3, 0) * clipPlane.x + inverseView.get(3, 1) * clipPlane.y + inverseView.get(3, 2) * clipPlane.z + inverseView.get(3, 3) * clipPlane.w;
+
+		Matrix4f projection = renderer.getProjectionMatrix();
+		projection.setObliqueNearPlane(viewPlane);
+		return projection;
+	}
+
 }
\ No newline at end of file
@@ -1,46 +1,86 @@
 #pragma once
-#include <unordered_map>
 #include <vector>
 
 #include "EntityShaders\EntityShader.h"
 #include "Models\TexturedModel.h"
 #include "EntityShaders\EntityRenderer.h"
+#include "EntityShaders\EntityInstanceBuffer.h"
 #include "Entities\Entity.h"
 #include "Entities\Light.h"
 #include "Entities\Camera.h"
 #include "Skybox\SkyboxRenderer.h"
 #include "Loader.h"
 #include "Water\WaterRenderer.h"
+#include "Impostors\ImpostorRenderer.h"
 #include "GLObjects\FrameBuffer.h"
 #include "Shadows\ShadowMapMasterRenderer.h"
+#include "Scene\Scene.h"
+#include "Scene\SceneVisibility.h"
+#include "Scene\OcclusionCuller.h"
+#include "Shaders\FrameUniforms.h"
+#include "../Services/ThreadPool.h"
 
 namespace Pressure {
 
 	class MasterRenderer {
 
 	private: 
-		EntityShader shader;
+		EntityInstanceBuffer instanceBuffer;
 		EntityRenderer renderer;
 
 		SkyboxRenderer skyboxRenderer;
 		ShadowMapMasterRenderer shadowMapRenderer;
 		
 		WaterRenderer waterRenderer;
+		ImpostorRenderer impostorRenderer;
 
-		std::unordered_map<TexturedModel, std::vector<Entity>> entities;
+		Scene scene;
 		std::vector<Water> water;
 
+		ThreadPool& threadPool;
+		// Visible entities of every view of the frame, filled by cullViews().
+		SceneVisibility visibility;
+		unsigned int mainView;
+		unsigned int reflectionView;
+		unsigned int refractionView;
+		// Share of the scene the camera saw last frame, picks how the main view is culled.
+		float mainViewShare;
+		// Removes what the occluders hide from the main and refraction views after the frustum culling.
+		OcclusionCuller occlusionCuller;
+		bool occlusionCulling;
+		// Entities the occluders hid from the main view, the refraction is not counted again.
+		unsigned int occludedCount;
+		// Lights, shadow cascades and the camera of every pass, uploaded by cullViews().
+		FrameUniforms uniforms;
+		unsigned int mainViewUniforms;
+		unsigned int reflectionViewUniforms;
+		unsigned int refractionViewUniforms;
+		// Clip the water passes through the near plane of the projection instead of a clip distance.
+		bool obliqueClipping;
+		// Average the texture coordinates and normals of each face in a geometry shader, instead of taking those of its last vertex.
+		// On by default, as averaging without the geometry stage would need every face to get vertices of its own.
+		bool geometryShader;
+
 	public:
-		MasterRenderer(Window& window, Loader& loader, Camera& camera);
+		MasterRenderer(Window& window, Loader& loader, Camera& camera, ThreadPool& threadPool);
 		void render(std::vector<Light>& lights, Camera& camera);
 		void tick();
 		
+		// IMPORTANT! Has to be called after the scene is flushed and before any of the render functions.
+		// Culls the scene for the camera, the reflection camera and the shadow cascades in one go.
+		void cullViews(std::vector<Light>& lights, Camera& camera);
+		// IMPORTANT! Has to be called after cullViews() and before any of the render functions.
+		// Records the entity passes and the shadow views at the same time on the thread pool, the render functions replay them.
+		void recordPasses(std::vector<Light>& lights, Camera& camera);
 		// IMPORTANT! Has to be called before render();
-		void renderShadowMap(Light& sun);
+		void renderShadowMap();
 		void renderWaterFrameBuffers(std::vector<Light>& lights, Camera& camera);
 
-		void processEntity(Entity& entity);
 		void processWater(Water& water);
+		// Draws the entities of the model as billboards from distance on in the main view.
+		void addImpostor(const TexturedModel& model, const float distance);
+		// Entities using the model hide what is behind them from the camera. Takes the positions and indices of the mesh.
+		void addOccluder(const RawModel& model, const std::vector<float>& positions, const std::vector<unsigned int>& indices);
 		void updateProjectionMatrix();
 
 		static void enableCulling();
@@ -51,10 +91,23 @@ namespace Pressure {
 		unsigned int getShadowMapTexture();
 
 		EntityRenderer& getRenderer();
+		inline const OcclusionCuller::Statistics& getOcclusionStatistics() const { return occlusionCuller.getStatistics(); }
+		inline unsigned int getOccludedCount() const { return occludedCount; }
+		inline const ShadowMapEntityRenderer::Statistics& getShadowStatistics() const { return shadowMapRenderer.getStatistics(); }
+		Scene& getScene();
 		void cleanUp();
 
 	private:
 		void prepare();
+		// Cascade matrices and distances of the shadow views.
+		void loadShadowUniforms();
+		// EntityShader features of a pass, the models add their own.
+		unsigned int getEntityFeatures(const std::vector<Light>& lights, const bool clipPlane) const;
+		// World space planes of the water passes, keeping what is above the water for the reflection and below it for the refraction.
+		Vector4f getReflectionClipPlane() const;
+		Vector4f getRefractionClipPlane() const;
+		// The projection with its near plane replaced by the clip plane.
+		Matrix4f getObliqueProjection(const Matrix4f& viewMatrix, const Vector4f& clipPlane) const;
 
 	};
 
@@ -0,0 +1,100 @@
+#include "GeometryArena.h"
+
+namespace Pressure {
+
+	const unsigned int GeometryArena::INITIAL_VERTICES = 1 << 16;
+	const unsigned int GeometryArena::INITIAL_INDICES = 3 << 16;
+	const unsigned int GeometryArena::MAX_MESH_VERTICES = 1 << 16;
+
+	GeometryArena::GeometryArena(const VertexFormat& format)
+		: m_Format(format), m_VertexCapacity(INITIAL_VERTICES), m_VertexCount(0), m_IndexCapacity(INITIAL_INDICES), m_IndexCount(0), m_MeshCount(0) {
+		// Uploads go through the copy targets, binding the element array buffer would change whatever vertex array is bound.
+		m_VertexBuffer = resize(0, 0, m_VertexCapacity * m_Format.getStride());
+		m_IndexBuffer = resize(0, 0, m_IndexCapacity * sizeof(unsigned short));
+		bindBuffers();
+	}
+
+	bool GeometryArena::accepts(const VertexFormat& format, const unsigned int vertexCount) const {
+		return format == m_Format && vertexCount <= MAX_MESH_VERTICES;
+	}
+
+	ArenaMesh GeometryArena::add(const std::vector<float>& positions, const std::vector<float>& textureCoords, const std::vector<float>& normals, const std::vector<unsigned int>& indices) {
+		const unsigned int vertexCount = positions.size() / 3;
+		reserve(m_VertexCount + vertexCount, m_IndexCount + indices.size());
+
+		m_VertexScratch.clear();
+		m_Format.pack(positions, textureCoords, normals, vertexCount, m_VertexScratch);
+		upload(m_VertexBuffer, m_VertexCount * m_Format.getStride(), m_VertexScratch.size(), m_VertexScratch.data());
+		// Indices stay relative to the mesh, baseVertex offsets them into the shared stream.
+		m_IndexScratch.assign(indices.begin(), indices.end());
+		upload(m_IndexBuffer, m_IndexCount * sizeof(unsigned short), m_IndexScratch.size() * sizeof(unsigned short), m_IndexScratch.data());
+
+		ArenaMesh mesh = { m_MeshCount++, m_IndexCount, (unsigned int)indices.size(), (int)m_VertexCount, GL_UNSIGNED_SHORT };
+		m_VertexCount += vertexCount;
+		m_IndexCount += indices.size();
+		return mesh;
+	}
+
+	void GeometryArena::cleanUp() {
+		m_VertexArray.del();
+		glDeleteBuffers(1, &m_VertexBuffer);
+		glDeleteBuffers(1, &m_IndexBuffer);
+	}
+
+	bool GeometryArena::isSupported() {
+		return GLAD_GL_VERSION_4_3 != 0;
+	}
+
+	void GeometryArena::reserve(const unsigned int vertexCount, const unsigned int indexCount) {
+		if (vertexCount > m_VertexCapacity) {
+			unsigned int capacity = m_VertexCapacity;
+			while (capacity < vertexCount)
+				capacity *= 2;
+			m_VertexBuffer = resize(m_VertexBuffer, m_VertexCount * m_Format.getStride(), capacity * m_Format.getStride());
+			m_VertexCapacity = capacity;
+		}
+		if (indexCount > m_IndexCapacity) {
+			unsigned int capacity = m_IndexCapacity;
+			while (capacity < indexCount)
+				capacity *= 2;
+			m_IndexBuffer = resize(m_IndexBuffer, m_IndexCount * sizeof(unsigned short), capacity * sizeof(unsigned short));
+			m_IndexCapacity = capacity;
+		}
+		bindBuffers();
+	}
+
+	unsigned int GeometryArena::resize(const unsigned int buffer, const unsigned int oldSize, const unsigned int newSize) {
+		unsigned int resized;
+		glGenBuffers(1, &resized);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, resized);
+		glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+		if (buffer != 0) {
+			glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			glDeleteBuffers(1, &buffer);
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return resized;
+	}
+
+	void GeometryArena::upload(const unsigned int buffer, const unsigned int offset, const unsigned int size, const void* data) {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	void GeometryArena::bindBuffers() {
+		m_VertexArray.bind();
+		glBindBuffer(GL_ARRAY_BUFFER, m_VertexBuffer);
+		for (unsigned int i = 0; i < VertexFormat::ATTRIBUTE_COUNT; i++) {
+			const VertexFormat::Attribute& attribute = m_Format.getAttribute(i);
+			glVertexAttribPointer(i, attribute.count, attribute.type, attribute.normalized, m_Format.getStride(), (const void*)attribute.offset);
+			glEnableVertexAttribArray(i);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexBuffer);
+		m_VertexArray.unbind();
+	}
+
+}
\ No newline at end of file
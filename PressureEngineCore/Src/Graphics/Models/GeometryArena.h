@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include "../GLObjects/GLObjects.h"
+
+namespace Pressure {
+
+	// Location of a mesh in a GeometryArena.
+	struct ArenaMesh {
+		unsigned int id;
+		unsigned int firstIndex;
+		unsigned int indexCount;
+		int baseVertex;
+		unsigned int indexType;
+	};
+
+	// Shared vertex and index storage for the static meshes, all drawn through one vertex array, so a pass
+	// can be submitted with a few glMultiDrawElementsIndirect calls instead of binding every model.
+	// Every mesh uses the arena's vertex format and 16-bit indices relative to its base vertex.
+	class GeometryArena {
+
+	private:
+		const static unsigned int INITIAL_VERTICES;
+		const static unsigned int INITIAL_INDICES;
+
+		VertexFormat m_Format;
+		VertexArray m_VertexArray;
+		unsigned int m_VertexBuffer;
+		unsigned int m_IndexBuffer;
+
+		unsigned int m_VertexCapacity;
+		unsigned int m_VertexCount;
+		unsigned int m_IndexCapacity;
+		unsigned int m_IndexCount;
+		unsigned int m_MeshCount;
+
+		std::vector<unsigned char> m_VertexScratch;
+		std::vector<unsigned short> m_IndexScratch;
+
+	public:
+		const static unsigned int MAX_MESH_VERTICES;
+
+		GeometryArena(const VertexFormat& format);
+
+		// Whether a mesh packed with the format fits into the arena.
+		bool accepts(const VertexFormat& format, const unsigned int vertexCount) const;
+		ArenaMesh add(const std::vector<float>& positions, const std::vector<float>& textureCoords, const std::vector<float>& normals, const std::vector<unsigned int>& indices);
+		void cleanUp();
+
+		inline const VertexArray& getVertexArray() const { return m_VertexArray; }
+
+		// Multi-draw indirect with base instances needs OpenGL 4.3.
+		static bool isSupported();
+
+	private:
+		// Grows the buffers by doubling until the given counts fit.
+		void reserve(const unsigned int vertexCount, const unsigned int indexCount);
+		// Returns a new buffer of newSize bytes holding the first oldSize bytes of buffer, which is deleted.
+		static unsigned int resize(const unsigned int buffer, const unsigned int oldSize, const unsigned int newSize);
+		static void upload(const unsigned int buffer, const unsigned int offset, const unsigned int size, const void* data);
+		void bindBuffers();
+
+	};
+
+}
\ No newline at end of file
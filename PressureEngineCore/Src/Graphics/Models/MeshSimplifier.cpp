@@ -0,0 +1,251 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+namespace Pressure {
+
+	const double MeshSimplifier::BOUNDARY_WEIGHT = 10.0;
+	const unsigned int MeshSimplifier::NO_COPY = ~0u;
+
+	void MeshSimplifier::simplify(const std::vector<float>& positions, const std::vector<float>& textureCoords, const std::vector<float>& normals,
+		std::vector<unsigned int>& indices, const unsigned int targetIndexCount) {
+		const unsigned int vertexCount = positions.size() / 3;
+
+		// Vertices sharing a position form a group named after its first vertex, the other copies are linked through nextCopy.
+		std::vector<unsigned int> order(vertexCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](const unsigned int a, const unsigned int b) {
+			return std::lexicographical_compare(&positions[a * 3], &positions[a * 3] + 3, &positions[b * 3], &positions[b * 3] + 3);
+		});
+		std::vector<unsigned int> groups(vertexCount);
+		std::vector<unsigned int> nextCopy(vertexCount, NO_COPY);
+		for (unsigned int i = 0; i < vertexCount; i++) {
+			const unsigned int vertex = order[i];
+			if (i > 0 && std::equal(&positions[vertex * 3], &positions[vertex * 3] + 3, &positions[order[i - 1] * 3])) {
+				groups[vertex] = groups[order[i - 1]];
+				nextCopy[order[i - 1]] = vertex;
+			} else {
+				groups[vertex] = vertex;
+			}
+		}
+
+		// Edges are keyed by their groups, smaller one first. An edge used by a single triangle is on the outline.
+		std::vector<uint64_t> edges;
+		auto makeEdge = [](const unsigned int a, const unsigned int b) {
+			return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+		};
+		for (unsigned int i = 0; i < indices.size(); i += 3) {
+			for (unsigned int k = 0; k < 3; k++)
+				edges.push_back(makeEdge(groups[indices[i + k]], groups[indices[i + (k + 1) % 3]]));
+		}
+		std::sort(edges.begin(), edges.end());
+
+		std::vector<Quadric> quadrics(vertexCount, Quadric());
+		for (unsigned int i = 0; i < indices.size(); i += 3) {
+			double normal[3];
+			const double area = computeNormal(&positions[indices[i] * 3], &positions[indices[i + 1] * 3], &positions[indices[i + 2] * 3], normal) / 2;
+			if (area == 0)
+				continue;
+
+			for (unsigned int k = 0; k < 3; k++) {
+				const float* a = &positions[indices[i + k] * 3];
+				const float* b = &positions[indices[i + (k + 1) % 3] * 3];
+				const double point[3] = { a[0], a[1], a[2] };
+				Quadric plane = makePlane(normal, point, area);
+				add(quadrics[groups[indices[i + k]]], plane);
+
+				uint64_t edge = makeEdge(groups[indices[i + k]], groups[indices[i + (k + 1) % 3]]);
+				if (std::upper_bound(edges.begin(), edges.end(), edge) - std::lower_bound(edges.begin(), edges.end(), edge) != 1)
+					continue;
+				const double direction[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+				double side[3] = {
+					direction[1] * normal[2] - direction[2] * normal[1],
+					direction[2] * normal[0] - direction[0] * normal[2],
+					direction[0] * normal[1] - direction[1] * normal[0]
+				};
+				const double length = std::sqrt(side[0] * side[0] + side[1] * side[1] + side[2] * side[2]);
+				if (length == 0)
+					continue;
+				for (unsigned int j = 0; j < 3; j++)
+					side[j] /= length;
+				const Quadric boundary = makePlane(side, point, BOUNDARY_WEIGHT * length * length);
+				add(quadrics[groups[indices[i + k]]], boundary);
+				add(quadrics[groups[indices[i + (k + 1) % 3]]], boundary);
+			}
+		}
+
+		// Each pass collapses the cheapest edges whose surroundings no earlier collapse of the pass touched,
+		// then rewrites the indices. Positions never move, so the costs of the pass stay exact.
+		const unsigned int targetTriangles = targetIndexCount / 3;
+		std::vector<unsigned int> offsets(vertexCount + 1);
+		std::vector<unsigned int> cursors(vertexCount);
+		std::vector<unsigned int> triangles;
+		std::vector<unsigned int> collapseTo(vertexCount);
+		std::vector<bool> locked(vertexCount);
+		std::vector<Collapse> collapses;
+		while (indices.size() / 3 > targetTriangles) {
+			// Triangles around every group.
+			std::fill(offsets.begin(), offsets.end(), 0);
+			for (unsigned int index : indices)
+				offsets[groups[index] + 1]++;
+			for (unsigned int i = 0; i < vertexCount; i++)
+				offsets[i + 1] += offsets[i];
+			std::copy(offsets.begin(), offsets.end() - 1, cursors.begin());
+			triangles.resize(indices.size());
+			for (unsigned int i = 0; i < indices.size(); i++)
+				triangles[cursors[groups[indices[i]]]++] = i / 3;
+
+			edges.clear();
+			for (unsigned int i = 0; i < indices.size(); i += 3) {
+				for (unsigned int k = 0; k < 3; k++)
+					edges.push_back(makeEdge(groups[indices[i + k]], groups[indices[i + (k + 1) % 3]]));
+			}
+			std::sort(edges.begin(), edges.end());
+			edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+			// An edge collapses onto whichever end point costs less.
+			collapses.clear();
+			for (uint64_t edge : edges) {
+				const unsigned int a = (unsigned int)(edge >> 32);
+				const unsigned int b = (unsigned int)edge;
+				if (a == b)
+					continue;
+				Quadric q = quadrics[a];
+				add(q, quadrics[b]);
+				const double toA = evaluate(q, &positions[a * 3]);
+				const double toB = evaluate(q, &positions[b * 3]);
+				collapses.push_back(toB <= toA ? Collapse{ a, b, toB } : Collapse{ b, a, toA });
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+			std::iota(collapseTo.begin(), collapseTo.end(), 0);
+			std::fill(locked.begin(), locked.end(), false);
+			const unsigned int excess = indices.size() / 3 - targetTriangles;
+			unsigned int removed = 0;
+			for (const Collapse& collapse : collapses) {
+				if (removed >= excess)
+					break;
+				if (locked[collapse.from] || locked[collapse.to])
+					continue;
+				const unsigned int* around = &triangles[offsets[collapse.from]];
+				const unsigned int aroundCount = offsets[collapse.from + 1] - offsets[collapse.from];
+				if (flips(positions, indices, groups, around, aroundCount, collapse.from, collapse.to))
+					continue;
+
+				collapseTo[collapse.from] = collapse.to;
+				add(quadrics[collapse.to], quadrics[collapse.from]);
+				for (unsigned int i = 0; i < aroundCount; i++) {
+					bool degenerate = false;
+					for (unsigned int k = 0; k < 3; k++) {
+						const unsigned int group = groups[indices[around[i] * 3 + k]];
+						locked[group] = true;
+						degenerate |= group == collapse.to;
+					}
+					if (degenerate)
+						removed++;
+				}
+			}
+			if (removed == 0)
+				break;
+
+			// Moves the corners of the collapsed groups and drops the triangles that lost an edge.
+			unsigned int write = 0;
+			for (unsigned int i = 0; i < indices.size(); i += 3) {
+				unsigned int corners[3];
+				for (unsigned int k = 0; k < 3; k++) {
+					const unsigned int vertex = indices[i + k];
+					const unsigned int group = groups[vertex];
+					corners[k] = collapseTo[group] == group ? vertex : findClosestCopy(textureCoords, normals, nextCopy, vertex, collapseTo[group]);
+				}
+				if (groups[corners[0]] == groups[corners[1]] || groups[corners[1]] == groups[corners[2]] || groups[corners[2]] == groups[corners[0]])
+					continue;
+				indices[write++] = corners[0];
+				indices[write++] = corners[1];
+				indices[write++] = corners[2];
+			}
+			indices.resize(write);
+		}
+	}
+
+	MeshSimplifier::Quadric MeshSimplifier::makePlane(const double* normal, const double* point, const double weight) {
+		const double a = normal[0], b = normal[1], c = normal[2];
+		const double d = -(a * point[0] + b * point[1] + c * point[2]);
+		return { a * a * weight, a * b * weight, a * c * weight, a * d * weight, b * b * weight, b * c * weight, b * d * weight,
+			c * c * weight, c * d * weight, d * d * weight };
+	}
+
+	void MeshSimplifier::add(Quadric& q, const Quadric& other) {
+		q.a2 += other.a2; q.ab += other.ab; q.ac += other.ac; q.ad += other.ad;
+		q.b2 += other.b2; q.bc += other.bc; q.bd += other.bd;
+		q.c2 += other.c2; q.cd += other.cd;
+		q.d2 += other.d2;
+	}
+
+	double MeshSimplifier::evaluate(const Quadric& q, const float* point) {
+		const double x = point[0], y = point[1], z = point[2];
+		return q.a2 * x * x + 2 * q.ab * x * y + 2 * q.ac * x * z + 2 * q.ad * x
+			+ q.b2 * y * y + 2 * q.bc * y * z + 2 * q.bd * y
+			+ q.c2 * z * z + 2 * q.cd * z + q.d2;
+	}
+
+	double MeshSimplifier::computeNormal(const float* a, const float* b, const float* c, double* normal) {
+		const double e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		const double e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+		const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length > 0) {
+			for (unsigned int i = 0; i < 3; i++)
+				normal[i] /= length;
+		}
+		return length;
+	}
+
+	bool MeshSimplifier::flips(const std::vector<float>& positions, const std::vector<unsigned int>& indices, const std::vector<unsigned int>& groups,
+		const unsigned int* triangles, const unsigned int triangleCount, const unsigned int from, const unsigned int to) {
+		for (unsigned int i = 0; i < triangleCount; i++) {
+			const unsigned int* corners = &indices[triangles[i] * 3];
+			const float* moved[3];
+			bool removed = false;
+			for (unsigned int k = 0; k < 3; k++) {
+				const unsigned int group = groups[corners[k]];
+				removed |= group == to;
+				moved[k] = &positions[(group == from ? to : corners[k]) * 3];
+			}
+			// Triangles on the collapsed edge disappear.
+			if (removed)
+				continue;
+
+			double before[3], after[3];
+			computeNormal(&positions[corners[0] * 3], &positions[corners[1] * 3], &positions[corners[2] * 3], before);
+			if (computeNormal(moved[0], moved[1], moved[2], after) == 0 || before[0] * after[0] + before[1] * after[1] + before[2] * after[2] < 0)
+				return true;
+		}
+		return false;
+	}
+
+	unsigned int MeshSimplifier::findClosestCopy(const std::vector<float>& textureCoords, const std::vector<float>& normals,
+		const std::vector<unsigned int>& nextCopy, const unsigned int vertex, const unsigned int group) {
+		const bool hasTextureCoords = textureCoords.size() >= nextCopy.size() * 2;
+		const bool hasNormals = normals.size() >= nextCopy.size() * 3;
+		unsigned int closest = group;
+		double closestDistance = std::numeric_limits<double>::max();
+		for (unsigned int copy = group; copy != NO_COPY; copy = nextCopy[copy]) {
+			double distance = 0;
+			for (unsigned int i = 0; hasTextureCoords && i < 2; i++)
+				distance += (textureCoords[copy * 2 + i] - textureCoords[vertex * 2 + i]) * (textureCoords[copy * 2 + i] - textureCoords[vertex * 2 + i]);
+			for (unsigned int i = 0; hasNormals && i < 3; i++)
+				distance += (normals[copy * 3 + i] - normals[vertex * 3 + i]) * (normals[copy * 3 + i] - normals[vertex * 3 + i]);
+			if (distance < closestDistance) {
+				closest = copy;
+				closestDistance = distance;
+			}
+		}
+		return closest;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+
+namespace Pressure {
+
+	// Quadric error simplification (Garland and Heckbert) for generating the levels of detail of a mesh.
+	// Edges are collapsed onto one of their end points, so the simplified indices reference the original
+	// vertices and every level can share the vertex buffer of the full detail mesh.
+	class MeshSimplifier {
+
+	private:
+		// Error quadric of the planes around a vertex, the symmetric 4x4 matrix stored as its upper triangle.
+		struct Quadric {
+			double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+		};
+
+		struct Collapse {
+			unsigned int from;
+			unsigned int to;
+			double error;
+		};
+
+		// Open edges get planes perpendicular to their triangle, this much stronger than the surface, to keep the outline.
+		const static double BOUNDARY_WEIGHT;
+		// Ends the list of vertices sharing a position.
+		const static unsigned int NO_COPY;
+
+		MeshSimplifier() = delete;
+
+	public:
+		// Collapses edges of the cheapest error first until indices holds at most targetIndexCount indices or nothing can be collapsed.
+		// Vertices sharing a position are collapsed together, corners moved onto another position take the copy there with the closest attributes.
+		static void simplify(const std::vector<float>& positions, const std::vector<float>& textureCoords, const std::vector<float>& normals,
+			std::vector<unsigned int>& indices, const unsigned int targetIndexCount);
+
+	private:
+		static Quadric makePlane(const double* normal, const double* point, const double weight);
+		static void add(Quadric& q, const Quadric& other);
+		static double evaluate(const Quadric& q, const float* point);
+		// Writes the unit normal of the triangle, returns twice its area.
+		static double computeNormal(const float* a, const float* b, const float* c, double* normal);
+		// Whether moving from onto to turns any of the triangles around from over.
+		static bool flips(const std::vector<float>& positions, const std::vector<unsigned int>& indices, const std::vector<unsigned int>& groups,
+			const unsigned int* triangles, const unsigned int triangleCount, const unsigned int from, const unsigned int to);
+		// Copy of the vertex at the position of group whose texture coordinates and normal are closest to vertex.
+		static unsigned int findClosestCopy(const std::vector<float>& textureCoords, const std::vector<float>& normals,
+			const std::vector<unsigned int>& nextCopy, const unsigned int vertex, const unsigned int group);
+
+	};
+
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "RawModel.h"
+#include "../../Log.h"
 
 namespace Pressure {
 
@@ -10,6 +11,13 @@ namespace Pressure {
 		return m_VertexCount;
 	}
 
+	void RawModel::addLod(const unsigned int firstIndex, const unsigned int indexCount) {
+		PRESSURE_ASSERT(m_LodCount < MAX_LODS, "Too many levels of detail!");
+		m_LodFirstIndex[m_LodCount] = firstIndex;
+		m_LodIndexCount[m_LodCount] = indexCount;
+		m_LodCount++;
+	}
+
 	AABB RawModel::getBounds() const {
 		return m_Bounds;
 	}
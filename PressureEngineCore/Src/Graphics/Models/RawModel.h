@@ -2,24 +2,59 @@
 #include "../../DllExport.h"
 #include "../GLObjects/GLObjects.h"
 #include "../../Math/Geometry/AABB.h"
+#include "GeometryArena.h"
 
 namespace Pressure {
 
 	class PRESSURE_API RawModel {
 
+	public:
+		// Full detail and up to three simplified levels.
+		const static unsigned int MAX_LODS = 4;
+
 	private:
 		VertexArray m_VertexArray;
 		unsigned int m_VertexCount;
+		// Where the indices start in a shared vertex array, 0 for models with their own.
+		unsigned int m_FirstIndex;
+		int m_BaseVertex;
+		unsigned int m_MeshID;
+		unsigned int m_IndexType;
+		// Index ranges of the levels of detail, all sharing the vertices of the full detail mesh at level 0.
+		unsigned int m_LodFirstIndex[MAX_LODS];
+		unsigned int m_LodIndexCount[MAX_LODS];
+		unsigned int m_LodCount;
 
 		AABB m_Bounds;
 		bool m_WindAffected;
 
 	public:
-		RawModel(const VertexArray& va, const unsigned int vertexCount, const AABB& bounds)
-			: m_VertexArray(va), m_VertexCount(vertexCount), m_Bounds(bounds), m_WindAffected(false) {}
+		RawModel(const VertexArray& va, const unsigned int vertexCount, const AABB& bounds, const unsigned int indexType = GL_UNSIGNED_INT)
+			: m_VertexArray(va), m_VertexCount(vertexCount), m_FirstIndex(0), m_BaseVertex(0), m_MeshID(va.getID()), m_IndexType(indexType), m_LodCount(1), m_Bounds(bounds), m_WindAffected(false) {
+			m_LodFirstIndex[0] = m_FirstIndex;
+			m_LodIndexCount[0] = m_VertexCount;
+		}
+		RawModel(const VertexArray& va, const ArenaMesh& mesh, const AABB& bounds)
+			: m_VertexArray(va), m_VertexCount(mesh.indexCount), m_FirstIndex(mesh.firstIndex), m_BaseVertex(mesh.baseVertex), m_MeshID(mesh.id), m_IndexType(mesh.indexType), m_LodCount(1), m_Bounds(bounds), m_WindAffected(false) {
+			m_LodFirstIndex[0] = m_FirstIndex;
+			m_LodIndexCount[0] = m_VertexCount;
+		}
 						
 		VertexArray& getVertexArray() const;
 		unsigned int getVertexCount() const;
+		inline unsigned int getFirstIndex() const { return m_FirstIndex; }
+		inline int getBaseVertex() const { return m_BaseVertex; }
+		// Tells meshes apart in the sort keys, including the ones sharing the vertex array of a GeometryArena.
+		inline unsigned int getMeshID() const { return m_MeshID; }
+		// GL_UNSIGNED_SHORT for meshes with up to 65536 vertices, GL_UNSIGNED_INT otherwise.
+		inline unsigned int getIndexType() const { return m_IndexType; }
+		inline unsigned int getIndexSize() const { return m_IndexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int); }
+
+		// Appends a coarser level drawn from the given range of the model's index buffer.
+		void addLod(const unsigned int firstIndex, const unsigned int indexCount);
+		inline unsigned int getLodCount() const { return m_LodCount; }
+		inline unsigned int getLodFirstIndex(const unsigned int lod) const { return m_LodFirstIndex[lod]; }
+		inline unsigned int getLodIndexCount(const unsigned int lod) const { return m_LodIndexCount[lod]; }
 
 		AABB getBounds() const;
 
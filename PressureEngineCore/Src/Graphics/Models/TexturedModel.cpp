@@ -0,0 +1,13 @@
+#include "TexturedModel.h"
+#include "../../Log.h"
+
+namespace Pressure {
+
+	void TexturedModel::setLodScreenSize(const unsigned int lod, const float screenSize) {
+		PRESSURE_ASSERT(lod >= 1 && lod < RawModel::MAX_LODS, "Level of detail has no screen size threshold!");
+		if (lod < 1 || lod >= RawModel::MAX_LODS)
+			return;
+		m_LodScreenSizes[lod - 1] = screenSize;
+	}
+
+}
\ No newline at end of file
@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+
 #include "../Models/RawModel.h"
 #include "../Textures/ModelTexture.h"
 #include "../../DllExport.h"
@@ -10,16 +12,34 @@ namespace Pressure {
 	private:
 		RawModel m_RawModel;
 		ModelTexture m_Texture;
+		// Share of the screen height below which each simplified level is used, starting with level 1.
+		float m_LodScreenSizes[RawModel::MAX_LODS - 1];
 
 	public:
 		TexturedModel(RawModel model, ModelTexture texture)
-			: m_RawModel(model), m_Texture(texture) { }
+			: m_RawModel(model), m_Texture(texture), m_LodScreenSizes{ 0.25f, 0.1f, 0.04f } { }
+
+		inline const RawModel& getRawModel() const { return m_RawModel; }
+		inline const ModelTexture& getTexture() const { return m_Texture; }
 
-		inline RawModel getRawModel() const { return m_RawModel; }
-		inline ModelTexture getTexture() const { return m_Texture; }
+		// Level has to be between 1 and RawModel::MAX_LODS - 1. Copies with other thresholds are batched on their own.
+		void setLodScreenSize(const unsigned int lod, const float screenSize);
+		// Level for bounds spanning screenSize of the screen height, limited to the levels the model has.
+		inline unsigned int selectLod(const float screenSize) const {
+			unsigned int lod = 0;
+			while (lod + 1 < m_RawModel.getLodCount() && screenSize < m_LodScreenSizes[lod])
+				lod++;
+			return lod;
+		}
+
+		// Same mesh and texture, so the model looks the same whatever its thresholds are.
+		inline bool sharesMeshAndTexture(const TexturedModel& other) const {
+			return m_RawModel.getVertexArray().getID() == other.m_RawModel.getVertexArray().getID() && m_RawModel.getFirstIndex() == other.m_RawModel.getFirstIndex()
+				&& m_Texture.getID() == other.m_Texture.getID();
+		}
 
 		inline bool operator==(const TexturedModel& other) const {
-			return m_RawModel.getVertexArray().getID() == other.m_RawModel.getVertexArray().getID() && m_Texture.getID() == m_Texture.getID();
+			return sharesMeshAndTexture(other) && std::equal(std::begin(m_LodScreenSizes), std::end(m_LodScreenSizes), std::begin(other.m_LodScreenSizes));
 		}
 
 	};
@@ -27,6 +47,7 @@ namespace Pressure {
 }
 
 // Needed for comparisons when used as key in std::unordered_map.
+// Leaves out the thresholds, so it also fits maps comparing with TexturedModel::sharesMeshAndTexture().
 namespace std {
 
 	template <>
@@ -34,6 +55,7 @@ namespace std {
 		size_t operator()(const Pressure::TexturedModel& m) const {
 			size_t res = 17;
 			res = res * 31 + hash<unsigned int>()(m.getRawModel().getVertexArray().getID());
+			res = res * 31 + hash<unsigned int>()(m.getRawModel().getFirstIndex());
 			res = res * 31 + hash<unsigned int>()(m.getTexture().getID());
 			return res;
 		}
@@ -7,7 +7,7 @@ using namespace std;
 
 namespace Pressure {
 
-	RawModel OBJLoader::load(const char* fileName, Loader& loader) {
+	RawModel OBJLoader::load(const char* fileName, Loader& loader, std::vector<float>* positionsCopy, std::vector<unsigned int>* indicesCopy) {
 
 		ifstream file("Res/" + string(fileName) + ".obj");
 
@@ -72,6 +72,10 @@ namespace Pressure {
 			}
 		}
 
+		if (positionsCopy)
+			*positionsCopy = vertices;
+		if (indicesCopy)
+			*indicesCopy = indices;
 		return loader.loadToVao(vertices, textureArray, normalsArray, indices);
 
 	}
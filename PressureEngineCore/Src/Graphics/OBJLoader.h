@@ -14,7 +14,8 @@ namespace Pressure {
 		OBJLoader() = delete;
 
 	public:
-		static RawModel load(const char* fileName, Loader& loader);
+		// Also copies the positions and indices out when they are given, for CPU side uses like occlusion culling.
+		static RawModel load(const char* fileName, Loader& loader, std::vector<float>* positionsCopy = nullptr, std::vector<unsigned int>* indicesCopy = nullptr);
 
 	private:
 		static void processFaces(std::string& data, unsigned int lineStart, std::vector<unsigned int>& indices, std::vector<Vector2f>& uvs,
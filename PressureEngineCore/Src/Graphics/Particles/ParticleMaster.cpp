@@ -5,8 +5,8 @@ namespace Pressure {
 	std::map<ParticleTexture, std::list<Particle>> ParticleMaster::s_Particles;
 	std::unique_ptr<ParticleRenderer> ParticleMaster::s_Renderer = nullptr;
 
-	void ParticleMaster::init(Loader& loader, GLFWwindow* window) {
-		s_Renderer = std::make_unique<ParticleRenderer>(loader, Matrix4f().createProjectionMatrix(window));
+	void ParticleMaster::init(Loader& loader, const Window& window, ThreadPool& threadPool) {
+		s_Renderer = std::make_unique<ParticleRenderer>(loader, Matrix4f().createProjectionMatrix(window.getWidth(), window.getHeight()), threadPool);
 	}
 
 	void ParticleMaster::tick(Camera& camera) {
@@ -39,6 +39,10 @@ namespace Pressure {
 		s_Renderer.get()->render(s_Particles, camera);
 	}
 
+	void ParticleMaster::renderParticles(std::map<ParticleTexture, std::list<Particle>>& particles, Camera& camera) {
+		s_Renderer.get()->render(particles, camera);
+	}
+
 	void ParticleMaster::cleanUp() {
 		s_Renderer.get()->cleanUp();
 	}
@@ -52,7 +56,7 @@ namespace Pressure {
 			it->second.emplace_front(particle);
 	}
 
-	void ParticleMaster::updateProjectionMatrix(Window& window) {
+	void ParticleMaster::updateProjectionMatrix(const Window& window) {
 		s_Renderer->updateProjectionMatrix(window);
 	}
 
@@ -15,15 +15,18 @@ namespace Pressure {
 		static std::unique_ptr<ParticleRenderer> s_Renderer;
 
 	public:
-		static void init(Loader& loader, GLFWwindow* window);
+		static void init(Loader& loader, const Window& window, ThreadPool& threadPool);
 		static void tick(Camera& camera);
 
 		static void renderParticles(Camera& camera);
+		// Draws a copy of the particles, made for a frame drawn on another thread.
+		static void renderParticles(std::map<ParticleTexture, std::list<Particle>>& particles, Camera& camera);
+		inline static const std::map<ParticleTexture, std::list<Particle>>& getParticles() { return s_Particles; }
 		static void cleanUp();
 
 		static void addParticle(Particle& particle);
 
-		static void updateProjectionMatrix(Window& window);
+		static void updateProjectionMatrix(const Window& window);
 
 	private:
 		ParticleMaster() = delete;
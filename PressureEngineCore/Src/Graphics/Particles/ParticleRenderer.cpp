@@ -6,11 +6,12 @@ namespace Pressure {
 	const std::vector<float> ParticleRenderer::VERTICES = { -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f, -0.5f };
 	const int ParticleRenderer::MAX_INSTANCES = 10000;
 	const int ParticleRenderer::INSTANCE_DATA_LENGTH = 21;
+	const unsigned int ParticleRenderer::FILL_CHUNK_SIZE = 512;
 
 	std::vector<float> ParticleRenderer::s_Buffer;
 
-	ParticleRenderer::ParticleRenderer(Loader& loader, Matrix4f& projectionMatrix)
-		: m_Quad(loader.loadToVao(VERTICES, 2)), m_vbo(nullptr, INSTANCE_DATA_LENGTH) {
+	ParticleRenderer::ParticleRenderer(Loader& loader, Matrix4f& projectionMatrix, ThreadPool& threadPool)
+		: m_ThreadPool(threadPool), m_Quad(loader.loadToVao(VERTICES, 2)), m_vbo(nullptr, INSTANCE_DATA_LENGTH), m_ProjectionMatrix(projectionMatrix) {
 		m_Quad.getVertexArray().bind();
 		m_vbo.addInstancedAttribute(1, 4, INSTANCE_DATA_LENGTH, 0);
 		m_vbo.addInstancedAttribute(2, 4, INSTANCE_DATA_LENGTH, 4);
@@ -18,28 +19,37 @@ namespace Pressure {
 		m_vbo.addInstancedAttribute(4, 4, INSTANCE_DATA_LENGTH, 12);
 		m_vbo.addInstancedAttribute(5, 4, INSTANCE_DATA_LENGTH, 16);
 		m_vbo.addInstancedAttribute(6, 1, INSTANCE_DATA_LENGTH, 20);
+		// Enabled attributes are part of the vertex array, the quad's positions already are.
+		for (unsigned int i = 1; i <= 6; i++)
+			glEnableVertexAttribArray(i);
 		m_Quad.getVertexArray().unbind();
-		m_Shader.start();
-		m_Shader.loadProjectionMatrix(projectionMatrix);
 	}
 
 	void ParticleRenderer::render(std::map<ParticleTexture, std::list<Particle>>& particles, Camera& camera) {
 		Matrix4f viewMatrix;
 		viewMatrix.createViewMatrix(camera.getPosition(), camera.getPitch(), camera.getYaw(), camera.getRoll());
+		Matrix4f projectionView;
+		m_Frustum.extractPlanes(m_ProjectionMatrix.mul(viewMatrix, projectionView));
 		prepare();
 
 		for (auto it = particles.begin(); it != particles.end(); it++) {
+			unsigned int visibleCount = cullParticles(it->second);
+			if (visibleCount == 0)
+				continue;
+
 			bindTexture(it->first);
-			m_Pointer = 0;
-			this->s_Buffer = std::vector<float>(it->second.size() * INSTANCE_DATA_LENGTH);
-			for (Particle& particle : it->second) {
-				if (ViewFrustum::Inst().sphereInFrustum(particle.getPosition(), std::sqrtf(3.f) / 2 * particle.getScale())) {
-					updateViewMatrix(particle.getPosition(), particle.getRotation(), particle.getScale(), viewMatrix);
-					updateTexCoordInfo(particle);
+			if (s_Buffer.size() < visibleCount * INSTANCE_DATA_LENGTH)
+				s_Buffer.resize(visibleCount * INSTANCE_DATA_LENGTH);
+			m_ThreadPool.parallelFor(visibleCount, FILL_CHUNK_SIZE, [&](unsigned int begin, unsigned int end) {
+				for (unsigned int i = begin; i < end; i++) {
+					Particle& particle = *m_CullParticles[m_Visible[i]];
+					float* dest = &s_Buffer[i * INSTANCE_DATA_LENGTH];
+					updateViewMatrix(particle.getPosition(), particle.getRotation(), particle.getScale(), viewMatrix, dest);
+					updateTexCoordInfo(particle, dest + 16);
 				}
-			}
-			m_vbo.update(&s_Buffer[0], s_Buffer.size() * sizeof(float));
-			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, m_Quad.getVertexCount(), it->second.size());
+			});
+			m_vbo.update(&s_Buffer[0], visibleCount * INSTANCE_DATA_LENGTH * sizeof(float));
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, m_Quad.getVertexCount(), visibleCount);
 		}
 		finish();
 	}
@@ -51,30 +61,41 @@ namespace Pressure {
 	void ParticleRenderer::prepare() {
 		m_Shader.start();
 		m_Quad.getVertexArray().bind();
-		glEnableVertexAttribArray(0);
-		glEnableVertexAttribArray(1);
-		glEnableVertexAttribArray(2);
-		glEnableVertexAttribArray(3);
-		glEnableVertexAttribArray(4);
-		glEnableVertexAttribArray(5);
-		glEnableVertexAttribArray(6);
-		glEnable(GL_BLEND);
-		glDepthMask(false);
+		GLState::enable(GL_BLEND);
+		GLState::depthMask(false);
 	}
 
 	void ParticleRenderer::bindTexture(const ParticleTexture& texture) {
-		glActiveTexture(GL_TEXTURE0);
+		GLState::activeTexture(GL_TEXTURE0);
 		if (texture.isUseAdditiveBlending())
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+			GLState::blendFunc(GL_SRC_ALPHA, GL_ONE);
 		else 
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		TextureManager::Inst()->BindTexture(texture.getTextureID());
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		m_Shader.loadNumberOfRows((float) texture.getNumberOfRows());
 	}
 
-	void ParticleRenderer::updateViewMatrix(Vector3f& position, float rotation, float scale, Matrix4f& viewMatrix) {
+	unsigned int ParticleRenderer::cullParticles(std::list<Particle>& particles) {
+		m_CullParticles.clear();
+		m_CenterX.clear();
+		m_CenterY.clear();
+		m_CenterZ.clear();
+		m_Radius.clear();
+		for (Particle& particle : particles) {
+			m_CullParticles.push_back(&particle);
+			m_CenterX.push_back(particle.getPosition().getX());
+			m_CenterY.push_back(particle.getPosition().getY());
+			m_CenterZ.push_back(particle.getPosition().getZ());
+			m_Radius.push_back(std::sqrtf(3.f) / 2 * particle.getScale());
+		}
+
+		m_Visible.resize(m_CullParticles.size());
+		return m_Frustum.cullSpheres(m_CenterX.data(), m_CenterY.data(), m_CenterZ.data(), m_Radius.data(), m_CullParticles.size(), m_Visible.data());
+	}
+
+	void ParticleRenderer::updateViewMatrix(Vector3f& position, float rotation, float scale, const Matrix4f& viewMatrix, float* dest) const {
 		Matrix4f modelMatrix;
 		modelMatrix.translate(position);
 		modelMatrix.rotate((float) Math::toRadians(rotation), Vector3f(0, 0, 1));
@@ -89,54 +110,35 @@ namespace Pressure {
 		modelMatrix.set(2, 0, 0);
 		modelMatrix.set(2, 1, 0);
 		modelMatrix.set(2, 2, 1);
-		storeMatrixData(modelMatrix);
+		storeMatrixData(modelMatrix, dest);
 	}
 
-	void ParticleRenderer::storeMatrixData(Matrix4f& matrix) {
-		s_Buffer[m_Pointer++] = matrix.get(0, 0);
-		s_Buffer[m_Pointer++] = matrix.get(0, 1);
-		s_Buffer[m_Pointer++] = matrix.get(0, 2);
-		s_Buffer[m_Pointer++] = matrix.get(0, 3);
-		s_Buffer[m_Pointer++] = matrix.get(1, 0);
-		s_Buffer[m_Pointer++] = matrix.get(1, 1);
-		s_Buffer[m_Pointer++] = matrix.get(1, 2);
-		s_Buffer[m_Pointer++] = matrix.get(1, 3);
-		s_Buffer[m_Pointer++] = matrix.get(2, 0);
-		s_Buffer[m_Pointer++] = matrix.get(2, 1);
-		s_Buffer[m_Pointer++] = matrix.get(2, 2);
-		s_Buffer[m_Pointer++] = matrix.get(2, 3);
-		s_Buffer[m_Pointer++] = matrix.get(3, 0);
-		s_Buffer[m_Pointer++] = matrix.get(3, 1);
-		s_Buffer[m_Pointer++] = matrix.get(3, 2);
-		s_Buffer[m_Pointer++] = matrix.get(3, 3);
+	void ParticleRenderer::storeMatrixData(const Matrix4f& matrix, float* dest) const {
+		unsigned int pointer = 0;
+		for (int col = 0; col < 4; col++) {
+			for (int row = 0; row < 4; row++)
+				dest[pointer++] = matrix.get(col, row);
+		}
 	}
 
-	void ParticleRenderer::updateTexCoordInfo(Particle& particle) {
-		s_Buffer[m_Pointer++] = particle.getCurrentUV().getX();
-		s_Buffer[m_Pointer++] = particle.getCurrentUV().getY();
-		s_Buffer[m_Pointer++] = particle.getBlendUV().getX();
-		s_Buffer[m_Pointer++] = particle.getBlendUV().getY();
-		s_Buffer[m_Pointer++] = particle.getBlend();
+	void ParticleRenderer::updateTexCoordInfo(Particle& particle, float* dest) const {
+		dest[0] = particle.getCurrentUV().getX();
+		dest[1] = particle.getCurrentUV().getY();
+		dest[2] = particle.getBlendUV().getX();
+		dest[3] = particle.getBlendUV().getY();
+		dest[4] = particle.getBlend();
 	}
 
-	void ParticleRenderer::updateProjectionMatrix(Window& window) {
-		m_Shader.start();
-		m_Shader.loadProjectionMatrix(Matrix4f().createProjectionMatrix(window.getWindow()));
+	void ParticleRenderer::updateProjectionMatrix(const Window& window) {
+		// Only for culling, the shader takes the projection of the bound view.
+		m_ProjectionMatrix.createProjectionMatrix(window.getWidth(), window.getHeight());
 	}
 
 	void ParticleRenderer::finish() {
-		glDepthMask(true);
-		glDisable(GL_BLEND);
-		glBindTexture(GL_TEXTURE_2D, NULL);
-		glDisableVertexAttribArray(0);
-		glDisableVertexAttribArray(1);
-		glDisableVertexAttribArray(2);
-		glDisableVertexAttribArray(3);
-		glDisableVertexAttribArray(4);
-		glDisableVertexAttribArray(5);
-		glDisableVertexAttribArray(6);
-		glBindVertexArray(NULL);
-		m_Shader.stop();
+		GLState::depthMask(true);
+		GLState::disable(GL_BLEND);
+		GLState::bindTexture(GL_TEXTURE_2D, NULL);
+		GLState::bindVertexArray(NULL);
 	}
 
 }
@@ -8,6 +8,7 @@
 #include "../Models/RawModel.h"
 #include "../../Math/Geometry/ViewFrustum.h"
 #include "../Window.h"
+#include "../../Services/ThreadPool.h"
 
 namespace Pressure {
 
@@ -17,26 +18,39 @@ namespace Pressure {
 		const static std::vector<float> VERTICES;
 		const static int MAX_INSTANCES;
 		const static int INSTANCE_DATA_LENGTH;		
+		const static unsigned int FILL_CHUNK_SIZE;
 
 		static std::vector<float> s_Buffer;
-		unsigned int m_Pointer;
+		ThreadPool& m_ThreadPool;
 
 		RawModel m_Quad;
 		ParticleShader m_Shader;
 		VertexBuffer m_vbo;
+		Matrix4f m_ProjectionMatrix;
+		// Frustum of the camera of the current render() call.
+		ViewFrustum m_Frustum;
+
+		// Scratch arrays for culling a texture's particles in one batched frustum test.
+		std::vector<Particle*> m_CullParticles;
+		std::vector<float> m_CenterX;
+		std::vector<float> m_CenterY;
+		std::vector<float> m_CenterZ;
+		std::vector<float> m_Radius;
+		std::vector<unsigned int> m_Visible;
 
 	public:
-		ParticleRenderer(Loader& loader, Matrix4f& projectionMatrix);
+		ParticleRenderer(Loader& loader, Matrix4f& projectionMatrix, ThreadPool& threadPool);
 		void render(std::map<ParticleTexture, std::list<Particle>>& particles, Camera& camera);
-		void updateProjectionMatrix(Window& window);
+		void updateProjectionMatrix(const Window& window);
 		void cleanUp();
 		
 	private:
 		void prepare();
 		void bindTexture(const ParticleTexture& texture);
-		void updateViewMatrix(Vector3f& position, float rotation, float scale, Matrix4f& viewMatrix);
-		void storeMatrixData(Matrix4f& matrix);
-		void updateTexCoordInfo(Particle& particle);
+		unsigned int cullParticles(std::list<Particle>& particles);
+		void updateViewMatrix(Vector3f& position, float rotation, float scale, const Matrix4f& viewMatrix, float* dest) const;
+		void storeMatrixData(const Matrix4f& matrix, float* dest) const;
+		void updateTexCoordInfo(Particle& particle, float* dest) const;
 		void finish();
 
 	};
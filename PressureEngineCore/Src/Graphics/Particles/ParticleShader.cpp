@@ -8,7 +8,6 @@ namespace Pressure {
 	}
 
 	void ParticleShader::getAllUniformLocations() {
-		location_projectionMatrix = Shader::getUniformLocation("projectionMatrix");
 		location_numberOfRows = Shader::getUniformLocation("numberOfRows");
 	}
 
@@ -20,10 +19,6 @@ namespace Pressure {
 
 	}
 
-	void ParticleShader::loadProjectionMatrix(Matrix4f& matrix) {
-		Shader::loadMatrix(location_projectionMatrix, matrix);
-	}
-
 	void ParticleShader::loadNumberOfRows(const float numberOfRows) {
 		Shader::loadFloat(location_numberOfRows, numberOfRows);
 	}
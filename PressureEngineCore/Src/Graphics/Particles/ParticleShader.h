@@ -13,11 +13,9 @@ namespace Pressure {
 		virtual void bindAttributes() override;
 
 	public:
-		void loadProjectionMatrix(Matrix4f& matrix);
 		void loadNumberOfRows(const float numberOfRows);
 		
 	private:
-		int location_projectionMatrix;
 		int location_numberOfRows;
 
 	};
@@ -15,7 +15,13 @@ out vec2 textureCoords1;
 out vec2 textureCoords2;
 out float blend;
 
-uniform mat4 projectionMatrix;
+layout (std140) uniform ViewData {
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+	vec4 cameraPosition;
+	vec4 plane;
+};
+
 uniform float numberOfRows;
 
 void main(void) {
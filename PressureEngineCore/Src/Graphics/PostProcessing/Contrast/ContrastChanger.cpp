@@ -1,13 +1,13 @@
 #include "ContrastChanger.h"
+#include "../../GLObjects/GLState.h"
 
 namespace Pressure {
 
 	void ContrastChanger::render(unsigned int texture) {
 		m_Shader.start();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture);
+		GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_2D, texture);
 		m_Renderer.render();
-		m_Shader.stop();
 	}
 
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "DepthOfField.h"
+#include "../../GLObjects/GLState.h"
 #include "../../../Constants.h"
 
 namespace Pressure {
@@ -8,15 +9,13 @@ namespace Pressure {
 
 	void DepthOfField::render(unsigned int colorTexture, unsigned int depthTexture) {
 		m_Shader.start();
-		m_Shader.connectTextureUnits();
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, colorTexture);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, depthTexture);				
+		GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_2D, colorTexture);
+		GLState::activeTexture(GL_TEXTURE1);
+		GLState::bindTexture(GL_TEXTURE_2D, depthTexture);				
 		m_Shader.loadTargetSize(Vector2f((float)m_Window.getWidth(), (float)m_Window.getHeight()));
 		m_Renderer.render();
-		m_Shader.stop();
 	}
 
 	unsigned int DepthOfField::getResult() const {
@@ -18,7 +18,7 @@ namespace Pressure {
 		DepthOfFieldShader();
 		void getAllUniformLocations() override;
 		void bindAttributes() override;
-		void connectTextureUnits();
+		void connectTextureUnits() override;
 
 		void loadTargetSize(Vector2f& targetSize);
 
@@ -1,10 +1,11 @@
 #include "LightScatterer.h"
+#include "../../GLObjects/GLState.h"
 
 namespace Pressure {
 
 	LightScatterer::LightScatterer(unsigned int targetWidth, unsigned int targetHeight, Window& window)
 		: m_Window(window), m_Renderer(targetWidth, targetHeight, window), m_Shader() {
-		m_ProjectionMatrix.createProjectionMatrix(window.getWindow());
+		m_ProjectionMatrix.createProjectionMatrix(window.getWidth(), window.getHeight());
 	}
 
 	void LightScatterer::render(unsigned int colorTexture, unsigned int lightTexture, Vector3f& lightPosition, Camera& camera) {
@@ -24,14 +25,12 @@ namespace Pressure {
 		}
 
 		m_Shader.start();
-		m_Shader.connectTextureUnits();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, lightTexture);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, colorTexture);
+		GLState::activeTexture(GL_TEXTURE0);
+		GLState::bindTexture(GL_TEXTURE_2D, lightTexture);
+		GLState::activeTexture(GL_TEXTURE1);
+		GLState::bindTexture(GL_TEXTURE_2D, colorTexture);
 		m_Shader.loadLightPosition(screenPos);
 		m_Renderer.render();
-		m_Shader.stop();
 	}
 
 	unsigned int LightScatterer::getResult() {
@@ -39,7 +38,7 @@ namespace Pressure {
 	}
 
 	void LightScatterer::updateProjectionMatrix() {
-		m_ProjectionMatrix.createProjectionMatrix(m_Window.getWindow());
+		m_ProjectionMatrix.createProjectionMatrix(m_Window.getWidth(), m_Window.getHeight());
 	}
 
 }
\ No newline at end of file
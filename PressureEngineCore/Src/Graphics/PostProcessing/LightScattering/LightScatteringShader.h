@@ -19,7 +19,7 @@ namespace Pressure {
 		void getAllUniformLocations() override;
 		void bindAttributes() override;
 
-		void connectTextureUnits();
+		void connectTextureUnits() override;
 		void loadLightPosition(Vector2f& lightPosition);
 
 	};
@@ -37,13 +37,11 @@ namespace Pressure {
 
 	void PostProcessing::start() {
 		s_Quad->getVertexArray().bind();
-		glEnableVertexAttribArray(0);
-		glDisable(GL_DEPTH_TEST);
+		GLState::disable(GL_DEPTH_TEST);
 	}
 
 	void PostProcessing::stop() {
-		glEnable(GL_DEPTH_TEST);
-		glDisableVertexAttribArray(0);
+		GLState::enable(GL_DEPTH_TEST);
 		s_Quad->getVertexArray().unbind();
 	}
 
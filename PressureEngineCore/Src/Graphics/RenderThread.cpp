@@ -0,0 +1,115 @@
+#include "RenderThread.h"
+#include <chrono>
+
+namespace Pressure {
+
+	RenderThread::RenderThread()
+		: m_Recording(0), m_Pending(false), m_Running(false), m_Window(nullptr), m_WaitMilliseconds(0) {
+	}
+
+	RenderThread::~RenderThread() {
+		stop();
+	}
+
+	void RenderThread::start(GLFWwindow* window, const Scene& scene, const std::function<void(FrameSnapshot&)>& draw) {
+		if (m_Running)
+			return;
+
+		m_Generations.clear();
+		m_Alive.clear();
+		m_FreeSlots.clear();
+		for (unsigned int i = 0; i < scene.getSlotCount(); i++) {
+			const SceneHandle handle = scene.getHandle(i);
+			m_Generations.push_back(handle.generation);
+			m_Alive.push_back(scene.isValid(handle));
+			if (!m_Alive.back())
+				m_FreeSlots.push_back(i);
+		}
+
+		m_Window = window;
+		m_Draw = draw;
+		m_Running = true;
+		// A context can only be current on one thread at a time.
+		glfwMakeContextCurrent(nullptr);
+		m_Thread = std::thread(&RenderThread::run, this);
+	}
+
+	void RenderThread::stop() {
+		if (!m_Thread.joinable())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Running = false;
+		}
+		m_Condition.notify_all();
+		m_Thread.join();
+		glfwMakeContextCurrent(m_Window);
+	}
+
+	void RenderThread::submit() {
+		const auto start = std::chrono::steady_clock::now();
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return !m_Pending; });
+			m_Recording = 1 - m_Recording;
+			m_Pending = true;
+		}
+		m_Condition.notify_all();
+		m_WaitMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	SceneHandle RenderThread::allocate() {
+		unsigned int slot;
+		if (!m_FreeSlots.empty()) {
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		} else {
+			slot = m_Generations.size();
+			m_Generations.push_back(0);
+			m_Alive.push_back(false);
+		}
+		m_Alive[slot] = true;
+		return { slot, m_Generations[slot] };
+	}
+
+	bool RenderThread::release(const SceneHandle& handle) {
+		if (!isValid(handle))
+			return false;
+
+		// Same as Scene::remove(), so the handles given out here stay the ones the Scene would have.
+		m_Alive[handle.index] = false;
+		m_Generations[handle.index]++;
+		m_FreeSlots.push_back(handle.index);
+		return true;
+	}
+
+	bool RenderThread::isValid(const SceneHandle& handle) const {
+		return handle.index < m_Generations.size() && m_Alive[handle.index] && m_Generations[handle.index] == handle.generation;
+	}
+
+	void RenderThread::run() {
+		glfwMakeContextCurrent(m_Window);
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while (true) {
+			m_Condition.wait(lock, [this] { return m_Pending || !m_Running; });
+			// Whatever was submitted before stop() still gets drawn.
+			if (!m_Pending)
+				break;
+
+			// m_Recording only changes while nothing is pending, so the snapshot stays put without holding the lock.
+			FrameSnapshot& snapshot = m_Snapshots[1 - m_Recording];
+			lock.unlock();
+			m_Draw(snapshot);
+			snapshot.clear();
+			lock.lock();
+
+			m_Pending = false;
+			m_Condition.notify_all();
+		}
+
+		glfwMakeContextCurrent(nullptr);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <GLFW\glfw3.h>
+
+#include "FrameSnapshot.h"
+
+namespace Pressure {
+
+	// Owns the GL context on a thread of its own and draws the frames the game thread records, one frame behind.
+	// The game thread fills one snapshot while the other is drawn, submit() trades them once the render thread is done,
+	// so the frame time comes down to the slower of the two instead of their sum.
+	class RenderThread {
+
+	private:
+		std::thread m_Thread;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+
+		FrameSnapshot m_Snapshots[2];
+		// Snapshot the game thread records into, the other one belongs to the render thread while m_Pending.
+		unsigned int m_Recording;
+		bool m_Pending;
+		bool m_Running;
+
+		GLFWwindow* m_Window;
+		std::function<void(FrameSnapshot&)> m_Draw;
+		// Milliseconds the last submit() waited for the render thread.
+		float m_WaitMilliseconds;
+
+		// Mirror of the Scene's slots, so the game thread can hand out handles for entities the Scene only gets a frame later.
+		std::vector<unsigned int> m_Generations;
+		std::vector<bool> m_Alive;
+		std::vector<unsigned int> m_FreeSlots;
+
+	public:
+		RenderThread();
+		~RenderThread();
+
+		// Moves the context of the window to the render thread, which calls draw for every submitted snapshot.
+		// The scene is read once to take over its handles and belongs to the render thread from here on.
+		void start(GLFWwindow* window, const Scene& scene, const std::function<void(FrameSnapshot&)>& draw);
+		// Draws what was submitted and makes the context current on the calling thread again.
+		void stop();
+
+		// Hands the recorded snapshot to the render thread. Waits while the previous one is still being drawn.
+		void submit();
+		inline FrameSnapshot& getSnapshot() { return m_Snapshots[m_Recording]; }
+		inline float getWaitTime() const { return m_WaitMilliseconds; }
+
+		SceneHandle allocate();
+		// Returns false if the handle was already released.
+		bool release(const SceneHandle& handle);
+		bool isValid(const SceneHandle& handle) const;
+
+	private:
+		RenderThread(const RenderThread& thread) = delete;
+		RenderThread& operator=(const RenderThread& thread) = delete;
+
+		void run();
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,292 @@
+#include "OcclusionCuller.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <immintrin.h>
+#include "../EntityShaders/EntityInstanceBuffer.h"
+
+namespace Pressure {
+
+	const unsigned int OcclusionCuller::WIDTH = 256;
+	const unsigned int OcclusionCuller::HEIGHT = 128;
+	const int OcclusionCuller::NO_OCCLUDER = -1;
+	const unsigned int OcclusionCuller::BAND_HEIGHT = 8;
+	const unsigned int OcclusionCuller::TEST_CHUNK_SIZE = 256;
+
+	OcclusionCuller::OcclusionCuller() {
+		for (unsigned int width = WIDTH, height = HEIGHT; width && height; width /= 2, height /= 2)
+			m_Pyramid.emplace_back(width * height, 0.f);
+	}
+
+	void OcclusionCuller::addOccluder(const RawModel& model, const std::vector<float>& positions, const std::vector<unsigned int>& indices) {
+		if (m_MeshLookup.find(model.getMeshID()) != m_MeshLookup.end())
+			return;
+		m_MeshLookup[model.getMeshID()] = m_Meshes.size();
+		m_Meshes.push_back({ positions, indices });
+		// Batches already known might use the new mesh.
+		m_BatchMeshes.clear();
+	}
+
+	void OcclusionCuller::rasterize(const Scene& scene, const Matrix4f& projectionViewMatrix, const std::vector<SceneEntry>& visible, ThreadPool& threadPool) {
+		m_Statistics = Statistics();
+		m_Occluders.clear();
+		if (m_Meshes.empty())
+			return;
+
+		const std::vector<SceneBatch>& batches = scene.getBatches();
+		while (m_BatchMeshes.size() < batches.size()) {
+			auto it = m_MeshLookup.find(batches[m_BatchMeshes.size()].model.getRawModel().getMeshID());
+			m_BatchMeshes.push_back(it == m_MeshLookup.end() ? NO_OCCLUDER : it->second);
+		}
+		for (const SceneEntry& entry : visible) {
+			if (m_BatchMeshes[entry.batch] != NO_OCCLUDER)
+				m_Occluders.push_back(entry);
+		}
+		if (m_Occluders.empty())
+			return;
+
+		for (unsigned int i = 0; i < 16; i++)
+			m_ProjectionViewMatrix[i] = projectionViewMatrix.get(i);
+		if (m_Triangles.size() < m_Occluders.size()) {
+			m_ClipVertices.resize(m_Occluders.size());
+			m_Triangles.resize(m_Occluders.size());
+		}
+		threadPool.parallelFor(m_Occluders.size(), 1, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				const SceneBatch& batch = batches[m_Occluders[i].batch];
+				setupTriangles(m_Meshes[m_BatchMeshes[m_Occluders[i].batch]], &batch.instanceData[m_Occluders[i].entry * EntityInstanceBuffer::INSTANCE_DATA_LENGTH],
+					m_ClipVertices[i], m_Triangles[i]);
+			}
+		});
+
+		std::fill(m_Pyramid[0].begin(), m_Pyramid[0].end(), 0.f);
+		threadPool.parallelFor(HEIGHT / BAND_HEIGHT, 1, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int band = begin; band < end; band++)
+				rasterizeBand(band * BAND_HEIGHT, (band + 1) * BAND_HEIGHT);
+		});
+		buildPyramid();
+
+		m_Statistics.occluders = m_Occluders.size();
+		for (unsigned int i = 0; i < m_Occluders.size(); i++)
+			m_Statistics.triangles += m_Triangles[i].size();
+	}
+
+	unsigned int OcclusionCuller::cull(const Scene& scene, std::vector<SceneEntry>& visible, ThreadPool& threadPool) {
+		if (m_Occluders.empty())
+			return 0;
+
+		const std::vector<SceneBatch>& batches = scene.getBatches();
+		m_Occluded.resize(visible.size());
+		threadPool.parallelFor(visible.size(), TEST_CHUNK_SIZE, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				const SceneBatch& batch = batches[visible[i].batch];
+				const unsigned int entry = visible[i].entry;
+				m_Occluded[i] = isOccluded(batch.centerX[entry], batch.centerY[entry], batch.centerZ[entry], batch.radius[entry]);
+			}
+		});
+
+		unsigned int count = 0;
+		for (unsigned int i = 0; i < visible.size(); i++) {
+			if (!m_Occluded[i])
+				visible[count++] = visible[i];
+		}
+		const unsigned int culled = visible.size() - count;
+		visible.resize(count);
+		return culled;
+	}
+
+	void OcclusionCuller::setupTriangles(const OccluderMesh& mesh, const float* modelMatrix, std::vector<float>& clipVertices, std::vector<Triangle>& triangles) const {
+		const float* pv = m_ProjectionViewMatrix;
+		float mvp[16];
+		for (unsigned int col = 0; col < 4; col++) {
+			for (unsigned int row = 0; row < 4; row++)
+				mvp[col * 4 + row] = pv[row] * modelMatrix[col * 4] + pv[4 + row] * modelMatrix[col * 4 + 1] + pv[8 + row] * modelMatrix[col * 4 + 2] + pv[12 + row] * modelMatrix[col * 4 + 3];
+		}
+
+		const unsigned int vertexCount = mesh.positions.size() / 3;
+		clipVertices.resize(vertexCount * 4);
+		for (unsigned int i = 0; i < vertexCount; i++) {
+			const float* position = &mesh.positions[i * 3];
+			for (unsigned int row = 0; row < 4; row++)
+				clipVertices[i * 4 + row] = mvp[row] * position[0] + mvp[4 + row] * position[1] + mvp[8 + row] * position[2] + mvp[12 + row];
+		}
+
+		triangles.clear();
+		for (unsigned int i = 0; i + 2 < mesh.indices.size(); i += 3)
+			clipTriangle(&clipVertices[mesh.indices[i] * 4], &clipVertices[mesh.indices[i + 1] * 4], &clipVertices[mesh.indices[i + 2] * 4], triangles);
+	}
+
+	void OcclusionCuller::clipTriangle(const float* v0, const float* v1, const float* v2, std::vector<Triangle>& triangles) const {
+		const float* vertices[3] = { v0, v1, v2 };
+		// Distance to the near plane z = -w.
+		float distances[3];
+		unsigned int inside = 0;
+		for (unsigned int i = 0; i < 3; i++) {
+			distances[i] = vertices[i][2] + vertices[i][3];
+			if (distances[i] >= 0)
+				inside++;
+		}
+		if (inside == 3) {
+			addTriangle(v0, v1, v2, triangles);
+			return;
+		}
+		if (inside == 0)
+			return;
+
+		// One plane cuts off one or two corners, leaving at most four vertices in the same winding.
+		float clipped[4][4];
+		unsigned int count = 0;
+		for (unsigned int i = 0; i < 3; i++) {
+			const unsigned int next = (i + 1) % 3;
+			if (distances[i] >= 0)
+				std::copy(vertices[i], vertices[i] + 4, clipped[count++]);
+			if ((distances[i] >= 0) != (distances[next] >= 0)) {
+				const float t = distances[i] / (distances[i] - distances[next]);
+				for (unsigned int k = 0; k < 4; k++)
+					clipped[count][k] = vertices[i][k] + (vertices[next][k] - vertices[i][k]) * t;
+				count++;
+			}
+		}
+		for (unsigned int i = 2; i < count; i++)
+			addTriangle(clipped[0], clipped[i - 1], clipped[i], triangles);
+	}
+
+	void OcclusionCuller::addTriangle(const float* v0, const float* v1, const float* v2, std::vector<Triangle>& triangles) const {
+		const float* vertices[3] = { v0, v1, v2 };
+		float x[3], y[3], depth[3];
+		for (unsigned int i = 0; i < 3; i++) {
+			depth[i] = 1 / vertices[i][3];
+			x[i] = (vertices[i][0] * depth[i] * 0.5f + 0.5f) * WIDTH;
+			y[i] = (vertices[i][1] * depth[i] * 0.5f + 0.5f) * HEIGHT;
+		}
+
+		// Counter clockwise front faces have a positive area, with the rows going up like window coordinates.
+		const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (area <= 0)
+			return;
+
+		Triangle triangle;
+		triangle.minX = (int) std::max(std::floor(std::min({ x[0], x[1], x[2] })), 0.f);
+		triangle.maxX = (int) std::min(std::ceil(std::max({ x[0], x[1], x[2] })), (float) WIDTH - 1);
+		triangle.minY = (int) std::max(std::floor(std::min({ y[0], y[1], y[2] })), 0.f);
+		triangle.maxY = (int) std::min(std::ceil(std::max({ y[0], y[1], y[2] })), (float) HEIGHT - 1);
+		if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+			return;
+
+		// Edge i runs between the two other vertices, it is the barycentric weight of vertex i times the area.
+		triangle.depthX = triangle.depthY = triangle.depthConstant = 0;
+		for (unsigned int i = 0; i < 3; i++) {
+			const unsigned int from = (i + 1) % 3, to = (i + 2) % 3;
+			triangle.edgeX[i] = y[from] - y[to];
+			triangle.edgeY[i] = x[to] - x[from];
+			triangle.edgeConstant[i] = -(triangle.edgeX[i] * x[from] + triangle.edgeY[i] * y[from]);
+			triangle.depthX += triangle.edgeX[i] * depth[i] / area;
+			triangle.depthY += triangle.edgeY[i] * depth[i] / area;
+			triangle.depthConstant += triangle.edgeConstant[i] * depth[i] / area;
+		}
+		triangles.push_back(triangle);
+	}
+
+	void OcclusionCuller::rasterizeBand(const unsigned int firstRow, const unsigned int lastRow) {
+		const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 zero = _mm_setzero_ps();
+		float* buffer = m_Pyramid[0].data();
+
+		for (unsigned int i = 0; i < m_Occluders.size(); i++) {
+			for (const Triangle& triangle : m_Triangles[i]) {
+				const int first = std::max(triangle.minY, (int) firstRow);
+				const int last = std::min(triangle.maxY, (int) lastRow - 1);
+				if (first > last)
+					continue;
+
+				const __m128 edgeX0 = _mm_set1_ps(triangle.edgeX[0]);
+				const __m128 edgeX1 = _mm_set1_ps(triangle.edgeX[1]);
+				const __m128 edgeX2 = _mm_set1_ps(triangle.edgeX[2]);
+				const __m128 depthX = _mm_set1_ps(triangle.depthX);
+				// Four pixels at a time from a multiple of four, the buffer width is one as well.
+				const int firstColumn = triangle.minX & ~3;
+				for (int y = first; y <= last; y++) {
+					const float centerY = y + 0.5f;
+					const __m128 row0 = _mm_set1_ps(triangle.edgeY[0] * centerY + triangle.edgeConstant[0]);
+					const __m128 row1 = _mm_set1_ps(triangle.edgeY[1] * centerY + triangle.edgeConstant[1]);
+					const __m128 row2 = _mm_set1_ps(triangle.edgeY[2] * centerY + triangle.edgeConstant[2]);
+					const __m128 rowDepth = _mm_set1_ps(triangle.depthY * centerY + triangle.depthConstant);
+					float* pixels = buffer + y * WIDTH;
+					for (int x = firstColumn; x <= triangle.maxX; x += 4) {
+						const __m128 centerX = _mm_add_ps(_mm_set1_ps((float) x), offsets);
+						__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX0, centerX), row0), zero);
+						inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX1, centerX), row1), zero));
+						inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX2, centerX), row2), zero));
+						if (!_mm_movemask_ps(inside))
+							continue;
+
+						const __m128 depth = _mm_add_ps(_mm_mul_ps(depthX, centerX), rowDepth);
+						const __m128 current = _mm_loadu_ps(pixels + x);
+						_mm_storeu_ps(pixels + x, _mm_or_ps(_mm_and_ps(inside, _mm_max_ps(current, depth)), _mm_andnot_ps(inside, current)));
+					}
+				}
+			}
+		}
+	}
+
+	void OcclusionCuller::buildPyramid() {
+		for (unsigned int level = 1; level < m_Pyramid.size(); level++) {
+			const unsigned int width = WIDTH >> level, height = HEIGHT >> level;
+			const float* source = m_Pyramid[level - 1].data();
+			float* dest = m_Pyramid[level].data();
+			for (unsigned int y = 0; y < height; y++) {
+				const float* row0 = source + y * 2 * width * 2;
+				const float* row1 = row0 + width * 2;
+				for (unsigned int x = 0; x < width; x++)
+					dest[y * width + x] = std::min(std::min(row0[x * 2], row0[x * 2 + 1]), std::min(row1[x * 2], row1[x * 2 + 1]));
+			}
+		}
+	}
+
+	bool OcclusionCuller::isOccluded(const float centerX, const float centerY, const float centerZ, const float radius) const {
+		const float* m = m_ProjectionViewMatrix;
+		float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+		// Largest inverse depth of the box, so its closest point.
+		float nearest = 0;
+		for (unsigned int i = 0; i < 8; i++) {
+			const float x = centerX + (i & 1 ? radius : -radius);
+			const float y = centerY + (i & 2 ? radius : -radius);
+			const float z = centerZ + (i & 4 ? radius : -radius);
+			const float clipZ = m[2] * x + m[6] * y + m[10] * z + m[14];
+			const float clipW = m[3] * x + m[7] * y + m[11] * z + m[15];
+			// Bounds reaching through the near plane are never occluded.
+			if (clipZ + clipW < 0)
+				return false;
+
+			const float inverseW = 1 / clipW;
+			const float screenX = ((m[0] * x + m[4] * y + m[8] * z + m[12]) * inverseW * 0.5f + 0.5f) * WIDTH;
+			const float screenY = ((m[1] * x + m[5] * y + m[9] * z + m[13]) * inverseW * 0.5f + 0.5f) * HEIGHT;
+			minX = std::min(minX, screenX);
+			maxX = std::max(maxX, screenX);
+			minY = std::min(minY, screenY);
+			maxY = std::max(maxY, screenY);
+			nearest = std::max(nearest, inverseW);
+		}
+		// Left to frustum culling.
+		if (maxX < 0 || maxY < 0 || minX >= WIDTH || minY >= HEIGHT)
+			return false;
+
+		const int x0 = (int) std::max(minX, 0.f), x1 = (int) std::min(maxX, (float) WIDTH - 1);
+		const int y0 = (int) std::max(minY, 0.f), y1 = (int) std::min(maxY, (float) HEIGHT - 1);
+		// The finest level at which the rectangle spans at most 4x4 texels.
+		unsigned int level = 0;
+		while (level + 1 < m_Pyramid.size() && ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3))
+			level++;
+
+		const unsigned int width = WIDTH >> level;
+		const std::vector<float>& depth = m_Pyramid[level];
+		for (int y = y0 >> level; y <= y1 >> level; y++) {
+			for (int x = x0 >> level; x <= x1 >> level; x++) {
+				if (depth[y * width + x] <= nearest)
+					return false;
+			}
+		}
+		return true;
+	}
+
+}
\ No newline at end of file
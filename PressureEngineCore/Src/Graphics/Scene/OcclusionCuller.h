@@ -0,0 +1,95 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+
+#include "../../DllExport.h"
+#include "../../Services/ThreadPool.h"
+#include "Scene.h"
+
+namespace Pressure {
+
+	// Rasterizes the occluders of a view into a small depth buffer on the CPU, then removes the entities whose bounds
+	// are hidden behind them from visible lists. Nothing is read back from the GPU.
+	//
+	// The buffer holds the inverse depth 1 / w of the closest occluder per pixel, 0 where there is none. Each level of
+	// the pyramid keeps the smallest value, so the farthest occluder, of the 2x2 pixels below it.
+	class PRESSURE_API OcclusionCuller {
+
+	public:
+		// Work of the last rasterize() call, cull() returns what it removed from each list.
+		struct Statistics {
+			unsigned int occluders = 0;
+			unsigned int triangles = 0;
+		};
+
+		const static unsigned int WIDTH;
+		const static unsigned int HEIGHT;
+
+	private:
+		struct OccluderMesh {
+			std::vector<float> positions;
+			std::vector<unsigned int> indices;
+		};
+
+		// Occluder triangle in pixels, as edge functions that are positive inside and a plane of the inverse depth.
+		struct Triangle {
+			float edgeX[3];
+			float edgeY[3];
+			float edgeConstant[3];
+			float depthX;
+			float depthY;
+			float depthConstant;
+			int minX;
+			int maxX;
+			int minY;
+			int maxY;
+		};
+
+		const static int NO_OCCLUDER;
+		// Rows rasterized by one task, every task walks all triangles but only touches its own rows.
+		const static unsigned int BAND_HEIGHT;
+		const static unsigned int TEST_CHUNK_SIZE;
+
+		std::vector<OccluderMesh> m_Meshes;
+		std::unordered_map<unsigned int, unsigned int> m_MeshLookup;
+		// Occluder mesh of every scene batch, NO_OCCLUDER for batches that only get tested.
+		std::vector<int> m_BatchMeshes;
+
+		// Column major like Matrix4f, copied for the tight loops.
+		float m_ProjectionViewMatrix[16];
+		std::vector<SceneEntry> m_Occluders;
+		// Clip space vertices and triangles per occluder, so they can be set up in parallel.
+		std::vector<std::vector<float>> m_ClipVertices;
+		std::vector<std::vector<Triangle>> m_Triangles;
+		std::vector<std::vector<float>> m_Pyramid;
+		std::vector<unsigned char> m_Occluded;
+		Statistics m_Statistics;
+
+	public:
+		OcclusionCuller();
+
+		// Entities using the mesh hide what is behind them. Meant for large closed meshes like terrain and buildings.
+		void addOccluder(const RawModel& model, const std::vector<float>& positions, const std::vector<unsigned int>& indices);
+		inline bool hasOccluders() const { return !m_Meshes.empty(); }
+
+		// Fills the depth buffer with the occluders among the visible entities of a view.
+		void rasterize(const Scene& scene, const Matrix4f& projectionViewMatrix, const std::vector<SceneEntry>& visible, ThreadPool& threadPool);
+		// Removes the entities hidden behind the occluders of the last rasterize() call, keeping the order of the others.
+		// Only valid for lists culled with the same camera. Returns how many entities were removed.
+		unsigned int cull(const Scene& scene, std::vector<SceneEntry>& visible, ThreadPool& threadPool);
+
+		inline const Statistics& getStatistics() const { return m_Statistics; }
+
+	private:
+		void setupTriangles(const OccluderMesh& mesh, const float* modelMatrix, std::vector<float>& clipVertices, std::vector<Triangle>& triangles) const;
+		// Clips the triangle against the near plane, the rasterizer only clamps to the other planes.
+		void clipTriangle(const float* v0, const float* v1, const float* v2, std::vector<Triangle>& triangles) const;
+		// Drops back faces, which are culled when drawing as well.
+		void addTriangle(const float* v0, const float* v1, const float* v2, std::vector<Triangle>& triangles) const;
+		void rasterizeBand(const unsigned int firstRow, const unsigned int lastRow);
+		void buildPyramid();
+		bool isOccluded(const float centerX, const float centerY, const float centerZ, const float radius) const;
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include "../../Constants.h"
+
+namespace Pressure {
+
+	const uint64_t RenderQueue::DEPTH_MASK = (1ull << 24) - 1;
+	const uint64_t RenderQueue::VARIANT_MASK = (1ull << 5) - 1;
+	const uint64_t RenderQueue::STATE_MASK = (1ull << 16) - 1;
+
+	void RenderQueue::clear() {
+		m_Items.clear();
+	}
+
+	void RenderQueue::push(const uint64_t key, const unsigned int batch, const unsigned int entry, const unsigned int lod) {
+		m_Items.push_back({ key, batch, entry, lod });
+	}
+
+	void RenderQueue::push(const std::vector<Item>& items) {
+		m_Items.insert(m_Items.end(), items.begin(), items.end());
+	}
+
+	void RenderQueue::resize(const unsigned int count) {
+		m_Items.resize(count);
+	}
+
+	void RenderQueue::set(const unsigned int index, const uint64_t key, const unsigned int batch, const unsigned int entry, const unsigned int lod) {
+		m_Items[index] = { key, batch, entry, lod };
+	}
+
+	void RenderQueue::sort() {
+		const size_t count = m_Items.size();
+		if (count < 2)
+			return;
+
+		// LSD radix sort, one byte per pass. All histograms are built up front in a single sweep.
+		unsigned int histograms[8][256] = {};
+		for (const Item& item : m_Items) {
+			for (unsigned int digit = 0; digit < 8; digit++)
+				histograms[digit][(item.key >> (digit * 8)) & 0xFF]++;
+		}
+
+		m_Scratch.resize(count);
+		Item* src = m_Items.data();
+		Item* dst = m_Scratch.data();
+		for (unsigned int digit = 0; digit < 8; digit++) {
+			unsigned int* histogram = histograms[digit];
+			const unsigned int shift = digit * 8;
+
+			// Every key shares this byte, nothing to reorder.
+			if (histogram[(src[0].key >> shift) & 0xFF] == count)
+				continue;
+
+			unsigned int offset = 0;
+			for (unsigned int bucket = 0; bucket < 256; bucket++) {
+				unsigned int bucketSize = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketSize;
+			}
+			for (size_t i = 0; i < count; i++)
+				dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+			std::swap(src, dst);
+		}
+
+		if (src != m_Items.data())
+			m_Items.swap(m_Scratch);
+	}
+
+	uint64_t RenderQueue::makeKey(const Pass pass, const bool transparent, const unsigned int variant, const unsigned int texture, const unsigned int mesh, const float depth) {
+		// Fields are cut to their width. Values past it share sort positions with others, which only costs some grouping,
+		// as draws are split by batch and binds compare the full names.
+		uint64_t quantizedDepth = (uint64_t)(std::min(std::max(depth / PRESSURE_FAR_PLANE, 0.f), 1.f) * DEPTH_MASK);
+		uint64_t state = ((variant & VARIANT_MASK) << 32) | ((texture & STATE_MASK) << 16) | (mesh & STATE_MASK);
+
+		uint64_t key = (uint64_t)(pass & 3) << 62;
+		if (!transparent)
+			return key | (state << 24) | quantizedDepth;
+
+		return key | (1ull << 61) | ((DEPTH_MASK - quantizedDepth) << 37) | state;
+	}
+
+}
\ No newline at end of file
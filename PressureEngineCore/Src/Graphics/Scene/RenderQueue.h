@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Pressure {
+
+	// Draw items keyed by a 64-bit sort key, radix sorted once per frame so that drawing them in order
+	// minimizes state changes.
+	//
+	// Opaque:      | pass 2 | 0 | variant 5 | texture 16 | mesh 16 | depth 24 |
+	// Transparent: | pass 2 | 1 | inverted depth 24 | variant 5 | texture 16 | mesh 16 |
+	//
+	// Opaque items are grouped by state and drawn front to back within a group, transparent items are drawn back to front.
+	class RenderQueue {
+
+	public:
+		enum Pass : unsigned char {
+			PASS_MAIN = 0,
+			PASS_REFLECTION = 1,
+			PASS_REFRACTION = 2,
+			PASS_SHADOW = 3
+		};
+
+		struct Item {
+			uint64_t key;
+			unsigned int batch;
+			unsigned int entry;
+			// Level of detail of the entity's model.
+			unsigned int lod;
+		};
+
+	private:
+		const static uint64_t DEPTH_MASK;
+		const static uint64_t VARIANT_MASK;
+		const static uint64_t STATE_MASK;
+
+		std::vector<Item> m_Items;
+		std::vector<Item> m_Scratch;
+
+	public:
+		void clear();
+		void push(const uint64_t key, const unsigned int batch, const unsigned int entry, const unsigned int lod = 0);
+		void push(const std::vector<Item>& items);
+		// Resizes the queue so it can be filled through set() from several threads.
+		void resize(const unsigned int count);
+		void set(const unsigned int index, const uint64_t key, const unsigned int batch, const unsigned int entry, const unsigned int lod = 0);
+		void sort();
+
+		inline const std::vector<Item>& getItems() const { return m_Items; }
+
+		// Mesh identifies the mesh and its level of detail. Depth is the distance from the camera, quantized against the far plane.
+		static uint64_t makeKey(const Pass pass, const bool transparent, const unsigned int variant, const unsigned int texture, const unsigned int mesh, const float depth);
+
+	};
+
+}
\ No newline at end of file
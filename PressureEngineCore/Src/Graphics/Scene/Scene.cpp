@@ -0,0 +1,256 @@
+#include "Scene.h"
+#include <algorithm>
+#include "../EntityShaders/EntityInstanceBuffer.h"
+#include "../../Log.h"
+
+namespace Pressure {
+
+	const unsigned int Scene::FLUSH_CHUNK_SIZE = 256;
+	const float Scene::BOUNDS_PADDING = 1.1f;
+
+	Scene::Scene()
+		: m_EntityCount(0), m_StaticVersion(0) {
+	}
+
+	SceneHandle Scene::add(const Entity& entity) {
+		unsigned int slot;
+		if (!m_FreeSlots.empty()) {
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		} else {
+			slot = m_Slots.size();
+			m_Slots.push_back({ 0, 0, 0, AABBTree::NULL_NODE, false, false, false });
+		}
+
+		insert(slot, entity);
+		m_Slots[slot].alive = true;
+		m_EntityCount++;
+		return { slot, m_Slots[slot].generation };
+	}
+
+	void Scene::add(const SceneHandle& handle, const Entity& entity) {
+		while (m_Slots.size() <= handle.index) {
+			m_FreeSlots.push_back(m_Slots.size());
+			m_Slots.push_back({ 0, 0, 0, AABBTree::NULL_NODE, false, false, false });
+		}
+		if (m_Slots[handle.index].alive) {
+			PRESSURE_LOG(LOG_WARNING, "Tried to add an entity to an occupied scene slot.");
+			return;
+		}
+
+		m_FreeSlots.erase(std::find(m_FreeSlots.begin(), m_FreeSlots.end(), handle.index));
+		insert(handle.index, entity);
+		m_Slots[handle.index].generation = handle.generation;
+		m_Slots[handle.index].alive = true;
+		m_EntityCount++;
+	}
+
+	void Scene::remove(const SceneHandle& handle) {
+		if (!isValid(handle)) {
+			PRESSURE_LOG(LOG_WARNING, "Tried to remove an entity through an invalid scene handle.");
+			return;
+		}
+
+		erase(handle.index);
+		removeProxy(handle.index);
+		Slot& slot = m_Slots[handle.index];
+		slot.alive = false;
+		slot.generation++;
+		m_FreeSlots.push_back(handle.index);
+		m_EntityCount--;
+	}
+
+	void Scene::update(const SceneHandle& handle, const Entity& entity) {
+		if (!isValid(handle)) {
+			PRESSURE_LOG(LOG_WARNING, "Tried to update an entity through an invalid scene handle.");
+			return;
+		}
+
+		Slot& slot = m_Slots[handle.index];
+		SceneBatch& batch = m_Batches[slot.batch];
+		if (!(batch.model == entity.getTexturedModel())) {
+			erase(handle.index);
+			insert(handle.index, entity);
+			return;
+		}
+
+		batch.entities[slot.entry] = entity;
+		markDirty(handle.index);
+	}
+
+	void Scene::flush(ThreadPool& threadPool) {
+		threadPool.parallelFor(m_Dirty.size(), FLUSH_CHUNK_SIZE, [this](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				const Slot& slot = m_Slots[m_Dirty[i]];
+				if (!slot.alive)
+					continue;
+				SceneBatch& batch = m_Batches[slot.batch];
+				writeEntry(batch, slot.entry, batch.entities[slot.entry]);
+			}
+		});
+
+		// The tree is not thread safe, but only entities that left their fat bounds touch it.
+		for (unsigned int slot : m_Dirty) {
+			if (m_Slots[slot].alive)
+				updateProxy(slot);
+			m_Slots[slot].dirty = false;
+		}
+		m_Dirty.clear();
+	}
+
+	bool Scene::isValid(const SceneHandle& handle) const {
+		return handle.index < m_Slots.size() && m_Slots[handle.index].alive && m_Slots[handle.index].generation == handle.generation;
+	}
+
+	const Entity& Scene::get(const SceneHandle& handle) const {
+		PRESSURE_ASSERT(isValid(handle), "Invalid scene handle!");
+		const Slot& slot = m_Slots[handle.index];
+		return m_Batches[slot.batch].entities[slot.entry];
+	}
+
+	void Scene::query(const ViewFrustum& frustum, std::vector<SceneEntry>& visible, const unsigned int planeMask, const unsigned int flags) const {
+		auto visitor = [&](unsigned int slot) {
+			visible.push_back({ m_Slots[slot].batch, m_Slots[slot].entry });
+		};
+		if (flags & QUERY_STATIC)
+			m_StaticTree.query(frustum, visitor, planeMask);
+		if (flags & QUERY_DYNAMIC)
+			m_DynamicTree.query(frustum, visitor, planeMask);
+	}
+
+	void Scene::clear() {
+		for (SceneBatch& batch : m_Batches) {
+			batch.entities.clear();
+			batch.instanceData.clear();
+			batch.slots.clear();
+			batch.centerX.clear();
+			batch.centerY.clear();
+			batch.centerZ.clear();
+			batch.radius.clear();
+		}
+		m_StaticTree.clear();
+		m_DynamicTree.clear();
+		m_StaticVersion++;
+		for (unsigned int slot : m_Dirty)
+			m_Slots[slot].dirty = false;
+		m_Dirty.clear();
+		for (unsigned int i = 0; i < m_Slots.size(); i++) {
+			if (m_Slots[i].alive) {
+				m_Slots[i].alive = false;
+				m_Slots[i].generation++;
+				m_Slots[i].proxy = AABBTree::NULL_NODE;
+				m_FreeSlots.push_back(i);
+			}
+		}
+		m_EntityCount = 0;
+	}
+
+	unsigned int Scene::getBatch(const TexturedModel& model) {
+		auto it = m_BatchLookup.find(model);
+		if (it != m_BatchLookup.end())
+			return it->second;
+
+		m_Batches.emplace_back(model);
+		m_BatchLookup.emplace(model, m_Batches.size() - 1);
+		return m_Batches.size() - 1;
+	}
+
+	void Scene::insert(const unsigned int slot, const Entity& entity) {
+		unsigned int batchIndex = getBatch(entity.getTexturedModel());
+		SceneBatch& batch = m_Batches[batchIndex];
+
+		m_Slots[slot].batch = batchIndex;
+		m_Slots[slot].entry = batch.entities.size();
+
+		batch.entities.push_back(entity);
+		batch.slots.push_back(slot);
+		batch.instanceData.resize(batch.instanceData.size() + EntityInstanceBuffer::INSTANCE_DATA_LENGTH);
+		batch.centerX.push_back(0);
+		batch.centerY.push_back(0);
+		batch.centerZ.push_back(0);
+		batch.radius.push_back(0);
+		markDirty(slot);
+	}
+
+	void Scene::erase(const unsigned int slot) {
+		SceneBatch& batch = m_Batches[m_Slots[slot].batch];
+		unsigned int entry = m_Slots[slot].entry;
+		unsigned int last = batch.entities.size() - 1;
+
+		// Swap with the last entity so the batch stays dense.
+		if (entry != last) {
+			batch.entities[entry] = batch.entities[last];
+			batch.slots[entry] = batch.slots[last];
+			batch.centerX[entry] = batch.centerX[last];
+			batch.centerY[entry] = batch.centerY[last];
+			batch.centerZ[entry] = batch.centerZ[last];
+			batch.radius[entry] = batch.radius[last];
+			std::copy(batch.instanceData.begin() + last * EntityInstanceBuffer::INSTANCE_DATA_LENGTH, batch.instanceData.end(),
+				batch.instanceData.begin() + entry * EntityInstanceBuffer::INSTANCE_DATA_LENGTH);
+			m_Slots[batch.slots[entry]].entry = entry;
+		}
+
+		batch.entities.pop_back();
+		batch.slots.pop_back();
+		batch.instanceData.resize(batch.instanceData.size() - EntityInstanceBuffer::INSTANCE_DATA_LENGTH);
+		batch.centerX.pop_back();
+		batch.centerY.pop_back();
+		batch.centerZ.pop_back();
+		batch.radius.pop_back();
+	}
+
+	void Scene::markDirty(const unsigned int slot) {
+		// A removed and reused slot can still be listed, it is only listed once either way.
+		if (m_Slots[slot].dirty)
+			return;
+		m_Slots[slot].dirty = true;
+		m_Dirty.push_back(slot);
+	}
+
+	void Scene::writeEntry(SceneBatch& batch, const unsigned int entry, const Entity& entity) {
+		EntityInstanceBuffer::writeInstance(entity, &batch.instanceData[entry * EntityInstanceBuffer::INSTANCE_DATA_LENGTH]);
+
+		AABB bounds = entity.getBounds();
+		Vector3f center = bounds.getCenter();
+		batch.centerX[entry] = center.getX();
+		batch.centerY[entry] = center.getY();
+		batch.centerZ[entry] = center.getZ();
+		batch.radius[entry] = bounds.getRadius();
+	}
+
+	void Scene::updateProxy(const unsigned int slot) {
+		Slot& entry = m_Slots[slot];
+		const Entity& entity = m_Batches[entry.batch].entities[entry.entry];
+		AABB bounds = entity.getBounds();
+		bounds.scale(BOUNDS_PADDING);
+
+		// Entities that start or stop moving change trees.
+		bool dynamic = entity.isMoving();
+		if (entry.proxy != AABBTree::NULL_NODE && entry.dynamic != dynamic)
+			removeProxy(slot);
+		if (!dynamic)
+			m_StaticVersion++;
+
+		entry.dynamic = dynamic;
+		AABBTree& tree = dynamic ? m_DynamicTree : m_StaticTree;
+		if (entry.proxy == AABBTree::NULL_NODE)
+			entry.proxy = tree.insert(bounds, slot);
+		else
+			tree.move(entry.proxy, bounds);
+	}
+
+	void Scene::removeProxy(const unsigned int slot) {
+		Slot& entry = m_Slots[slot];
+		if (entry.proxy == AABBTree::NULL_NODE)
+			return;
+
+		if (entry.dynamic) {
+			m_DynamicTree.remove(entry.proxy);
+		} else {
+			m_StaticTree.remove(entry.proxy);
+			m_StaticVersion++;
+		}
+		entry.proxy = AABBTree::NULL_NODE;
+	}
+
+}
\ No newline at end of file
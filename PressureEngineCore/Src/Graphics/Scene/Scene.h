@@ -0,0 +1,138 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+
+#include "../../DllExport.h"
+#include "../Entities/Entity.h"
+#include "../Models/TexturedModel.h"
+#include "../../Services/ThreadPool.h"
+#include "../../Math/Geometry/AABBTree.h"
+
+namespace Pressure {
+
+	// Stable reference to an entity in a Scene. Stays valid until the entity is removed,
+	// after which the generation no longer matches and the handle is rejected.
+	struct SceneHandle {
+		unsigned int index = 0;
+		unsigned int generation = 0;
+	};
+
+	// All entities sharing a TexturedModel, kept alive across frames.
+	struct SceneBatch {
+		TexturedModel model;
+		std::vector<Entity> entities;
+		// EntityInstanceBuffer::INSTANCE_DATA_LENGTH floats per entity, rebuilt by Scene::flush() only when the entity changed.
+		std::vector<float> instanceData;
+		// Slot owning each entity, used to patch the slot when an entity is moved within the batch.
+		std::vector<unsigned int> slots;
+
+		// Bounds centers in SoA layout, used for the depth of the sort keys.
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		// Bounds radii, used to pick the level of detail.
+		std::vector<float> radius;
+
+		SceneBatch(const TexturedModel& model)
+			: model(model) {}
+	};
+
+	// Location of an entity within the batches.
+	struct SceneEntry {
+		unsigned int batch;
+		unsigned int entry;
+	};
+
+	// Retained-mode entity registry. Entities are added once and only touched again when they change,
+	// so the per frame cost is proportional to the number of changes instead of the scene size.
+	class PRESSURE_API Scene {
+
+	public:
+		// Which entities a query returns. Entities count as dynamic while Entity::isMoving().
+		enum QueryFlags : unsigned int {
+			QUERY_STATIC = 1,
+			QUERY_DYNAMIC = 2,
+			QUERY_ALL = QUERY_STATIC | QUERY_DYNAMIC
+		};
+
+	private:
+		struct Slot {
+			unsigned int batch;
+			unsigned int entry;
+			unsigned int generation;
+			// Leaf in the static or dynamic tree, NULL_NODE until the first flush().
+			int proxy;
+			bool dynamic;
+			bool alive;
+			bool dirty;
+		};
+
+		const static unsigned int FLUSH_CHUNK_SIZE;
+		// Bounds are padded by this factor in the tree to cover wind sway.
+		const static float BOUNDS_PADDING;
+
+		std::vector<SceneBatch> m_Batches;
+		std::unordered_map<TexturedModel, unsigned int> m_BatchLookup;
+
+		std::vector<Slot> m_Slots;
+		std::vector<unsigned int> m_FreeSlots;
+		// Slots whose instance data and bounds have to be rebuilt on the next flush().
+		std::vector<unsigned int> m_Dirty;
+		unsigned int m_EntityCount;
+
+		// Bounding volume hierarchies over the static and the dynamic entities, the user data of each leaf is its slot.
+		AABBTree m_StaticTree;
+		AABBTree m_DynamicTree;
+		// Changes whenever a static entity is added, changed or removed.
+		unsigned int m_StaticVersion;
+
+	public:
+		Scene();
+
+		SceneHandle add(const Entity& entity);
+		// Adds the entity under a handle allocated elsewhere, like the game side of a RenderThread.
+		// The slot of the handle has to be free.
+		void add(const SceneHandle& handle, const Entity& entity);
+		void remove(const SceneHandle& handle);
+		// Replaces the stored entity. Moving it to another TexturedModel moves it to that batch.
+		void update(const SceneHandle& handle, const Entity& entity);
+
+		// Rebuilds transforms and bounds of everything added or updated since the last flush, split over the thread pool.
+		// Has to be called before rendering.
+		void flush(ThreadPool& threadPool);
+
+		bool isValid(const SceneHandle& handle) const;
+		const Entity& get(const SceneHandle& handle) const;
+
+		// Appends every entity whose bounds intersect the frustum to visible. Planes missing from planeMask are ignored.
+		void query(const ViewFrustum& frustum, std::vector<SceneEntry>& visible, const unsigned int planeMask = ViewFrustum::ALL_PLANES, const unsigned int flags = QUERY_ALL) const;
+
+		// Hierarchies for the multi-view culling of SceneVisibility, the user data of every leaf is a slot for getEntry().
+		inline const AABBTree& getStaticTree() const { return m_StaticTree; }
+		inline const AABBTree& getDynamicTree() const { return m_DynamicTree; }
+		inline SceneEntry getEntry(const unsigned int slot) const { return { m_Slots[slot].batch, m_Slots[slot].entry }; }
+		// Every slot, alive or not, so handles can be allocated in step with the scene.
+		inline unsigned int getSlotCount() const { return m_Slots.size(); }
+		inline SceneHandle getHandle(const unsigned int slot) const { return { slot, m_Slots[slot].generation }; }
+
+		// Lets caches of static geometry, like the static shadow maps, tell when they are stale.
+		inline unsigned int getStaticVersion() const { return m_StaticVersion; }
+
+		// Batches are never removed, empty ones are skipped by the renderers.
+		inline const std::vector<SceneBatch>& getBatches() const { return m_Batches; }
+		inline unsigned int getEntityCount() const { return m_EntityCount; }
+
+		void clear();
+
+	private:
+		unsigned int getBatch(const TexturedModel& model);
+		void insert(const unsigned int slot, const Entity& entity);
+		void erase(const unsigned int slot);
+		void markDirty(const unsigned int slot);
+		void writeEntry(SceneBatch& batch, const unsigned int entry, const Entity& entity);
+		void updateProxy(const unsigned int slot);
+		void removeProxy(const unsigned int slot);
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "SceneVisibility.h"
+#include "../../Log.h"
+#include <algorithm>
+
+namespace Pressure {
+
+	static_assert(SceneVisibility::MAX_VIEWS <= AABBTree::MAX_VIEWS, "The trees have to test every view in one sweep.");
+
+	const unsigned int SceneVisibility::NO_VIEW = ~0u;
+	const float SceneVisibility::LINEAR_SCAN_SHARE = 0.1f;
+	const unsigned int SceneVisibility::TASKS_PER_THREAD = 4;
+	const unsigned int SceneVisibility::SCAN_CHUNK_SIZE = 4096;
+
+	SceneVisibility::SceneVisibility()
+		: m_ViewCount(0), m_TaskCount(0), m_ScanTaskCount(0) {
+	}
+
+	void SceneVisibility::clear() {
+		m_ViewCount = 0;
+	}
+
+	unsigned int SceneVisibility::addView(const Matrix4f& projectionViewMatrix, const unsigned int planeMask, const unsigned int flags) {
+		if (m_ViewCount == MAX_VIEWS) {
+			PRESSURE_LOG(LOG_WARNING, "Too many scene views, the view is not culled!");
+			return NO_VIEW;
+		}
+		// Views are reused across frames to keep the capacity of their lists.
+		if (m_ViewCount == m_Views.size())
+			m_Views.emplace_back();
+		SceneView& view = m_Views[m_ViewCount];
+		view.frustum.extractPlanes(projectionViewMatrix);
+		view.planeMask = planeMask;
+		view.flags = flags;
+		view.linear = false;
+		view.visible.clear();
+		return m_ViewCount++;
+	}
+
+	void SceneVisibility::setClipPlane(const unsigned int view, const Vector4f& plane) {
+		// The scan does not test the clip plane, so the view goes back to the trees.
+		m_Views[view].linear = false;
+		m_Views[view].frustum.setClipPlane(plane);
+		m_Views[view].planeMask |= 1 << ViewFrustum::PLANE_CLIP;
+	}
+
+	void SceneVisibility::setLinearScan(const unsigned int view) {
+		const bool complete = m_Views[view].planeMask == ViewFrustum::ALL_PLANES && m_Views[view].flags == Scene::QUERY_ALL;
+		PRESSURE_ASSERT(complete, "Only views testing every frustum plane and wanting every entity can be scanned!");
+		if (!complete)
+			return;
+		m_Views[view].linear = true;
+	}
+
+	void SceneVisibility::cull(const Scene& scene, ThreadPool& threadPool) {
+		const ViewFrustum* frustums[MAX_VIEWS];
+		unsigned int planeMasks[MAX_VIEWS];
+		unsigned int staticViews = 0, dynamicViews = 0;
+		m_ScanTaskCount = 0;
+		for (unsigned int i = 0; i < m_ViewCount; i++) {
+			frustums[i] = &m_Views[i].frustum;
+			planeMasks[i] = m_Views[i].planeMask;
+			if (m_Views[i].linear) {
+				addScanTasks(scene, i);
+				continue;
+			}
+			if (m_Views[i].flags & Scene::QUERY_STATIC)
+				staticViews |= 1 << i;
+			if (m_Views[i].flags & Scene::QUERY_DYNAMIC)
+				dynamicViews |= 1 << i;
+		}
+
+		m_TaskCount = 0;
+		addTasks(scene.getStaticTree(), staticViews, threadPool.getThreadCount() * TASKS_PER_THREAD);
+		addTasks(scene.getDynamicTree(), dynamicViews, threadPool.getThreadCount() * TASKS_PER_THREAD);
+
+		threadPool.parallelFor(m_TaskCount + m_ScanTaskCount, 1, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				if (i >= m_TaskCount) {
+					scan(scene, m_ScanTasks[i - m_TaskCount]);
+					continue;
+				}
+
+				Task& task = m_Tasks[i];
+				task.visible.resize(m_ViewCount);
+				for (auto& visible : task.visible)
+					visible.clear();
+				task.tree->query(frustums, planeMasks, task.viewMask, task.root, [&](unsigned int slot, unsigned int viewMask) {
+					SceneEntry entry = scene.getEntry(slot);
+					for (unsigned int view = 0; viewMask; view++, viewMask >>= 1) {
+						if (viewMask & 1)
+							task.visible[view].push_back(entry);
+					}
+				});
+			}
+		});
+
+		// Merged in task order, so the lists do not depend on how the tasks were scheduled.
+		threadPool.parallelFor(m_ViewCount, 1, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int view = begin; view < end; view++) {
+				std::vector<SceneEntry>& visible = m_Views[view].visible;
+				visible.clear();
+				if (m_Views[view].linear) {
+					for (unsigned int i = 0; i < m_ScanTaskCount; i++) {
+						if (m_ScanTasks[i].view == view)
+							visible.insert(visible.end(), m_ScanTasks[i].visible.begin(), m_ScanTasks[i].visible.end());
+					}
+					continue;
+				}
+				for (unsigned int i = 0; i < m_TaskCount; i++)
+					visible.insert(visible.end(), m_Tasks[i].visible[view].begin(), m_Tasks[i].visible[view].end());
+			}
+		});
+	}
+
+	void SceneVisibility::addTasks(const AABBTree& tree, const unsigned int viewMask, const unsigned int count) {
+		if (!viewMask)
+			return;
+
+		tree.getSubtrees(count, m_Roots);
+		for (int root : m_Roots) {
+			if (m_TaskCount == m_Tasks.size())
+				m_Tasks.emplace_back();
+			Task& task = m_Tasks[m_TaskCount++];
+			task.tree = &tree;
+			task.root = root;
+			task.viewMask = viewMask;
+		}
+	}
+
+	void SceneVisibility::addScanTasks(const Scene& scene, const unsigned int view) {
+		// Large batches are split up as well, so they spread over the workers.
+		const std::vector<SceneBatch>& batches = scene.getBatches();
+		for (unsigned int b = 0; b < batches.size(); b++) {
+			const unsigned int entityCount = batches[b].entities.size();
+			for (unsigned int begin = 0; begin < entityCount; begin += SCAN_CHUNK_SIZE) {
+				if (m_ScanTaskCount == m_ScanTasks.size())
+					m_ScanTasks.emplace_back();
+				ScanTask& task = m_ScanTasks[m_ScanTaskCount++];
+				task.view = view;
+				task.batch = b;
+				task.begin = begin;
+				task.end = std::min(begin + SCAN_CHUNK_SIZE, entityCount);
+			}
+		}
+	}
+
+	void SceneVisibility::scan(const Scene& scene, ScanTask& task) const {
+		const SceneBatch& batch = scene.getBatches()[task.batch];
+		const unsigned int count = task.end - task.begin;
+		task.indices.resize(count);
+		task.visible.clear();
+		const unsigned int visibleCount = m_Views[task.view].frustum.cullSpheres(&batch.centerX[task.begin], &batch.centerY[task.begin], &batch.centerZ[task.begin],
+			&batch.radius[task.begin], count, task.indices.data());
+		for (unsigned int v = 0; v < visibleCount; v++)
+			task.visible.push_back({ task.batch, task.begin + task.indices[v] });
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+#include <vector>
+
+#include "../../DllExport.h"
+#include "Scene.h"
+#include "../Shaders/FrameUniforms.h"
+
+namespace Pressure {
+
+	// A camera, mirrored camera or light the scene is culled for.
+	struct SceneView {
+		ViewFrustum frustum;
+		// Planes of the frustum that are tested.
+		unsigned int planeMask;
+		// Scene::QueryFlags of the entities the view wants.
+		unsigned int flags;
+		// Culled by a sphere scan over the batches instead of the trees, see SceneVisibility::setLinearScan().
+		bool linear;
+		std::vector<SceneEntry> visible;
+	};
+
+	// Computes the visible entities of every view of a frame in one parallel sweep over the scene hierarchies,
+	// so the main, water and shadow passes get ready-made lists instead of each walking the scene on its own.
+	class PRESSURE_API SceneVisibility {
+
+	public:
+		// Views of a frame, shared with FrameUniforms so every culled view can get its uniforms.
+		const static unsigned int MAX_VIEWS = FrameUniforms::MAX_VIEWS;
+		// Returned by addView() once MAX_VIEWS are in use, callers skip the view.
+		const static unsigned int NO_VIEW;
+		// Share of the scene a view has to see before scanning every entity beats walking the trees, from the visible share benchmark.
+		const static float LINEAR_SCAN_SHARE;
+
+	private:
+		// Subtree of one of the scene trees culled as one unit of work, with its own per view results.
+		struct Task {
+			const AABBTree* tree;
+			int root;
+			unsigned int viewMask;
+			std::vector<std::vector<SceneEntry>> visible;
+		};
+
+		// Range of a batch scanned for one linear view as one unit of work.
+		struct ScanTask {
+			unsigned int view;
+			unsigned int batch;
+			unsigned int begin;
+			unsigned int end;
+			std::vector<unsigned int> indices;
+			std::vector<SceneEntry> visible;
+		};
+
+		// Tasks per thread, more than one so uneven subtrees still balance out.
+		const static unsigned int TASKS_PER_THREAD;
+		const static unsigned int SCAN_CHUNK_SIZE;
+
+		std::vector<SceneView> m_Views;
+		unsigned int m_ViewCount;
+		std::vector<Task> m_Tasks;
+		unsigned int m_TaskCount;
+		std::vector<ScanTask> m_ScanTasks;
+		unsigned int m_ScanTaskCount;
+		std::vector<int> m_Roots;
+
+	public:
+		SceneVisibility();
+
+		void clear();
+		// Returns the index of the new view, valid until clear(), or NO_VIEW if there is no room left. Planes missing from planeMask are ignored.
+		unsigned int addView(const Matrix4f& projectionViewMatrix, const unsigned int planeMask = ViewFrustum::ALL_PLANES, const unsigned int flags = Scene::QUERY_ALL);
+		// Also rejects entities fully behind the world space plane, like the clip plane of a water pass.
+		void setClipPlane(const unsigned int view, const Vector4f& plane);
+		// Culls the view with the batched ViewFrustum::cullSpheres() over the bounds of every entity instead of the trees.
+		// Faster when the view sees a large share of the scene, like the camera usually does. The scan only tests the six
+		// frustum planes and takes static and dynamic entities alike, so the view has to use ALL_PLANES and QUERY_ALL.
+		// A later setClipPlane() sends the view back to the trees.
+		void setLinearScan(const unsigned int view);
+
+		// Fills the visible list of every view. The scene has to be flushed.
+		void cull(const Scene& scene, ThreadPool& threadPool);
+
+		inline const SceneView& getView(const unsigned int view) const { return m_Views[view]; }
+		inline const std::vector<SceneEntry>& getVisible(const unsigned int view) const { return m_Views[view].visible; }
+		// For later stages like the occlusion culling to narrow a list down.
+		inline std::vector<SceneEntry>& getVisible(const unsigned int view) { return m_Views[view].visible; }
+		inline unsigned int getViewCount() const { return m_ViewCount; }
+
+	private:
+		void addTasks(const AABBTree& tree, const unsigned int viewMask, const unsigned int count);
+		void addScanTasks(const Scene& scene, const unsigned int view);
+		void scan(const Scene& scene, ScanTask& task) const;
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "FrameUniforms.h"
+#include <cstring>
+
+namespace Pressure {
+
+	const unsigned int FrameUniforms::FRAME_BINDING = 0;
+	const unsigned int FrameUniforms::VIEW_BINDING = 1;
+	const char* FrameUniforms::FRAME_BLOCK = "FrameData";
+	const char* FrameUniforms::VIEW_BLOCK = "ViewData";
+
+	FrameUniforms::FrameUniforms()
+		: m_ViewOffset(align(sizeof(FrameData))), m_ViewStride(align(sizeof(ViewData))), m_Buffer(m_ViewOffset + MAX_VIEWS * m_ViewStride),
+		m_Frame(), m_ViewCount(0), m_Data(m_Buffer.getSize()) {
+		m_Buffer.bindRange(FRAME_BINDING, 0, sizeof(FrameData));
+	}
+
+	void FrameUniforms::loadLights(std::vector<Light>& lights) {
+		for (unsigned int i = 0; i < MAX_LIGHTS; i++) {
+			if (i < lights.size()) {
+				storeVector(lights[i].getPosition(), 0, m_Frame.lightPosition[i]);
+				storeVector(lights[i].getColor(), 0, m_Frame.lightColor[i]);
+				storeVector(lights[i].getAttenuation(), 0, m_Frame.attenuation[i]);
+			} else {
+				storeVector(Vector3f(0), 0, m_Frame.lightPosition[i]);
+				storeVector(Vector3f(0), 0, m_Frame.lightColor[i]);
+				storeVector(Vector3f(1, 0, 0), 0, m_Frame.attenuation[i]);
+			}
+		}
+	}
+
+	void FrameUniforms::loadShadowCascade(const unsigned int cascade, const Matrix4f& toShadowMapSpace, const float distance) {
+		storeMatrix(toShadowMapSpace, m_Frame.toShadowMapSpace[cascade]);
+		m_Frame.cascadeDistances[cascade] = distance;
+	}
+
+	void FrameUniforms::loadShadowParameters(const unsigned int cascadeCount, const float shadowMapSize, const float shadowDistance) {
+		m_Frame.cascadeCount = cascadeCount;
+		m_Frame.shadowMapSize = shadowMapSize;
+		m_Frame.shadowDistance = shadowDistance;
+	}
+
+	void FrameUniforms::clearViews() {
+		m_ViewCount = 0;
+	}
+
+	unsigned int FrameUniforms::addView(const Matrix4f& projectionMatrix, const Matrix4f& viewMatrix, const Vector3f& cameraPosition, const Vector4f& clipPlane) {
+		PRESSURE_ASSERT(m_ViewCount < MAX_VIEWS, "Too many views in one frame!");
+		ViewData view;
+		storeMatrix(projectionMatrix, view.projectionMatrix);
+		storeMatrix(viewMatrix, view.viewMatrix);
+		storeVector(cameraPosition, 1, view.cameraPosition);
+		view.plane[0] = clipPlane.x;
+		view.plane[1] = clipPlane.y;
+		view.plane[2] = clipPlane.z;
+		view.plane[3] = clipPlane.w;
+		std::memcpy(&m_Data[m_ViewOffset + m_ViewCount * m_ViewStride], &view, sizeof(ViewData));
+		return m_ViewCount++;
+	}
+
+	void FrameUniforms::upload() {
+		std::memcpy(&m_Data[0], &m_Frame, sizeof(FrameData));
+		m_Buffer.update(m_Data.data(), m_ViewOffset + m_ViewCount * m_ViewStride);
+	}
+
+	void FrameUniforms::bindView(const unsigned int view) const {
+		m_Buffer.bindRange(VIEW_BINDING, m_ViewOffset + view * m_ViewStride, sizeof(ViewData));
+	}
+
+	void FrameUniforms::bindView(const unsigned int view, CommandList& list) const {
+		list.bindUniformRange(m_Buffer, VIEW_BINDING, m_ViewOffset + view * m_ViewStride, sizeof(ViewData));
+	}
+
+	void FrameUniforms::cleanUp() {
+		m_Buffer.del();
+	}
+
+	void FrameUniforms::bindBlocks(const unsigned int program) {
+		unsigned int frameBlock = glGetUniformBlockIndex(program, FRAME_BLOCK);
+		if (frameBlock != GL_INVALID_INDEX)
+			glUniformBlockBinding(program, frameBlock, FRAME_BINDING);
+		unsigned int viewBlock = glGetUniformBlockIndex(program, VIEW_BLOCK);
+		if (viewBlock != GL_INVALID_INDEX)
+			glUniformBlockBinding(program, viewBlock, VIEW_BINDING);
+	}
+
+	unsigned int FrameUniforms::align(const unsigned int size) {
+		unsigned int alignment = UniformBuffer::getOffsetAlignment();
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	void FrameUniforms::storeMatrix(const Matrix4f& matrix, float* dest) {
+		for (unsigned int i = 0; i < 16; i++)
+			dest[i] = matrix.get(i);
+	}
+
+	void FrameUniforms::storeVector(const Vector3f& vector, const float w, float* dest) {
+		dest[0] = vector.x;
+		dest[1] = vector.y;
+		dest[2] = vector.z;
+		dest[3] = w;
+	}
+
+}
\ No newline at end of file
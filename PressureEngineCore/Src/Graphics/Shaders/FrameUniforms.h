@@ -0,0 +1,82 @@
+#pragma once
+#include <vector>
+#include "../GLObjects/UniformBuffer.h"
+#include "../GLObjects/CommandList.h"
+#include "../Entities/Light.h"
+
+namespace Pressure {
+
+	// The uniforms every program shares, uploaded once per frame into a single std140 buffer.
+	// FrameData holds the lights and shadow cascades, ViewData the matrices and clip plane of one view.
+	// Programs declaring the blocks get them bound by Shader, switching views is one buffer range bind.
+	class FrameUniforms {
+
+	public:
+		const static unsigned int FRAME_BINDING;
+		const static unsigned int VIEW_BINDING;
+		const static char* FRAME_BLOCK;
+		const static char* VIEW_BLOCK;
+		const static unsigned int MAX_LIGHTS = 4;
+		const static unsigned int MAX_CASCADES = 4;
+		const static unsigned int MAX_VIEWS = 16;
+
+	private:
+		// Mirrors of the blocks in the shaders, every vec3 is padded to a vec4 as std140 does.
+		struct FrameData {
+			float lightPosition[MAX_LIGHTS][4];
+			float lightColor[MAX_LIGHTS][4];
+			float attenuation[MAX_LIGHTS][4];
+			float toShadowMapSpace[MAX_CASCADES][16];
+			float cascadeDistances[MAX_CASCADES];
+			int cascadeCount;
+			float shadowMapSize;
+			float shadowDistance;
+			float padding;
+		};
+
+		struct ViewData {
+			float projectionMatrix[16];
+			float viewMatrix[16];
+			float cameraPosition[4];
+			float plane[4];
+		};
+
+		// Views start at offsets the GL can bind, the frame data goes in front of them.
+		unsigned int m_ViewOffset;
+		unsigned int m_ViewStride;
+		UniformBuffer m_Buffer;
+
+		FrameData m_Frame;
+		unsigned int m_ViewCount;
+		std::vector<unsigned char> m_Data;
+
+	public:
+		FrameUniforms();
+
+		void loadLights(std::vector<Light>& lights);
+		void loadShadowCascade(const unsigned int cascade, const Matrix4f& toShadowMapSpace, const float distance);
+		void loadShadowParameters(const unsigned int cascadeCount, const float shadowMapSize, const float shadowDistance);
+
+		// Forgets the views of the last frame.
+		void clearViews();
+		// Returns the index to bind the view with.
+		unsigned int addView(const Matrix4f& projectionMatrix, const Matrix4f& viewMatrix, const Vector3f& cameraPosition, const Vector4f& clipPlane);
+		// Uploads the frame data and every view in one go.
+		void upload();
+		void bindView(const unsigned int view) const;
+		// Records the bind instead, for a pass replayed later.
+		void bindView(const unsigned int view, CommandList& list) const;
+
+		void cleanUp();
+
+		// Points the blocks the program declares at the shared bindings.
+		static void bindBlocks(const unsigned int program);
+
+	private:
+		static unsigned int align(const unsigned int size);
+		static void storeMatrix(const Matrix4f& matrix, float* dest);
+		static void storeVector(const Vector3f& vector, const float w, float* dest);
+
+	};
+
+}
\ No newline at end of file
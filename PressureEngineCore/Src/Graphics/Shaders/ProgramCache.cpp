@@ -0,0 +1,167 @@
+#include "ProgramCache.h"
+#include <cstring>
+#include "../../Common.h"
+#include "../../Services/FileStream.h"
+#include "../../Services/Properties.h"
+
+namespace Pressure {
+
+	const uint32_t ProgramCache::MAGIC = 0x31435350; // "PSC1"
+
+	std::string ProgramCache::s_FileName;
+	std::string ProgramCache::s_Driver;
+	bool ProgramCache::s_Supported = false;
+	bool ProgramCache::s_Dirty = false;
+	std::unordered_map<uint64_t, ProgramCache::Entry> ProgramCache::s_Entries;
+	ProgramCache::Statistics ProgramCache::s_Statistics;
+
+	void ProgramCache::init() {
+		s_Entries.clear();
+		s_Statistics = Statistics();
+		s_Dirty = false;
+		s_FileName = Properties::get("shaderCache");
+		int formats = 0;
+		if (GLAD_GL_VERSION_4_1)
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		s_Supported = !s_FileName.empty() && formats > 0;
+		if (!s_Supported)
+			return;
+		s_Driver = std::string((const char*)glGetString(GL_VENDOR)) + "\n" + (const char*)glGetString(GL_RENDERER) + "\n" + (const char*)glGetString(GL_VERSION);
+
+		std::vector<char> file;
+		if (!FileStream::readBinary(s_FileName.c_str(), file))
+			return;
+		size_t offset = 0;
+		auto read = [&](void* dest, const size_t size) {
+			if (offset + size > file.size())
+				return false;
+			std::memcpy(dest, &file[offset], size);
+			offset += size;
+			return true;
+		};
+
+		uint32_t magic = 0, driverLength = 0, count = 0;
+		if (!read(&magic, sizeof(magic)) || magic != MAGIC || !read(&driverLength, sizeof(driverLength)) || offset + driverLength > file.size()
+			|| std::string(&file[offset], driverLength) != s_Driver) {
+			// Written by another driver or an older engine, none of it can be used.
+			s_Dirty = true;
+			return;
+		}
+		offset += driverLength;
+		read(&count, sizeof(count));
+		for (uint32_t i = 0; i < count; i++) {
+			uint64_t key;
+			uint32_t format, length;
+			if (!read(&key, sizeof(key)) || !read(&format, sizeof(format)) || !read(&length, sizeof(length)) || offset + length > file.size())
+				break;
+			Entry& entry = s_Entries[key];
+			entry.format = format;
+			entry.binary.assign(file.begin() + offset, file.begin() + offset + length);
+			entry.used = false;
+			offset += length;
+		}
+	}
+
+	void ProgramCache::save(const bool dropUnused) {
+		if (!s_Supported)
+			return;
+		if (dropUnused) {
+			for (auto it = s_Entries.begin(); it != s_Entries.end();) {
+				if (it->second.used) {
+					it++;
+				} else {
+					it = s_Entries.erase(it);
+					s_Dirty = true;
+				}
+			}
+		}
+		if (!s_Dirty)
+			return;
+
+		std::vector<char> file;
+		auto write = [&](const void* src, const size_t size) {
+			file.insert(file.end(), (const char*)src, (const char*)src + size);
+		};
+		const uint32_t driverLength = s_Driver.size(), count = s_Entries.size();
+		write(&MAGIC, sizeof(MAGIC));
+		write(&driverLength, sizeof(driverLength));
+		write(s_Driver.data(), driverLength);
+		write(&count, sizeof(count));
+		for (const auto& pair : s_Entries) {
+			const uint32_t format = pair.second.format, length = pair.second.binary.size();
+			write(&pair.first, sizeof(pair.first));
+			write(&format, sizeof(format));
+			write(&length, sizeof(length));
+			write(pair.second.binary.data(), length);
+		}
+		if (FileStream::writeBinary(s_FileName.c_str(), file))
+			s_Dirty = false;
+		else
+			PRESSURE_LOG(LOG_WARNING, "Could not write the shader cache to " + s_FileName + ".");
+	}
+
+	uint64_t ProgramCache::getKey(const std::string& vertexShader, const std::string& geometryShader, const std::string& fragmentShader) {
+		// 64-bit FNV-1a, with a separator so moving text between the stages changes the key.
+		uint64_t hash = 14695981039346656037ull;
+		for (const std::string* source : { &vertexShader, &geometryShader, &fragmentShader }) {
+			for (const char c : *source)
+				hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+			hash = (hash ^ 0xff) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	bool ProgramCache::load(const unsigned int program, const uint64_t key) {
+		if (!s_Supported)
+			return false;
+		auto it = s_Entries.find(key);
+		if (it == s_Entries.end())
+			return false;
+
+		glProgramBinary(program, it->second.format, it->second.binary.data(), it->second.binary.size());
+		int status = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		if (!status) {
+			// The driver changed without its version string changing, the program gets compiled and stored again.
+			s_Entries.erase(it);
+			s_Dirty = true;
+			return false;
+		}
+		it->second.used = true;
+		return true;
+	}
+
+	void ProgramCache::prepare(const unsigned int program) {
+		if (s_Supported)
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
+	void ProgramCache::store(const unsigned int program, const uint64_t key) {
+		if (!s_Supported)
+			return;
+		int status = GL_FALSE, length = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (!status || length <= 0)
+			return;
+
+		Entry& entry = s_Entries[key];
+		GLenum format = 0;
+		entry.binary.resize(length);
+		glGetProgramBinary(program, length, nullptr, &format, entry.binary.data());
+		entry.format = format;
+		entry.used = true;
+		s_Dirty = true;
+	}
+
+	void ProgramCache::record(const bool loaded, const float milliseconds) {
+		if (loaded) {
+			s_Statistics.loaded++;
+			s_Statistics.loadMilliseconds += milliseconds;
+		} else {
+			s_Statistics.compiled++;
+			s_Statistics.compileMilliseconds += milliseconds;
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace Pressure {
+
+	// Linked programs kept on disk through glProgramBinary, so later runs skip compiling and linking them.
+	// Entries are keyed by a hash of the sources, the defines of a variant are part of its source, so an edited
+	// shader simply misses. The file belongs to one driver, another vendor, renderer or version discards all of it.
+	class ProgramCache {
+
+	public:
+		// Programs Shader created since init(), with the time it took including the uniform lookups.
+		struct Statistics {
+			unsigned int loaded = 0;
+			unsigned int compiled = 0;
+			float loadMilliseconds = 0;
+			float compileMilliseconds = 0;
+		};
+
+	private:
+		struct Entry {
+			unsigned int format;
+			std::vector<char> binary;
+			// Asked for by this run, save() can drop the others.
+			bool used;
+		};
+
+		const static uint32_t MAGIC;
+
+		static std::string s_FileName;
+		static std::string s_Driver;
+		static bool s_Supported;
+		static bool s_Dirty;
+		static std::unordered_map<uint64_t, Entry> s_Entries;
+		static Statistics s_Statistics;
+
+	public:
+		ProgramCache() = delete;
+
+		// Reads the file the shaderCache property names. Needs a current context.
+		static void init();
+		// Writes the cache back if it changed. Dropping the entries this run did not use keeps edited shaders from piling up,
+		// but only makes sense once every program that will be used has been.
+		static void save(const bool dropUnused = false);
+
+		static uint64_t getKey(const std::string& vertexShader, const std::string& geometryShader, const std::string& fragmentShader);
+		// Puts the binary stored under key into program, false if there is none or the driver rejects it.
+		static bool load(const unsigned int program, const uint64_t key);
+		// Call before linking a program that is going to be stored.
+		static void prepare(const unsigned int program);
+		static void store(const unsigned int program, const uint64_t key);
+
+		static void record(const bool loaded, const float milliseconds);
+		inline static const Statistics& getStatistics() { return s_Statistics; }
+
+	};
+
+}
\ No newline at end of file
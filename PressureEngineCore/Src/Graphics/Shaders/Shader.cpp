@@ -1,52 +1,127 @@
 #include "Shader.h"
+#include <chrono>
+#include <algorithm>
+#include "../GLObjects/GLState.h"
+#include "FrameUniforms.h"
+#include "ProgramCache.h"
+
+// Not part of every glad build, same value for the ARB extension.
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
 
 namespace Pressure {
 
+	bool Shader::s_ParallelCompile = false;
+	std::vector<Shader*> Shader::s_Pending;
+
+	Shader::~Shader() {
+		removePending();
+	}
+
 	void Shader::loadShaders(const std::string& vertexShader, const std::string& fragmentShader) {
-		m_VertexShaderID = loadShader(vertexShader, GL_VERTEX_SHADER);
-		m_GeometryShaderID = 0;
-		m_FragmentShaderID = loadShader(fragmentShader, GL_FRAGMENT_SHADER);
-		m_ProgramID = glCreateProgram();
-		glAttachShader(m_ProgramID, m_VertexShaderID);
-		glAttachShader(m_ProgramID, m_FragmentShaderID);
-		bindAttributes();
-		glLinkProgram(m_ProgramID);
-		glValidateProgram(m_ProgramID);
-		getAllUniformLocations();
+		loadProgram(vertexShader, std::string(), fragmentShader);
 	}
 
 	void Shader::loadShaders(const std::string& vertexShader, const std::string& geometryShader, const std::string& fragmentShader) {
 		if (strcmp((const char*)glGetString(GL_VENDOR), "Intel") == 0) { // Can't run geometry shader on intel.	
 			return loadShaders(vertexShader, fragmentShader);
 		}
-		m_VertexShaderID = loadShader(vertexShader, GL_VERTEX_SHADER);
-		m_GeometryShaderID = loadShader(geometryShader, GL_GEOMETRY_SHADER);
-		m_FragmentShaderID = loadShader(fragmentShader, GL_FRAGMENT_SHADER);
+		loadProgram(vertexShader, geometryShader, fragmentShader);
+	}
+
+	void Shader::initParallelCompile() {
+		if (!glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+			return;
+		s_ParallelCompile = true;
+		typedef void (APIENTRY* MaxShaderCompilerThreadsProc)(GLuint count);
+		MaxShaderCompilerThreadsProc maxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+		// All ones leaves the number of threads to the driver.
+		if (maxShaderCompilerThreads)
+			maxShaderCompilerThreads(0xFFFFFFFF);
+	}
+
+	void Shader::loadProgram(const std::string& vertexShader, const std::string& geometryShader, const std::string& fragmentShader) {
+		const auto start = std::chrono::steady_clock::now();
+		m_Key = ProgramCache::getKey(vertexShader, geometryShader, fragmentShader);
+		m_VertexShaderID = 0;
+		m_GeometryShaderID = 0;
+		m_FragmentShaderID = 0;
+		m_Resolved = false;
 		m_ProgramID = glCreateProgram();
-		glAttachShader(m_ProgramID, m_VertexShaderID);
-		glAttachShader(m_ProgramID, m_GeometryShaderID);
-		glAttachShader(m_ProgramID, m_FragmentShaderID);
-		bindAttributes();
-		glLinkProgram(m_ProgramID);
+		m_Cached = ProgramCache::load(m_ProgramID, m_Key);
+		if (!m_Cached) {
+			m_VertexShaderID = loadShader(vertexShader, GL_VERTEX_SHADER);
+			if (!geometryShader.empty())
+				m_GeometryShaderID = loadShader(geometryShader, GL_GEOMETRY_SHADER);
+			m_FragmentShaderID = loadShader(fragmentShader, GL_FRAGMENT_SHADER);
+			glAttachShader(m_ProgramID, m_VertexShaderID);
+			if (m_GeometryShaderID)
+				glAttachShader(m_ProgramID, m_GeometryShaderID);
+			glAttachShader(m_ProgramID, m_FragmentShaderID);
+			bindAttributes();
+			ProgramCache::prepare(m_ProgramID);
+			glLinkProgram(m_ProgramID);
+			if (s_ParallelCompile)
+				s_Pending.push_back(this);
+		}
+		m_SubmitMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void Shader::resolveCompleted() {
+		// Resolving removes from the list, so it is walked on a copy.
+		const std::vector<Shader*> pending = s_Pending;
+		for (Shader* shader : pending) {
+			int completed = GL_FALSE;
+			glGetProgramiv(shader->m_ProgramID, GL_COMPLETION_STATUS_KHR, &completed);
+			if (!completed)
+				continue;
+			GLState::useProgram(shader->m_ProgramID);
+			shader->resolve();
+		}
+	}
+
+	void Shader::resolve() {
+		const auto start = std::chrono::steady_clock::now();
+		m_Resolved = true;
+		removePending();
+		if (!m_Cached) {
+			// Blocks until the link is done, unless resolveCompleted() got here first.
+			int status = GL_FALSE;
+			glGetProgramiv(m_ProgramID, GL_LINK_STATUS, &status);
+			if (status)
+				ProgramCache::store(m_ProgramID, m_Key);
+			else
+				logErrors();
+		}
 		glValidateProgram(m_ProgramID);
+		FrameUniforms::bindBlocks(m_ProgramID);
 		getAllUniformLocations();
+		connectTextureUnits();
+		ProgramCache::record(m_Cached, m_SubmitMilliseconds + std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
 	}
 
 	void Shader::start() {
-		glUseProgram(m_ProgramID);
+		GLState::useProgram(m_ProgramID);
+		if (!m_Resolved)
+			resolve();
 	}
 
-	void Shader::stop() {
-		glUseProgram(0);
+	void Shader::removePending() {
+		s_Pending.erase(std::remove(s_Pending.begin(), s_Pending.end(), this), s_Pending.end());
 	}
 
 	void Shader::cleanUp() {
-		stop();
-		glDetachShader(m_ProgramID, m_VertexShaderID);
-		glDetachShader(m_ProgramID, m_FragmentShaderID);
-		glDeleteShader(m_VertexShaderID);
-		glDeleteShader(m_FragmentShaderID);
-		glDeleteProgram(m_ProgramID);
+		removePending();
+		GLState::useProgram(0);
+		// A program loaded from ProgramCache has no shader objects.
+		for (unsigned int shader : { m_VertexShaderID, m_GeometryShaderID, m_FragmentShaderID }) {
+			if (shader) {
+				glDetachShader(m_ProgramID, shader);
+				glDeleteShader(shader);
+			}
+		}
+		GLState::deleteProgram(m_ProgramID);
 	}
 
 	void Shader::bindAttribute(int attribute, const char* variableName) {
@@ -85,29 +160,45 @@ namespace Pressure {
 		glUniform1i(location, value);
 	}
 
+	std::string Shader::addDefines(const std::string& source, const std::string& defines) {
+		const size_t line = source.find('\n') + 1;
+		return source.substr(0, line) + defines + source.substr(line);
+	}
+
 	unsigned int Shader::loadShader(const std::string& shader, GLenum type) {
 		unsigned int shaderID = glCreateShader(type);
 
 		const char* shaderSrc = shader.c_str();
 
-		int result = GL_FALSE;
-		int logLength;
-
-		// Compile Shader
+		// Compile Shader, the result is only checked by resolve() so the driver is not waited for here.
 		glShaderSource(shaderID, 1, &shaderSrc, NULL);
 		glCompileShader(shaderID);
 
-		//Check Shader
-		glGetShaderiv(shaderID, GL_COMPILE_STATUS, &result);
-		if (!result) {
-			glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &logLength);
-			std::vector<GLchar> shaderError((logLength > 1) ? logLength : 1);
-			glGetShaderInfoLog(shaderID, logLength, NULL, &shaderError[0]);
-			PRESSURE_LOG(LOG_ERROR, std::string(&shaderError[0]));
-		}
-
 		return shaderID;
 	}
 
-}
+	void Shader::logErrors() const {
+		int result = GL_FALSE;
+		int logLength;
+
+		//Check Shaders
+		for (unsigned int shaderID : { m_VertexShaderID, m_GeometryShaderID, m_FragmentShaderID }) {
+			if (!shaderID)
+				continue;
+			glGetShaderiv(shaderID, GL_COMPILE_STATUS, &result);
+			if (!result) {
+				glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &logLength);
+				std::vector<GLchar> shaderError((logLength > 1) ? logLength : 1);
+				glGetShaderInfoLog(shaderID, logLength, NULL, &shaderError[0]);
+				PRESSURE_LOG(LOG_ERROR, std::string(&shaderError[0]));
+			}
+		}
+
+		//Check Program
+		glGetProgramiv(m_ProgramID, GL_INFO_LOG_LENGTH, &logLength);
+		std::vector<GLchar> programError((logLength > 1) ? logLength : 1);
+		glGetProgramInfoLog(m_ProgramID, logLength, NULL, &programError[0]);
+		PRESSURE_LOG(LOG_ERROR, std::string(&programError[0]));
+	}
 
+}
\ No newline at end of file
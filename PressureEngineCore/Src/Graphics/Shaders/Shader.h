@@ -1,8 +1,13 @@
 #pragma once
+#include <cstdint>
+#include <vector>
 #include "../../Common.h"
 
 namespace Pressure {
 
+	// loadShaders() only hands the sources to the driver. Link status and uniform locations are only asked for by the
+	// first start(), so nothing waits for the link before then. Whether the driver compiles in the meantime is up to it,
+	// GL_KHR_parallel_shader_compile asks for it, without the extension it may just as well compile in loadShaders().
 	class Shader {
 
 	private:
@@ -11,16 +16,47 @@ namespace Pressure {
 		unsigned int m_GeometryShaderID;
 		unsigned int m_FragmentShaderID;
 
+		bool m_Resolved;
+		// Loaded from ProgramCache rather than compiled.
+		bool m_Cached;
+		uint64_t m_Key;
+		// Time loadShaders() took, resolve() adds its own before reporting it to ProgramCache.
+		float m_SubmitMilliseconds;
+
+		// Whether GL_KHR_parallel_shader_compile lets the link be polled without waiting for it.
+		static bool s_ParallelCompile;
+		// Compiled shaders not resolved yet, checked by resolveCompleted().
+		static std::vector<Shader*> s_Pending;
+
 	public:
+		virtual ~Shader();
+
 		void loadShaders(const std::string& vertexShader, const std::string& fragmentShader);
 		void loadShaders(const std::string& vertexShader, const std::string& geometryShader, const std::string& fragmentShader);		
 
+		// Lets the driver compile on several threads through GL_KHR_parallel_shader_compile, where it is supported.
+		// Call once after the context is created.
+		static void initParallelCompile();
+		// Resolves every program the driver reports as done through GL_COMPLETION_STATUS_KHR, without waiting for the rest.
+		// Call once per frame. A program still compiling at its first start() is waited for there.
+		static void resolveCompleted();
+
 	private:
+		// Takes the program from ProgramCache when it has it, otherwise starts compiling it. Skips the geometry stage if it is empty.
+		void loadProgram(const std::string& vertexShader, const std::string& geometryShader, const std::string& fragmentShader);
 		unsigned int loadShader(const std::string& shader, GLenum type);
+		// Waits for the link, stores the program in ProgramCache and looks up the uniforms. Needs the program bound.
+		void resolve();
+		void removePending();
+		void logErrors() const;
+
+	protected:
+		// Inserts #define lines right after the #version line, to compile a variant of the source.
+		static std::string addDefines(const std::string& source, const std::string& defines);
 
 	public:
+		// Leaves the program bound afterwards, every draw starts its own shader first.
 		void start();
-		void stop();
 		void cleanUp();
 
 	protected:
@@ -29,6 +65,8 @@ namespace Pressure {
 
 		virtual void getAllUniformLocations() = 0;
 		int getUniformLocation(const char* uniformName);
+		// Called once with the program bound, after the uniform locations are known.
+		virtual void connectTextureUnits() {}
 
 		void loadFloat(const int location, const float value);
 		void loadVector(const int location, const Vector2f& value);
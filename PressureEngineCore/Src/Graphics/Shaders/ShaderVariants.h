@@ -0,0 +1,33 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+
+namespace Pressure {
+
+	// Variants of a shader compiled from one source with different #defines, keyed by a mask of the features they were built with.
+	// T is constructed from that mask, each variant is compiled the first time it is asked for.
+	template <typename T>
+	class ShaderVariants {
+
+	private:
+		std::unordered_map<unsigned int, std::unique_ptr<T>> m_Variants;
+
+	public:
+		T& get(const unsigned int features) {
+			auto it = m_Variants.find(features);
+			if (it == m_Variants.end())
+				it = m_Variants.emplace(features, std::make_unique<T>(features)).first;
+			return *it->second;
+		}
+
+		inline unsigned int size() const { return m_Variants.size(); }
+
+		void cleanUp() {
+			for (auto& variant : m_Variants)
+				variant.second->cleanUp();
+			m_Variants.clear();
+		}
+
+	};
+
+}
\ No newline at end of file
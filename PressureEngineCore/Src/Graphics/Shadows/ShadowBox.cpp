@@ -1,4 +1,6 @@
 #include "ShadowBox.h"
+#include <algorithm>
+#include <cmath>
 #include "../../Constants.h"
 #include "../../Services/Properties.h"
 
@@ -7,117 +9,84 @@ namespace Pressure {
 	const float ShadowBox::OFFSET = 10;
 	const Vector4f ShadowBox::UP(0, 1, 0, 0);
 	const Vector4f ShadowBox::FORWARD(0, 0, -1, 0);
+	const float ShadowBox::GUARD_BAND = 0.1f;
 
-	ShadowBox::ShadowBox(Matrix4f& lightViewMatrix, Camera& camera, Window& window)
-		: m_ShadowDistance(150), m_LightViewMatrix(lightViewMatrix), m_Camera(camera), m_Window(window) {
-		calculateWidthsAndHeights();
+	ShadowBox::ShadowBox(Camera& camera, Window& window)
+		: m_Camera(camera), m_Window(window), m_NearDistance(PRESSURE_NEAR_PLANE), m_FarDistance(150), m_Radius(0), m_Moved(false) {
 	}
 
-	void ShadowBox::tick() {
+	void ShadowBox::setRange(const float nearDistance, const float farDistance) {
+		m_NearDistance = nearDistance;
+		m_FarDistance = farDistance;
+	}
+
+	void ShadowBox::tick(const Matrix4f& lightRotation, const unsigned int shadowMapSize, const bool lightChanged) {
 		Matrix4f rotation;
 		calculateCameraRotationMatrix(rotation);
-		Vector3f forwardVector(rotation.transform(FORWARD, Vector4f()).getXYZ());
-
-		Vector3f toFar(forwardVector);
-		toFar.mul(m_ShadowDistance);
-		Vector3f toNear(forwardVector);
-		toNear.mul(PRESSURE_NEAR_PLANE);
-		Vector3f centerNear;
-		toNear.add(m_Camera.getPosition(), centerNear);
-		Vector3f centerFar;
-		toFar.add(m_Camera.getPosition(), centerFar);
-
-		std::vector<Vector4f> points;
-		calculateFrustumVertices(points, rotation, forwardVector, centerNear, centerFar);
-
-		bool first = true;
-		for (auto& point : points) {
-			if (first) {
-				m_MinX = point.x;
-				m_MaxX = point.x;
-				m_MinY = point.y;
-				m_MaxY = point.y;
-				m_MinZ = point.z;
-				m_MaxZ = point.z;
-				first = false;
-				continue;
+		Vector4f forward4, up4;
+		rotation.transform(FORWARD, forward4);
+		rotation.transform(UP, up4);
+		Vector3f forward(forward4.getXYZ());
+		Vector3f up(up4.getXYZ());
+		Vector3f right;
+		forward.cross(up, right);
+
+		// Corners of the slice in world space.
+		Vector3f corners[8];
+		float tanHalfFov = std::tan((float)Math::toRadians(std::stof(Properties::get("fov")) / 2.f));
+		float aspectRatio = getAspectRatio();
+		Vector3f sliceCenter;
+		for (int i = 0; i < 2; i++) {
+			float distance = i == 0 ? m_NearDistance : m_FarDistance;
+			float height = distance * tanHalfFov;
+			float width = height * aspectRatio;
+			Vector3f center(m_Camera.getPosition());
+			center.add(forward.x * distance, forward.y * distance, forward.z * distance);
+			for (int j = 0; j < 4; j++) {
+				float x = j & 1 ? width : -width;
+				float y = j & 2 ? height : -height;
+				corners[i * 4 + j].set(center.x + right.x * x + up.x * y, center.y + right.y * x + up.y * y, center.z + right.z * x + up.z * y);
+				sliceCenter.add(corners[i * 4 + j]);
 			}
-			if (point.x > m_MaxX)
-				m_MaxX = point.x;
-			else if (point.x < m_MinX)
-				m_MinX = point.x;
-			if (point.y > m_MaxY) 
-				m_MaxY = point.y;
-			else if (point.y < m_MinY) 
-				m_MinY = point.y;
-			if (point.z > m_MaxZ) 
-				m_MaxZ = point.z;
-			else if (point.z < m_MinZ) 
-				m_MinZ = point.z;
 		}
+		sliceCenter.div(8);
 
-		m_MaxZ += OFFSET;
-	}
-
-	Vector3f ShadowBox::getCenter() {
-		Vector4f cen((m_MinX + m_MaxX) / 2, (m_MinY + m_MaxY) / 2, (m_MinZ + m_MaxZ) / 2, 1);
-		Matrix4f invertedLight;
-		m_LightViewMatrix.invert(invertedLight);
-		return invertedLight.transform(cen, Vector4f()).getXYZ();
-	}
-
-	void ShadowBox::setShadowDistance(float distance) {
-		if (distance != m_ShadowDistance) {
-			m_ShadowDistance = distance;
-			calculateWidthsAndHeights();
+		float sliceRadius = 0;
+		for (const Vector3f& corner : corners) {
+			float dx = corner.x - sliceCenter.x, dy = corner.y - sliceCenter.y, dz = corner.z - sliceCenter.z;
+			sliceRadius = std::max(sliceRadius, std::sqrt(dx * dx + dy * dy + dz * dz));
 		}
-	}
-
-	float ShadowBox::getWidth() const {
-		return m_MaxX - m_MinX;
-	}
-
-	float ShadowBox::getHeight() const {
-		return m_MaxY - m_MinY;
-	}
-
-	float ShadowBox::getLength() const {
-		return m_MaxZ - m_MinZ;
-	}
-
-	float ShadowBox::getShadowDistance() const {
-		return m_ShadowDistance;
-	}
-
-	void ShadowBox::calculateFrustumVertices(std::vector<Vector4f>& points, Matrix4f& rotation, Vector3f& forwardVector, Vector3f& centerNear, Vector3f& centerFar) {
-		Vector3f upVector(rotation.transform(UP, Vector4f()).getXYZ());
-		Vector3f rightVector(forwardVector.cross(upVector, Vector3f()));
-		Vector3f downVector;
-		upVector.negate(downVector);
-		Vector3f leftVector;
-		rightVector.negate(leftVector);
-		Vector3f farTop(Vector3f(upVector.x * m_FarHeight,
-			upVector.y * m_FarHeight, upVector.z * m_FarHeight).add(centerFar));
-		Vector3f farBottom(Vector3f(downVector.x * m_FarHeight,
-			downVector.y * m_FarHeight, downVector.z * m_FarHeight).add(centerFar));
-		Vector3f nearTop(Vector3f(upVector.x * m_NearHeight,
-			upVector.y * m_NearHeight, upVector.z * m_NearHeight).add(centerNear));
-		Vector3f nearBottom(Vector3f(downVector.x * m_NearHeight,
-			downVector.y * m_NearHeight, downVector.z * m_NearHeight).add(centerNear));
-		points.resize(8);
-		calculateLightSpaceFrustumCorner(points[0], farTop, rightVector, m_FarWidth);
-		calculateLightSpaceFrustumCorner(points[1], farTop, leftVector, m_FarWidth);
-		calculateLightSpaceFrustumCorner(points[2], farBottom, rightVector, m_FarWidth);
-		calculateLightSpaceFrustumCorner(points[3], farBottom, leftVector, m_FarWidth);
-		calculateLightSpaceFrustumCorner(points[4], nearTop, rightVector, m_NearWidth);
-		calculateLightSpaceFrustumCorner(points[5], nearTop, leftVector, m_NearWidth);
-		calculateLightSpaceFrustumCorner(points[6], nearBottom, rightVector, m_NearWidth);
-		calculateLightSpaceFrustumCorner(points[7], nearBottom, leftVector, m_NearWidth);
-	}
-
-	void ShadowBox::calculateLightSpaceFrustumCorner(Vector4f& point, Vector3f& startPoint, Vector3f& direction, float width) {
-		point.set(startPoint.add(direction.x * width, direction.y * width, direction.z * width, Vector3f()), 1.f);
-		m_LightViewMatrix.transform(point, point);
+		// Only resized when the slice outgrows the box or shrinks well below it, so float noise in the corners
+		// can not make the texel size flip between frames.
+		float radius = std::ceil(sliceRadius * (1.f + GUARD_BAND) * 16.f) / 16.f;
+		bool resized = radius > m_Radius || radius < m_Radius * (1.f - GUARD_BAND);
+		if (!resized)
+			radius = m_Radius;
+		float texelSize = 2.f * radius / shadowMapSize;
+
+		Vector4f lightCenter;
+		lightRotation.transform(Vector4f(sliceCenter, 1.f), lightCenter);
+
+		// The slice stays inside the box as long as it drifts less than the padding minus the snapping error.
+		float dx = lightCenter.x - m_Center.x, dy = lightCenter.y - m_Center.y, dz = lightCenter.z - m_Center.z;
+		float drift = radius - sliceRadius - texelSize;
+		m_Moved = lightChanged || resized || dx * dx + dy * dy + dz * dz > drift * drift;
+		if (!m_Moved)
+			return;
+
+		m_Radius = radius;
+		m_Center.set(std::floor(lightCenter.x / texelSize) * texelSize, std::floor(lightCenter.y / texelSize) * texelSize, lightCenter.z);
+
+		m_LightViewMatrix.identity();
+		m_LightViewMatrix.translate(Vector3f(-m_Center.x, -m_Center.y, -m_Center.z));
+		m_LightViewMatrix.mul(lightRotation);
+
+		// Extends a bit toward the light, casters further out are flattened onto the near plane by depth clamping.
+		m_ProjectionMatrix.identity();
+		m_ProjectionMatrix.set(0, 0, 1.f / m_Radius);
+		m_ProjectionMatrix.set(1, 1, 1.f / m_Radius);
+		m_ProjectionMatrix.set(2, 2, -1.f / (m_Radius + OFFSET));
+		m_ProjectionMatrix.mul(m_LightViewMatrix, m_ProjectionViewMatrix);
 	}
 
 	void ShadowBox::calculateCameraRotationMatrix(Matrix4f& matrix) {		
@@ -125,16 +94,8 @@ namespace Pressure {
 		matrix.rotate((float) Math::toRadians(-m_Camera.getPitch()), Vector3f(1, 0, 0));
 	}
 
-	void ShadowBox::calculateWidthsAndHeights() {
-		m_FarWidth = (float) (m_ShadowDistance * std::tan(Math::toRadians(std::stof(Properties::get("fov")))));
-		m_NearWidth = (float) (PRESSURE_NEAR_PLANE * std::tan(Math::toRadians(std::stof(Properties::get("fov")))));
-		m_FarHeight = m_FarWidth / getAspectRatio();
-		m_NearHeight = m_NearWidth / getAspectRatio();
-	}
-
 	float ShadowBox::getAspectRatio() {
 		return (float) m_Window.getWidth() / (float) m_Window.getHeight();
-		//return 16 / 9;
 	}
 
 }
\ No newline at end of file
@@ -5,38 +5,52 @@
 
 namespace Pressure {
 
+	// Orthographic light-space box around one slice of the view frustum, one per shadow cascade.
+	// The box is sized by the bounding sphere of the slice, so it keeps its size when the camera turns,
+	// and its position is snapped to whole shadow map texels, so shadows do not shimmer when the camera moves.
+	// It is padded by a guard band and only moves once the slice drifts out of it, so cached shadows stay valid in between.
 	class ShadowBox {
 
 	private:
 		static const float OFFSET;
 		static const Vector4f UP;
 		static const Vector4f FORWARD;
+		// Padding as a fraction of the slice radius.
+		static const float GUARD_BAND;
 
-		float m_ShadowDistance;
-		float m_MinX, m_MaxX;
-		float m_MinY, m_MaxY;
-		float m_MinZ, m_MaxZ;
-		Matrix4f& m_LightViewMatrix;
 		Camera& m_Camera;
 		Window& m_Window;
-		float m_FarHeight, m_FarWidth, m_NearHeight, m_NearWidth;
 
-	public:
-		ShadowBox(Matrix4f& lightViewMatrix, Camera& camera, Window& window);
-		void tick();
-		Vector3f getCenter();
-		void setShadowDistance(float distance);
+		float m_NearDistance;
+		float m_FarDistance;
+		float m_Radius;
+		// Snapped center in light space.
+		Vector3f m_Center;
+		bool m_Moved;
+
+		Matrix4f m_LightViewMatrix;
+		Matrix4f m_ProjectionMatrix;
+		Matrix4f m_ProjectionViewMatrix;
 
-		float getWidth() const;
-		float getHeight() const;
-		float getLength() const;
-		float getShadowDistance() const;
+	public:
+		ShadowBox(Camera& camera, Window& window);
+
+		// Distances along the view direction covered by the box.
+		void setRange(const float nearDistance, const float farDistance);
+		// Fits the box around the slice if it left the guard band, lightRotation has to rotate world space into light space.
+		// A changed light rotation always refits the box.
+		void tick(const Matrix4f& lightRotation, const unsigned int shadowMapSize, const bool lightChanged);
+		// Whether the last tick() moved or resized the box.
+		inline bool hasMoved() const { return m_Moved; }
+
+		inline Matrix4f& getLightViewMatrix() { return m_LightViewMatrix; }
+		inline Matrix4f& getProjectionMatrix() { return m_ProjectionMatrix; }
+		inline Matrix4f& getProjectionViewMatrix() { return m_ProjectionViewMatrix; }
+		inline float getNearDistance() const { return m_NearDistance; }
+		inline float getFarDistance() const { return m_FarDistance; }
 
 	private:
-		void calculateFrustumVertices(std::vector<Vector4f>& points, Matrix4f& rotation, Vector3f& forwardVector, Vector3f& centerNear, Vector3f& centerFar);
-		void calculateLightSpaceFrustumCorner(Vector4f& point, Vector3f& startPoint, Vector3f& direction, float width);
 		void calculateCameraRotationMatrix(Matrix4f& matrix);
-		void calculateWidthsAndHeights();
 		float getAspectRatio();
 
 	};
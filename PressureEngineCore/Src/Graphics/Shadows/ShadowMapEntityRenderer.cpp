@@ -1,34 +1,130 @@
 #include "ShadowMapEntityRenderer.h"
-#include "../MasterRenderer.h"
+#include "../../Services/Properties.h"
 
 namespace Pressure {
 
-	ShadowMapEntityRenderer::ShadowMapEntityRenderer(ShadowShader& shader, Matrix4f& projectionViewMatrix) 
-		: m_Shader(shader), m_ProjectionViewMatrix(projectionViewMatrix) {		
-	}
-
-	void ShadowMapEntityRenderer::render(const std::unordered_map<TexturedModel, std::vector<Entity>>& entities) {
-		MasterRenderer::enableFrontFaceCulling();
-		for (const auto& model : entities) {
-			model.first.getRawModel().getVertexArray().bind();
-			glEnableVertexAttribArray(0);
-			if (model.first.getTexture().hasTransparency())
-				MasterRenderer::disableCulling();
-			for (const auto& entity : model.second) {
-				prepareInstance(entity);
-				glDrawElements(GL_TRIANGLES, model.first.getRawModel().getVertexCount(), GL_UNSIGNED_INT, 0);
-			}
-			if (model.first.getTexture().hasTransparency())
-				MasterRenderer::enableFrontFaceCulling();
+	ShadowMapEntityRenderer::ShadowMapEntityRenderer(ShadowShader& shader, EntityInstanceBuffer& instances, const unsigned int viewCount, const bool multiDraw) 
+		: m_Shader(shader), m_Instances(instances), m_Views(viewCount), m_LodBias(std::stof(Properties::get("lodShadowBias"))), m_MultiDraw(multiDraw) {		
+	}
+
+	unsigned int ShadowMapEntityRenderer::prepare(const Scene& scene, const std::vector<SceneEntry>& casters, const Matrix4f& projectionViewMatrix, const unsigned int view) {
+		const std::vector<SceneBatch>& batches = scene.getBatches();
+		ViewData& data = m_Views[view];
+		data.projectionViewMatrix = projectionViewMatrix;
+		data.queue.clear();
+		// The projection is orthographic, so the screen size is the radius times the scale of the box's x axis.
+		const Matrix4f& m = projectionViewMatrix;
+		const float lodScale = m_LodBias * std::sqrt(m.get(0, 0) * m.get(0, 0) + m.get(1, 0) * m.get(1, 0) + m.get(2, 0) * m.get(2, 0));
+		for (const SceneEntry& visible : casters) {
+			const SceneBatch& batch = batches[visible.batch];
+			const TexturedModel& model = batch.model;
+			unsigned int lod = model.selectLod(batch.radius[visible.entry] * lodScale);
+			data.queue.push(RenderQueue::makeKey(RenderQueue::PASS_SHADOW, model.getTexture().hasTransparency(), 0, model.getTexture().getID(),
+				model.getRawModel().getMeshID() * RawModel::MAX_LODS + lod, 0), visible.batch, visible.entry, lod);
+		}
+		data.queue.sort();
+
+		const unsigned int length = EntityInstanceBuffer::INSTANCE_DATA_LENGTH;
+		const std::vector<RenderQueue::Item>& items = data.queue.getItems();
+		data.instanceData.resize(items.size() * length);
+		for (unsigned int i = 0; i < items.size(); i++) {
+			const float* instance = &batches[items[i].batch].instanceData[items[i].entry * length];
+			std::copy(instance, instance + length, &data.instanceData[i * length]);
+		}
+		return items.size();
+	}
+
+	void ShadowMapEntityRenderer::record(const Scene& scene, const unsigned int view) {
+		ViewData& data = m_Views[view];
+		data.statistics = Statistics();
+		data.statistics.casters = data.queue.getItems().size();
+		data.list.clear();
+		data.list.cullFace(GL_FRONT);
+		if (m_MultiDraw)
+			recordIndirect(data, scene.getBatches());
+		else
+			recordBatches(data, scene.getBatches());
+		data.list.cullFace(GL_BACK);
+		data.list.bindVertexArray(nullptr);
+	}
+
+	void ShadowMapEntityRenderer::render(const unsigned int view) {
+		m_Shader.loadProjectionViewMatrix(m_Views[view].projectionViewMatrix);
+		m_Views[view].list.replay(*this);
+		m_Statistics = m_Views[view].statistics;
+	}
+
+	void ShadowMapEntityRenderer::bindVertexArray(const VertexArray* vertexArray) {
+		if (vertexArray)
+			m_Instances.bind(*vertexArray);
+		else
+			GLState::bindVertexArray(0);
+	}
+
+	void ShadowMapEntityRenderer::uploadInstances(const float* instances, const unsigned int count) {
+		m_Instances.upload(instances, count);
+	}
+
+	void ShadowMapEntityRenderer::recordBatches(ViewData& data, const std::vector<SceneBatch>& batches) {
+		const unsigned int length = EntityInstanceBuffer::INSTANCE_DATA_LENGTH;
+		const std::vector<RenderQueue::Item>& items = data.queue.getItems();
+		bool cullingDisabled = false;
+		for (unsigned int i = 0; i < items.size();) {
+			const unsigned int first = i;
+			const SceneBatch& batch = batches[items[first].batch];
+			const unsigned int lod = items[first].lod;
+			while (i < items.size() && items[i].batch == items[first].batch && items[i].lod == lod)
+				i++;
+			data.list.uploadInstances(&data.instanceData[first * length], i - first);
+
+			recordModel(data, batch.model, cullingDisabled);
+			const RawModel& model = batch.model.getRawModel();
+			data.list.draw(model.getLodIndexCount(lod), model.getIndexType(), model.getLodFirstIndex(lod), i - first, model.getBaseVertex());
+			data.statistics.drawCalls++;
+			data.statistics.triangles += model.getLodIndexCount(lod) / 3 * (i - first);
+		}
+	}
+
+	void ShadowMapEntityRenderer::recordIndirect(ViewData& data, const std::vector<SceneBatch>& batches) {
+		const std::vector<RenderQueue::Item>& items = data.queue.getItems();
+		data.list.uploadInstances(data.instanceData.data(), items.size());
+
+		data.commands.clear();
+		data.segments.clear();
+		for (unsigned int i = 0; i < items.size();) {
+			const unsigned int first = i;
+			const SceneBatch& batch = batches[items[first].batch];
+			const unsigned int lod = items[first].lod;
+			while (i < items.size() && items[i].batch == items[first].batch && items[i].lod == lod)
+				i++;
+
+			const TexturedModel* previous = data.segments.empty() ? nullptr : &batches[data.segments.back().batch].model;
+			if (!previous || previous->getRawModel().getVertexArray().getID() != batch.model.getRawModel().getVertexArray().getID()
+				|| previous->getTexture().hasTransparency() != batch.model.getTexture().hasTransparency())
+				data.segments.push_back({ items[first].batch, data.commands.size(), 0 });
+			const RawModel& model = batch.model.getRawModel();
+			data.commands.push({ model.getLodIndexCount(lod), i - first, model.getLodFirstIndex(lod), model.getBaseVertex(), first });
+			data.segments.back().count++;
+			data.statistics.triangles += model.getLodIndexCount(lod) / 3 * (i - first);
+		}
+		if (data.segments.empty())
+			return;
+
+		data.list.uploadCommands(data.commands);
+		bool cullingDisabled = false;
+		for (const DrawSegment& segment : data.segments) {
+			recordModel(data, batches[segment.batch].model, cullingDisabled);
+			data.list.multiDraw(data.commands, segment.first, segment.count, batches[segment.batch].model.getRawModel().getIndexType());
+			data.statistics.drawCalls++;
 		}
-		MasterRenderer::enableCulling();
-		glDisableVertexAttribArray(0);
-		glBindVertexArray(0);
 	}
 
-	void ShadowMapEntityRenderer::prepareInstance(const Entity& entity) {
-		Matrix4f modelMatrix = Matrix4f().createTransformationMatrix(entity.getPosition(), entity.getRotation(), entity.getScale());
-		m_Shader.loadMvpMatrix(m_ProjectionViewMatrix.mul(modelMatrix, Matrix4f()));	
+	void ShadowMapEntityRenderer::recordModel(ViewData& data, const TexturedModel& model, bool& cullingDisabled) {
+		data.list.bindVertexArray(&model.getRawModel().getVertexArray());
+		if (model.getTexture().hasTransparency() != cullingDisabled) {
+			data.list.cullFace(model.getTexture().hasTransparency() ? 0 : GL_FRONT);
+			cullingDisabled = model.getTexture().hasTransparency();
+		}
 	}
 
 }
\ No newline at end of file
@@ -2,24 +2,83 @@
 #include <glad/glad.h>
 #include "../../Math/Math.h"
 #include "ShadowShader.h"
-#include <unordered_map>
 #include "../Models/TexturedModel.h"
 #include "../Entities/Entity.h"
+#include "../EntityShaders/EntityInstanceBuffer.h"
+#include "../Scene/Scene.h"
+#include "../Scene/RenderQueue.h"
+#include "../GLObjects/CommandList.h"
 
 namespace Pressure {
 
-	class ShadowMapEntityRenderer {
+	// Draws the casters of the shadow views. Like EntityRenderer, each view is prepared and recorded into a CommandList
+	// without touching GL, so the views can be recorded at the same time, and replayed by render().
+	class ShadowMapEntityRenderer : public CommandList::Executor {
+
+	public:
+		// Work recorded for the view of the last render() call.
+		struct Statistics {
+			unsigned int drawCalls = 0;
+			unsigned int casters = 0;
+			unsigned int triangles = 0;
+		};
 
 	private:
+		// Consecutive indirect commands drawn by one multi-draw call.
+		struct DrawSegment {
+			unsigned int batch;
+			unsigned int first;
+			unsigned int count;
+		};
+
+		// Everything a view needs from prepare() to render().
+		struct ViewData {
+			Matrix4f projectionViewMatrix;
+			// Casters of the view grouped per batch.
+			RenderQueue queue;
+			std::vector<float> instanceData;
+			IndirectBuffer commands;
+			std::vector<DrawSegment> segments;
+			CommandList list;
+			Statistics statistics;
+		};
+
 		ShadowShader& m_Shader;
-		Matrix4f& m_ProjectionViewMatrix;
+		EntityInstanceBuffer& m_Instances;
+
+		std::vector<ViewData> m_Views;
+		Statistics m_Statistics;
+		// Scales the size of the casters in the shadow map, below 1 picks coarser levels of detail.
+		const float m_LodBias;
+
+		const bool m_MultiDraw;
 
 	public:
-		ShadowMapEntityRenderer(ShadowShader& shader, Matrix4f& projectionViewMatrix);
-		void render(const std::unordered_map<TexturedModel, std::vector<Entity>>& entities);
-		
+		ShadowMapEntityRenderer(ShadowShader& shader, EntityInstanceBuffer& instances, const unsigned int viewCount, const bool multiDraw);
+		// Queues the casters SceneVisibility found inside the light-space box of the view, returns how many there are.
+		// Their level of detail follows from how much of the box they cover.
+		unsigned int prepare(const Scene& scene, const std::vector<SceneEntry>& casters, const Matrix4f& projectionViewMatrix, const unsigned int view);
+		// Records the draws of the prepared view. Makes no GL calls and leaves the other views alone.
+		void record(const Scene& scene, const unsigned int view);
+		// Replays the recorded view with the shadow shader bound.
+		void render(const unsigned int view);
+
+		inline unsigned int getCasterCount(const unsigned int view) const { return m_Views[view].queue.getItems().size(); }
+		inline const Statistics& getStatistics() const { return m_Statistics; }
+
+		// Replay of the recorded commands, the shadow shader is the only program.
+		void bindProgram(const unsigned int program) override {}
+		void bindVertexArray(const VertexArray* vertexArray) override;
+		void bindTexture(const unsigned int texture) override {}
+		void loadMaterial(const float shineDamper, const float reflectivity) override {}
+		void uploadInstances(const float* instances, const unsigned int count) override;
+
 	private:
-		void prepareInstance(const Entity& entity);
+		void recordBatches(ViewData& data, const std::vector<SceneBatch>& batches);
+		// Casters only differ in their vertex array and whether back faces are culled, so a pass is a multi-draw or two.
+		void recordIndirect(ViewData& data, const std::vector<SceneBatch>& batches);
+		// Transparent casters like foliage need both sides.
+		void recordModel(ViewData& data, const TexturedModel& model, bool& cullingDisabled);
 
 	};
 
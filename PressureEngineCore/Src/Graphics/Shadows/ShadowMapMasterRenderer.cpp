@@ -1,79 +1,194 @@
 #include "ShadowMapMasterRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include "../../Constants.h"
+#include "../../Services/Properties.h"
 
 namespace Pressure {
 
-	const int ShadowMapMasterRenderer::SHADOW_MAP_SIZE = 8192; // Change in frag shader if changed here.
-
-	ShadowMapMasterRenderer::ShadowMapMasterRenderer(Camera& camera, Window& window)
-		: m_ShadowFbo(window, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 1, 1, FrameBuffer::DepthBufferType::TEXTURE), m_ShadowBox(m_LightViewMatrix, camera, window), m_EntityRenderer(m_Shader, m_ProjectionViewMatrix) {
-		//: shadowFbo(SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, window), shadowBox(lightViewMatrix, camera, window), entityRenderer(shader, projectionViewMatrix) {
+	const unsigned int ShadowMapMasterRenderer::MAX_CASCADES = 4;
+	const float ShadowMapMasterRenderer::SPLIT_LAMBDA = 0.5f;
+
+	ShadowMapMasterRenderer::ShadowMapMasterRenderer(Camera& camera, Window& window, EntityInstanceBuffer& instances, const bool multiDraw)
+		: m_Window(window), m_StaticVersion(0), m_ShadowDistance(150), m_EntityRenderer(m_Shader, instances, MAX_CASCADES * 2, multiDraw) {
+		m_CascadeCount = std::min(std::max(std::stoi(Properties::get("shadowCascades")), 1), (int)MAX_CASCADES);
+		m_ShadowMapSize = std::stoi(Properties::get("shadowMapSize"));
+		for (unsigned int i = 0; i < m_CascadeCount; i++)
+			m_Cascades.emplace_back(camera, window);
+		m_HasDynamicCasters.resize(m_CascadeCount, false);
+		m_StaticViews.resize(m_CascadeCount, SceneVisibility::NO_VIEW);
+		m_DynamicViews.resize(m_CascadeCount, SceneVisibility::NO_VIEW);
+		updateSplits();
+		createShadowMap(m_ShadowMapID, m_FrameBufferID);
+		createShadowMap(m_StaticShadowMapID, m_StaticFrameBufferID);
 		createOffset();
 	}
 
 	ShadowMapMasterRenderer::~ShadowMapMasterRenderer() {
 		m_Shader.cleanUp();
+		GLState::deleteFramebuffer(m_FrameBufferID);
+		GLState::deleteTexture(m_ShadowMapID);
+		GLState::deleteFramebuffer(m_StaticFrameBufferID);
+		GLState::deleteTexture(m_StaticShadowMapID);
+	}
+
+	void ShadowMapMasterRenderer::prepareViews(const Scene& scene, Light& sun, SceneVisibility& visibility) {
+		Vector3f lightDirection;
+		sun.getPosition().negate(lightDirection);
+		lightDirection.normalize();
+		// The zero vector never matches, so the first frame draws everything.
+		bool lightChanged = lightDirection != m_LightDirection;
+		if (lightChanged) {
+			m_LightDirection = lightDirection;
+			updateLightRotation(lightDirection);
+		}
+		bool staticChanged = scene.getStaticVersion() != m_StaticVersion || lightChanged;
+		m_StaticVersion = scene.getStaticVersion();
+
+		// Casters are culled against the sides and the far end of the light-space box. The box is open toward the light,
+		// so casters between the light and the box still shadow it. Depth clamping flattens them onto the near plane.
+		const unsigned int planeMask = ViewFrustum::ALL_PLANES & ~(1u << ViewFrustum::PLANE_NEAR);
+		for (unsigned int i = 0; i < m_CascadeCount; i++) {
+			m_Cascades[i].tick(m_LightRotation, m_ShadowMapSize, lightChanged);
+			const Matrix4f& projectionView = m_Cascades[i].getProjectionViewMatrix();
+			bool staticRendered = staticChanged || m_Cascades[i].hasMoved();
+			// A cascade whose static layer is kept this frame gets no static view.
+			m_StaticViews[i] = staticRendered ? visibility.addView(projectionView, planeMask, Scene::QUERY_STATIC) : SceneVisibility::NO_VIEW;
+			m_DynamicViews[i] = visibility.addView(projectionView, planeMask, Scene::QUERY_DYNAMIC);
+		}
+	}
+
+	void ShadowMapMasterRenderer::record(const Scene& scene, const SceneVisibility& visibility, const unsigned int view) {
+		const unsigned int cascade = view / 2;
+		const unsigned int sceneView = view % 2 ? m_DynamicViews[cascade] : m_StaticViews[cascade];
+		// Kept static layers have nothing to record, render() skips them.
+		if (sceneView == SceneVisibility::NO_VIEW)
+			return;
+		m_EntityRenderer.prepare(scene, visibility.getVisible(sceneView), m_Cascades[cascade].getProjectionViewMatrix(), view);
+		m_EntityRenderer.record(scene, view);
 	}
 
-	void ShadowMapMasterRenderer::render(std::unordered_map<TexturedModel, std::vector<Entity>>& entities, Light& sun) {
-		m_ShadowBox.tick();
-		prepare(sun.getPosition().negate(Vector3f()), m_ShadowBox);
-		m_EntityRenderer.render(entities);
+	void ShadowMapMasterRenderer::render() {
+		prepare();
+		m_Statistics = ShadowMapEntityRenderer::Statistics();
+		for (unsigned int i = 0; i < m_CascadeCount; i++) {
+			bool staticRendered = m_StaticViews[i] != SceneVisibility::NO_VIEW;
+			if (staticRendered) {
+				attachLayer(m_StaticFrameBufferID, m_StaticShadowMapID, i);
+				glClear(GL_DEPTH_BUFFER_BIT);
+				m_EntityRenderer.render(i * 2);
+				addStatistics();
+			}
+
+			// The layer already matches its static layer unless either changed since the last copy.
+			unsigned int dynamicCasters = m_DynamicViews[i] != SceneVisibility::NO_VIEW ? m_EntityRenderer.getCasterCount(i * 2 + 1) : 0;
+			if (staticRendered || dynamicCasters > 0 || m_HasDynamicCasters[i]) {
+				copyStaticLayer(i);
+				if (dynamicCasters > 0) {
+					m_EntityRenderer.render(i * 2 + 1);
+					addStatistics();
+				}
+			}
+			m_HasDynamicCasters[i] = dynamicCasters > 0;
+		}
 		finish();
 	}
 
-	Matrix4f ShadowMapMasterRenderer::getToShadowMapSpaceMatrix() {
-		return m_Offset.mul(m_ProjectionViewMatrix, Matrix4f());
+	Matrix4f ShadowMapMasterRenderer::getToShadowMapSpaceMatrix(const unsigned int cascade) {
+		return m_Offset.mul(m_Cascades[cascade].getProjectionViewMatrix(), Matrix4f());
+	}
+
+	float ShadowMapMasterRenderer::getCascadeDistance(const unsigned int cascade) const {
+		return m_Cascades[cascade].getFarDistance();
 	}
 
 	unsigned int ShadowMapMasterRenderer::getShadowMap() {
-		return m_ShadowFbo.getDepthTexture();
-		//return shadowFbo.getShadowMap();
+		return m_ShadowMapID;
 	}
 
 	float ShadowMapMasterRenderer::getShadowDistance() const {
-		return m_ShadowBox.getShadowDistance();
+		return m_ShadowDistance;
 	}
 
 	void ShadowMapMasterRenderer::setShadowDistance(float shadowDistance) {
-		m_ShadowBox.setShadowDistance(shadowDistance);
+		if (shadowDistance != m_ShadowDistance) {
+			m_ShadowDistance = shadowDistance;
+			updateSplits();
+		}
+	}
+
+	void ShadowMapMasterRenderer::createShadowMap(unsigned int& textureID, unsigned int& frameBufferID) {
+		glGenTextures(1, &textureID);
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32, m_ShadowMapSize, m_ShadowMapSize, m_CascadeCount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		// Depth only, the layer is attached per cascade while rendering.
+		glGenFramebuffers(1, &frameBufferID);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, frameBufferID);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, textureID, 0, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 	}
 
-	Matrix4f& ShadowMapMasterRenderer::getLightSpaceTransform() {
-		return m_LightViewMatrix;
+	void ShadowMapMasterRenderer::attachLayer(const unsigned int frameBufferID, const unsigned int textureID, const unsigned int layer) {
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, frameBufferID);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, textureID, 0, layer);
 	}
 
-	void ShadowMapMasterRenderer::prepare(Vector3f& lightDirection, ShadowBox& box) {
-		updateOrthoProjectionMatrix(box.getWidth(), box.getHeight(), box.getLength());
-		updateLightViewMatrix(lightDirection, box.getCenter());
-		m_ProjectionMatrix.mul(m_LightViewMatrix, m_ProjectionViewMatrix);
-		m_ShadowFbo.bind();
-		glEnable(GL_DEPTH_TEST);
-		glClear(GL_DEPTH_BUFFER_BIT);
+	void ShadowMapMasterRenderer::copyStaticLayer(const unsigned int layer) {
+		attachLayer(m_StaticFrameBufferID, m_StaticShadowMapID, layer);
+		attachLayer(m_FrameBufferID, m_ShadowMapID, layer);
+		GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, m_StaticFrameBufferID);
+		glBlitFramebuffer(0, 0, m_ShadowMapSize, m_ShadowMapSize, 0, 0, m_ShadowMapSize, m_ShadowMapSize, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, m_FrameBufferID);
+	}
+
+	void ShadowMapMasterRenderer::addStatistics() {
+		m_Statistics.drawCalls += m_EntityRenderer.getStatistics().drawCalls;
+		m_Statistics.casters += m_EntityRenderer.getStatistics().casters;
+		m_Statistics.triangles += m_EntityRenderer.getStatistics().triangles;
+	}
+
+	void ShadowMapMasterRenderer::updateSplits() {
+		float nearDistance = PRESSURE_NEAR_PLANE;
+		for (unsigned int i = 0; i < m_CascadeCount; i++) {
+			float fraction = (float)(i + 1) / m_CascadeCount;
+			float logarithmic = PRESSURE_NEAR_PLANE * std::pow(m_ShadowDistance / PRESSURE_NEAR_PLANE, fraction);
+			float uniform = PRESSURE_NEAR_PLANE + (m_ShadowDistance - PRESSURE_NEAR_PLANE) * fraction;
+			float farDistance = SPLIT_LAMBDA * logarithmic + (1 - SPLIT_LAMBDA) * uniform;
+			m_Cascades[i].setRange(nearDistance, farDistance);
+			nearDistance = farDistance;
+		}
+	}
+
+	void ShadowMapMasterRenderer::prepare() {
+		glViewport(0, 0, m_ShadowMapSize, m_ShadowMapSize);
+		GLState::enable(GL_DEPTH_TEST);
+		// Casters in front of the near plane are kept at depth 0 instead of being clipped.
+		GLState::enable(GL_DEPTH_CLAMP);
 		m_Shader.start();
 	}
 
 	void ShadowMapMasterRenderer::finish() {
-		m_Shader.stop();
-		m_ShadowFbo.unbind();
+		GLState::disable(GL_DEPTH_CLAMP);
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, m_Window.getWidth(), m_Window.getHeight());
 	}
 
-	void ShadowMapMasterRenderer::updateLightViewMatrix(Vector3f& direction, Vector3f& center) {		
+	void ShadowMapMasterRenderer::updateLightRotation(Vector3f& direction) {		
 		direction.normalize();
-		center.negate();
-		m_LightViewMatrix.identity();
+		m_LightRotation.identity();
  		float pitch = std::acosf(Vector2f(direction.getX(), direction.getZ()).length());
-		m_LightViewMatrix.rotate(pitch, Vector3f(1, 0, 0));
+		m_LightRotation.rotate(pitch, Vector3f(1, 0, 0));
 		float yaw = std::atanf(direction.getX() / direction.getZ());
 		yaw = direction.getZ() > 0 ? yaw - (float)std::_Pi : yaw;
-		m_LightViewMatrix.rotate(-yaw, Vector3f(0, 1, 0));
-		m_LightViewMatrix.translate(center);
-	}
-
-	void ShadowMapMasterRenderer::updateOrthoProjectionMatrix(float width, float height, float length) {
-		m_ProjectionMatrix.identity();
-		m_ProjectionMatrix.set(0, 0, 2.f / width);
-		m_ProjectionMatrix.set(1, 1, 2.f / height);
-		m_ProjectionMatrix.set(2, 2, -2.f / length);
+		m_LightRotation.rotate(-yaw, Vector3f(0, 1, 0));
 	}
 
 	void ShadowMapMasterRenderer::createOffset() {
@@ -81,4 +196,4 @@ namespace Pressure {
 		m_Offset.scale(0.5f);
 	}
 
-}
+}
\ No newline at end of file
@@ -1,44 +1,90 @@
 #pragma once
-#include <unordered_map>
-#include "../GLObjects/FrameBuffer.h"
+#include <vector>
 #include "ShadowShader.h"
 #include "ShadowBox.h"
 #include "ShadowMapEntityRenderer.h"
+#include "../Scene/SceneVisibility.h"
 #include "../Entities/Light.h"
 
 namespace Pressure {
 
+	// Cascaded shadow maps. The view frustum up to the shadow distance is split into slices, each rendered
+	// into its own layer of a depth texture array. The cascade count and layer size come from the properties.
+	//
+	// Static casters are cached in a second array that is only redrawn when the light turns, static entities change
+	// or the cascade's box moves. Each frame the cached layer is copied and dynamic casters are drawn on top,
+	// which is skipped entirely for cascades without dynamic casters.
 	class ShadowMapMasterRenderer {
 
+	public:
+		// Has to match the array sizes in the entity shader.
+		static const unsigned int MAX_CASCADES;
+
 	private:
-		static const int SHADOW_MAP_SIZE;
+		// Blend between logarithmic (1) and uniform (0) split distances.
+		static const float SPLIT_LAMBDA;
+
+		Window& m_Window;
+
+		unsigned int m_CascadeCount;
+		unsigned int m_ShadowMapSize;
+		unsigned int m_FrameBufferID;
+		unsigned int m_ShadowMapID;
+		unsigned int m_StaticFrameBufferID;
+		unsigned int m_StaticShadowMapID;
+
+		// State the static layers were drawn with.
+		Vector3f m_LightDirection;
+		unsigned int m_StaticVersion;
+		// Whether a layer of the shadow map holds more than its static layer.
+		std::vector<bool> m_HasDynamicCasters;
+		// Scene views of the static and dynamic casters of each cascade this frame.
+		std::vector<unsigned int> m_StaticViews;
+		std::vector<unsigned int> m_DynamicViews;
 
-		FrameBuffer m_ShadowFbo;
 		ShadowShader m_Shader;
-		ShadowBox m_ShadowBox;
-		Matrix4f m_ProjectionMatrix;
-		Matrix4f m_LightViewMatrix;
-		Matrix4f m_ProjectionViewMatrix;
+		std::vector<ShadowBox> m_Cascades;
+		float m_ShadowDistance;
+		Matrix4f m_LightRotation;
 		Matrix4f m_Offset;
 
 		ShadowMapEntityRenderer m_EntityRenderer;
+		ShadowMapEntityRenderer::Statistics m_Statistics;
 
 	public:
-		ShadowMapMasterRenderer(Camera& camera, Window& window);
+		ShadowMapMasterRenderer(Camera& camera, Window& window, EntityInstanceBuffer& instances, const bool multiDraw);
 		~ShadowMapMasterRenderer();
-		void render(std::unordered_map<TexturedModel, std::vector<Entity>>& entities, Light& sun);
+		// Moves the cascades to the current camera and light and adds the views their casters are culled for.
+		// Static casters only get a view when the static layer has to be redrawn.
+		void prepareViews(const Scene& scene, Light& sun, SceneVisibility& visibility);
+		// Views recorded by record(), the static and the dynamic casters of every cascade.
+		inline unsigned int getRecordCount() const { return m_CascadeCount * 2; }
+		// Queues and records the casters of one view once they are culled. Makes no GL calls, so the views can be recorded at the same time.
+		void record(const Scene& scene, const SceneVisibility& visibility, const unsigned int view);
+		// Replays the recorded views into the cascades.
+		void render();
 		
-		Matrix4f getToShadowMapSpaceMatrix();
+		Matrix4f getToShadowMapSpaceMatrix(const unsigned int cascade);
+		// View depth up to which the cascade is used.
+		float getCascadeDistance(const unsigned int cascade) const;
+		inline unsigned int getCascadeCount() const { return m_CascadeCount; }
+		inline unsigned int getShadowMapSize() const { return m_ShadowMapSize; }
+		// GL_TEXTURE_2D_ARRAY with one layer per cascade.
 		unsigned int getShadowMap();
 		float getShadowDistance() const;
 		void setShadowDistance(float shadowDistance);
-		Matrix4f& getLightSpaceTransform();
+		// Summed over all cascades.
+		inline const ShadowMapEntityRenderer::Statistics& getStatistics() const { return m_Statistics; }
 
 	private:
-		void prepare(Vector3f& lightDirection, ShadowBox& box);
+		void createShadowMap(unsigned int& textureID, unsigned int& frameBufferID);
+		void attachLayer(const unsigned int frameBufferID, const unsigned int textureID, const unsigned int layer);
+		void copyStaticLayer(const unsigned int layer);
+		void addStatistics();
+		void updateSplits();
+		void prepare();
 		void finish();
-		void updateLightViewMatrix(Vector3f& direction, Vector3f& center);
-		void updateOrthoProjectionMatrix(float width, float height, float length);
+		void updateLightRotation(Vector3f& direction);
 		void createOffset();
 
 	};
@@ -1,5 +1,6 @@
 #include "ShadowShader.h"
 #include "ShadowShaderSource.h"
+#include "../EntityShaders/EntityInstanceBuffer.h"
 
 namespace Pressure {
 
@@ -8,15 +9,16 @@ namespace Pressure {
 	}
 
 	void ShadowShader::getAllUniformLocations() {
-		location_mvpMatrix = Shader::getUniformLocation("mvpMatrix");
+		location_projectionViewMatrix = Shader::getUniformLocation("projectionViewMatrix");
 	}
 
-	void ShadowShader::loadMvpMatrix(Matrix4f& matrix) {
-		Shader::loadMatrix(location_mvpMatrix, matrix);
+	void ShadowShader::loadProjectionViewMatrix(Matrix4f& matrix) {
+		Shader::loadMatrix(location_projectionViewMatrix, matrix);
 	}
 
 	void ShadowShader::bindAttributes() {
 		Shader::bindAttribute(0, "in_position");
+		Shader::bindAttribute(EntityInstanceBuffer::TRANSFORMATION_ATTRIBUTE, "transformationMatrix");
 	}
 
 }
\ No newline at end of file
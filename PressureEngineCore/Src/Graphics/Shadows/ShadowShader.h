@@ -6,12 +6,12 @@ namespace Pressure {
 	class ShadowShader : public Shader {
 
 	private: 
-		int location_mvpMatrix;
+		int location_projectionViewMatrix;
 
 	public: 
 		ShadowShader();
 		void getAllUniformLocations() override;
-		void loadMvpMatrix(Matrix4f& matrix);
+		void loadProjectionViewMatrix(Matrix4f& matrix);
 		void bindAttributes() override;
 
 	};
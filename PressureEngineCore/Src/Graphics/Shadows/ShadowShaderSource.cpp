@@ -6,12 +6,13 @@ namespace Pressure {
 R"(#version 150
 
 in vec3 in_position;
+in mat4 transformationMatrix;
 
-uniform mat4 mvpMatrix;
+uniform mat4 projectionViewMatrix;
 
 void main(void) {
 	
-	gl_Position = mvpMatrix * vec4(in_position, 1.0); 
+	gl_Position = projectionViewMatrix * transformationMatrix * vec4(in_position, 1.0); 
 
 })";
 
@@ -2,6 +2,7 @@
 #include <vector>
 #include "SkyboxShader.h"
 #include "../Loader.h"
+#include "../Window.h"
 
 namespace Pressure {
 
@@ -16,13 +17,17 @@ namespace Pressure {
 		RawModel m_Cube;
 		int m_Texture;
 		SkyboxShader m_Shader;
-		GLFWwindow* const m_Window;
+		const Window& m_Window;
+		// Loaded by the next render(), so the program is not waited for before it is needed.
+		Matrix4f m_ProjectionMatrix;
+		bool m_ProjectionChanged;
 
 	public:
-		SkyboxRenderer(Loader& loader, GLFWwindow* window);
+		SkyboxRenderer(Loader& loader, const Window& window);
 		void updateProjectionMatrix();
 
-		void render(Camera& camera);
+		// Draws with the view bound in FrameUniforms.
+		void render();
 
 	};
 
@@ -14,12 +14,11 @@ namespace Pressure {
 		virtual void getAllUniformLocations() override;
 
 	public:
+		// The view comes from the shared ViewData block.
 		void loadProjectionMatrix(Matrix4f& matrix);
-		void loadViewMatrix(Camera& camera);
 
 	private:
 		int location_projectionMatrix;
-		int location_viewMatrix;
 
 	};
 
@@ -8,12 +8,20 @@ R"(#version 400
 in vec3 position;
 out vec3 textureCoords;
 
+layout (std140) uniform ViewData {
+	mat4 clippedProjectionMatrix; // Unused, the sky keeps a projection without the oblique near plane of the water passes.
+	mat4 viewMatrix;
+	vec4 cameraPosition;
+	vec4 plane;
+};
+
 uniform mat4 projectionMatrix;
-uniform mat4 viewMatrix;
 
 void main(void){
 	
-	gl_Position = projectionMatrix * viewMatrix * vec4(position, 1.0); 
+	// The sky follows the camera, only the rotation of the view applies.
+	mat4 rotation = mat4(mat3(viewMatrix));
+	gl_Position = projectionMatrix * rotation * vec4(position, 1.0); 
 	textureCoords = position;
 	
 })";
@@ -9,6 +9,7 @@
 //**********************************************
 
 #include "TextureManager.h"
+#include "../GLObjects/GLState.h"
 
 #define PRESSURE_CUBE_MAP 0x8513
 #define PRESSURE_CUBE_MAP_POS_X 0x8515
@@ -100,20 +101,20 @@ namespace Pressure {
 
 		//if this texture ID is in use, unload the current texture
 		if (m_texID.find(texID) != m_texID.end())
-			glDeleteTextures(1, &(m_texID[texID]));
+			GLState::deleteTexture(m_texID[texID]);
 
 		//generate an OpenGL texture ID for this texture
 		glGenTextures(1, &gl_texID);
 		//store the texture ID mapping
 		m_texID[texID] = gl_texID;
 		//bind to the new texture ID
-		glBindTexture(GL_TEXTURE_2D, gl_texID);
+		GLState::bindTexture(GL_TEXTURE_2D, gl_texID);
 		//store the texture data for OpenGL use
 		glTexImage2D(GL_TEXTURE_2D, level, internal_format, width, height,
 			border, image_format, GL_UNSIGNED_BYTE, (GLvoid*)bits);
 
 		//unbind the texture.
-		glBindTexture(GL_TEXTURE_2D, NULL);
+		GLState::bindTexture(GL_TEXTURE_2D, NULL);
 
 		//Free FreeImage's copy of the data
 		FreeImage_Unload(dib);
@@ -128,7 +129,7 @@ namespace Pressure {
 		//if this texture ID mapped, unload it's texture, and remove it from the map
 		if (m_texID.find(texID) != m_texID.end())
 		{
-			glDeleteTextures(1, &(m_texID[texID]));
+			GLState::deleteTexture(m_texID[texID]);
 			m_texID.erase(texID);
 		}
 		//otherwise, unload failed
@@ -155,7 +156,7 @@ namespace Pressure {
 
 		//if this texture ID is in use, unload the current texture
 		if (m_texID.find(texID) != m_texID.end())
-			glDeleteTextures(1, &(m_texID[texID]));
+			GLState::deleteTexture(m_texID[texID]);
 
 		//generate an OpenGL texture ID for this texture
 		glGenTextures(1, &gl_texID);
@@ -163,7 +164,7 @@ namespace Pressure {
 		m_texID[texID] = gl_texID;
 
 		//bind to the new texture ID
-		glBindTexture(PRESSURE_CUBE_MAP, gl_texID);
+		GLState::bindTexture(PRESSURE_CUBE_MAP, gl_texID);
 
 		for (unsigned int i = 0; i < files.size(); i++) {
 			const char* file = files[i].c_str();
@@ -213,7 +214,7 @@ namespace Pressure {
 		}
 
 		//unbind the texture.
-		glBindTexture(PRESSURE_CUBE_MAP, NULL);
+		GLState::bindTexture(PRESSURE_CUBE_MAP, NULL);
 
 		//return success
 		return true;
@@ -225,7 +226,7 @@ namespace Pressure {
 		bool result(true);
 		//if this texture ID mapped, bind it's texture as current
 		if (m_texID.find(texID) != m_texID.end())
-			glBindTexture(target, m_texID[texID]);
+			GLState::bindTexture(target, m_texID[texID]);
 		//otherwise, binding failed
 		else
 			result = false;
@@ -234,7 +235,7 @@ namespace Pressure {
 	}
 
 	void TextureManager::UnbindTexture() {
-		glBindTexture(GL_TEXTURE_2D, NULL);
+		GLState::bindTexture(GL_TEXTURE_2D, NULL);
 	}
 
 	void TextureManager::UnloadAllTextures()
@@ -21,17 +21,17 @@ namespace Pressure {
 
 	public:
 		WaterRenderer(Window& window);
-		void updateProjectionmatrix();
 
 		// Used to time the waves.
 		void tick();
-		void render(std::vector<Water>& water, std::vector<Light>& lights, Camera& camera);
+		// Draws with the view bound in FrameUniforms.
+		void render(std::vector<Water>& water);
 
 		FrameBuffer& getReflectionBuffer();
 		FrameBuffer& getRefractionBuffer();
 
 	private:
-		void prepare(std::vector<Water>& water, std::vector<Light>& lights, Camera& camera);
+		void prepare(std::vector<Water>& water);
 		void finish(std::vector<Water>& water);
 
 	};
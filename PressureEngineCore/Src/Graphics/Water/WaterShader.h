@@ -15,25 +15,17 @@ namespace Pressure{
 		virtual void getAllUniformLocations() override;
 
 	public:
+		// The view and the lights come from the shared FrameData and ViewData blocks.
 		void loadTransformationMatrix(Matrix4f& matrix);
-		void loadProjectionMatrix(Matrix4f& matrix);
-		void loadViewMatrix(Camera& camera);
 		void loadWaveModifier(float angle);
-		void loadLights(std::vector<Light>& lights);
-		void connectTextureUnits();
+		void connectTextureUnits() override;
 
 	private:
 		int location_transformationMatrix;
-		int location_projectionMatrix;
-		int location_viewMatrix;
 		int location_waveModifier;
 		int location_reflectionTexture;
 		int location_refractionTexture;
 		int location_depthMap;
-
-		int location_lightPosition[4];
-		int location_lightColor[4];
-		int location_attenuation[4];
 	};
 
 }
\ No newline at end of file
@@ -13,10 +13,25 @@ out vec3 toLightVector[4];
 out vec3 toCameraVector;
 out vec4 clipSpace;
 
+layout (std140) uniform FrameData {
+	vec4 lightPosition[4];
+	vec4 lightColor[4];
+	vec4 attenuation[4];
+	mat4 toShadowMapSpace[4];
+	vec4 cascadeDistances;
+	int cascadeCount;
+	float shadowMapSize;
+	float shadowDistance;
+};
+
+layout (std140) uniform ViewData {
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+	vec4 cameraPosition;
+	vec4 plane;
+};
+
 uniform mat4 transformationMatrix;
-uniform mat4 projectionMatrix;
-uniform mat4 viewMatrix;
-uniform vec3 lightPosition[4];
 
 uniform float waveModifier;
 
@@ -132,9 +147,9 @@ void main(void) {
 	surfaceNormal = (transformationMatrix * vec4(normal, 0.0)).xyz;
 
 	for(int i = 0; i < 4; i++) {
-		toLightVector[i] = normalize(lightPosition[i] - wavePos.xyz);
+		toLightVector[i] = normalize(lightPosition[i].xyz - wavePos.xyz);
 	}
-	toCameraVector = normalize((inverse(viewMatrix) * vec4(0.0, 0.0, 0.0, 1.0)).xyz - wavePos.xyz);
+	toCameraVector = normalize(cameraPosition.xyz - wavePos.xyz);
 	
 	clipSpace = projectionMatrix * viewMatrix * vec4(wavePos, 1.0);
 	gl_Position = clipSpace;
@@ -153,8 +168,16 @@ in vec4 clipSpace;
 layout (location = 0) out vec4 out_Color;
 layout (location = 1) out vec4 out_LightColor;
 
-uniform vec3 lightColor[4];
-uniform vec3 attenuation[4];
+layout (std140) uniform FrameData {
+	vec4 lightPosition[4];
+	vec4 lightColor[4];
+	vec4 attenuation[4];
+	mat4 toShadowMapSpace[4];
+	vec4 cascadeDistances;
+	int cascadeCount;
+	float shadowMapSize;
+	float shadowDistance;
+};
 
 uniform sampler2D reflectionTexture;
 uniform sampler2D refractionTexture;
@@ -195,8 +218,8 @@ void main(void) {
 		float specularFactor = dot(reflectedLightDirection, toCameraVector);
 		specularFactor = max(specularFactor, 0.0);
 		float dampedFactor = pow(specularFactor, shineDamper);
-		totalDiffuse += (brightness * lightColor[i]) / attFactor;
-		totalSpecular += (dampedFactor * reflectivity * lightColor[i]) / attFactor;
+		totalDiffuse += (brightness * lightColor[i].xyz) / attFactor;
+		totalSpecular += (dampedFactor * reflectivity * lightColor[i].xyz) / attFactor;
 	}
 	totalDiffuse = max(totalDiffuse, 0.1);
 	float refractiveFactor = dot(toCameraVector, surfaceNormal);
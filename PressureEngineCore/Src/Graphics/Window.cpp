@@ -53,7 +53,7 @@ namespace Pressure {
 	bool Window::resized = false;
 
 	void Window::window_resize_callback(GLFWwindow* window, int width, int height) {
-		glViewport(0, 0, width, height);
+		// Runs while polling events, which might not be the thread owning the context. The viewport is set on the next frame.
 		resized = true;
 	}
 
@@ -71,9 +71,8 @@ namespace Pressure {
 	}
 
 	void Window::setSize(int width, int height) {
+		// The renderers pick the new size up through the resize callback.
 		glfwSetWindowSize(m_Window, width, height);
-		this->m_Width = width;
-		this->m_Height = height;
 	}
 
 	bool Window::isClosing() const {
@@ -84,13 +83,20 @@ namespace Pressure {
 		glfwSetWindowShouldClose(m_Window, GLFW_TRUE);
 	}
 
-	int Window::getWidth() {
-		glfwGetWindowSize(m_Window, &m_Width, &m_Height);
+	void Window::querySize(int& width, int& height) const {
+		glfwGetWindowSize(m_Window, &width, &height);
+	}
+
+	void Window::resize(int width, int height) {
+		this->m_Width = width;
+		this->m_Height = height;
+	}
+
+	int Window::getWidth() const {
 		return m_Width;
 	}
 
-	int Window::getHeight() {
-		glfwGetWindowSize(m_Window, &m_Width, &m_Height);
+	int Window::getHeight() const {
 		return m_Height;
 	}
 
@@ -9,6 +9,7 @@ namespace Pressure {
 	private:
 		GLFWwindow* m_Window;
 
+		// Size the renderers draw at, only changed by resize() on the thread drawing the frame.
 		int m_Width;
 		int m_Height;
 
@@ -28,8 +29,12 @@ namespace Pressure {
 
 		static bool resized;
 
-		int getWidth();
-		int getHeight();
+		// Asks GLFW for the current size, only allowed on the main thread.
+		void querySize(int& width, int& height) const;
+		// Takes over a size from querySize() once the frame drawn at it begins.
+		void resize(int width, int height);
+		int getWidth() const;
+		int getHeight() const;
 		GLFWwindow* getWindow() const;
 
 		void setVsync(bool enabled);
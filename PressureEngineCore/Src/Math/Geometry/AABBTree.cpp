@@ -0,0 +1,313 @@
+#include "AABBTree.h"
+
+#include <algorithm>
+
+namespace Pressure {
+
+	const int AABBTree::NULL_NODE = -1;
+	const float AABBTree::MARGIN = 0.5f;
+
+	AABBTree::AABBTree()
+		: m_Root(NULL_NODE), m_FreeList(NULL_NODE), m_LeafCount(0) {
+	}
+
+	int AABBTree::insert(const AABB& bounds, const unsigned int userData) {
+		int leaf = allocateNode();
+		Node& node = m_Nodes[leaf];
+		node.min = bounds.getMin();
+		node.max = bounds.getMax();
+		for (int i = 0; i < 3; i++) {
+			node.min[i] -= MARGIN;
+			node.max[i] += MARGIN;
+		}
+		node.userData = userData;
+		node.height = 0;
+
+		insertLeaf(leaf);
+		m_LeafCount++;
+		return leaf;
+	}
+
+	void AABBTree::remove(const int proxy) {
+		removeLeaf(proxy);
+		freeNode(proxy);
+		m_LeafCount--;
+	}
+
+	bool AABBTree::move(const int proxy, const AABB& bounds) {
+		Node& node = m_Nodes[proxy];
+		Vector3f min = bounds.getMin();
+		Vector3f max = bounds.getMax();
+		if (node.min.x <= min.x && node.min.y <= min.y && node.min.z <= min.z
+			&& max.x <= node.max.x && max.y <= node.max.y && max.z <= node.max.z)
+			return false;
+
+		removeLeaf(proxy);
+		for (int i = 0; i < 3; i++) {
+			node.min[i] = min[i] - MARGIN;
+			node.max[i] = max[i] + MARGIN;
+		}
+		insertLeaf(proxy);
+		return true;
+	}
+
+	void AABBTree::clear() {
+		m_Nodes.clear();
+		m_Root = NULL_NODE;
+		m_FreeList = NULL_NODE;
+		m_LeafCount = 0;
+	}
+
+	void AABBTree::getSubtrees(const unsigned int count, std::vector<int>& roots) const {
+		roots.clear();
+		if (m_Root == NULL_NODE)
+			return;
+
+		// Split level by level, the tree is balanced so the subtrees end up of similar size.
+		roots.push_back(m_Root);
+		bool split = true;
+		while (split && roots.size() < count) {
+			split = false;
+			unsigned int levelSize = roots.size();
+			for (unsigned int i = 0; i < levelSize && roots.size() < count; i++) {
+				const Node& node = m_Nodes[roots[i]];
+				if (node.isLeaf())
+					continue;
+				roots[i] = node.left;
+				roots.push_back(node.right);
+				split = true;
+			}
+		}
+	}
+
+	int AABBTree::allocateNode() {
+		int index;
+		if (m_FreeList != NULL_NODE) {
+			index = m_FreeList;
+			m_FreeList = m_Nodes[index].parent;
+		} else {
+			index = m_Nodes.size();
+			m_Nodes.emplace_back();
+		}
+
+		Node& node = m_Nodes[index];
+		node.parent = NULL_NODE;
+		node.left = NULL_NODE;
+		node.right = NULL_NODE;
+		node.height = 0;
+		node.userData = 0;
+		return index;
+	}
+
+	void AABBTree::freeNode(const int node) {
+		m_Nodes[node].parent = m_FreeList;
+		m_Nodes[node].height = -1;
+		m_FreeList = node;
+	}
+
+	void AABBTree::insertLeaf(const int leaf) {
+		if (m_Root == NULL_NODE) {
+			m_Root = leaf;
+			m_Nodes[leaf].parent = NULL_NODE;
+			return;
+		}
+
+		// Walk down to the sibling that increases the total surface area the least.
+		int index = m_Root;
+		while (!m_Nodes[index].isLeaf()) {
+			const Node& node = m_Nodes[index];
+			const Node& left = m_Nodes[node.left];
+			const Node& right = m_Nodes[node.right];
+
+			float nodeArea = area(node.min, node.max);
+			float combined = combinedArea(node, m_Nodes[leaf]);
+
+			// Cost of pairing the leaf with this node under a new parent.
+			float cost = 2.f * combined;
+			// Every ancestor grows by at least this much if the leaf goes further down.
+			float inheritanceCost = 2.f * (combined - nodeArea);
+
+			float costLeft = combinedArea(left, m_Nodes[leaf]) + inheritanceCost;
+			if (!left.isLeaf())
+				costLeft -= area(left.min, left.max);
+			float costRight = combinedArea(right, m_Nodes[leaf]) + inheritanceCost;
+			if (!right.isLeaf())
+				costRight -= area(right.min, right.max);
+
+			if (cost < costLeft && cost < costRight)
+				break;
+			index = costLeft < costRight ? node.left : node.right;
+		}
+
+		int sibling = index;
+		int oldParent = m_Nodes[sibling].parent;
+		int newParent = allocateNode();
+		m_Nodes[newParent].parent = oldParent;
+		m_Nodes[newParent].height = m_Nodes[sibling].height + 1;
+		m_Nodes[newParent].left = sibling;
+		m_Nodes[newParent].right = leaf;
+		combine(sibling, leaf, newParent);
+
+		if (oldParent != NULL_NODE) {
+			if (m_Nodes[oldParent].left == sibling)
+				m_Nodes[oldParent].left = newParent;
+			else
+				m_Nodes[oldParent].right = newParent;
+		} else {
+			m_Root = newParent;
+		}
+		m_Nodes[sibling].parent = newParent;
+		m_Nodes[leaf].parent = newParent;
+
+		refit(newParent);
+	}
+
+	void AABBTree::removeLeaf(const int leaf) {
+		if (leaf == m_Root) {
+			m_Root = NULL_NODE;
+			return;
+		}
+
+		int parent = m_Nodes[leaf].parent;
+		int grandParent = m_Nodes[parent].parent;
+		int sibling = m_Nodes[parent].left == leaf ? m_Nodes[parent].right : m_Nodes[parent].left;
+
+		// The sibling takes the place of the parent.
+		if (grandParent != NULL_NODE) {
+			if (m_Nodes[grandParent].left == parent)
+				m_Nodes[grandParent].left = sibling;
+			else
+				m_Nodes[grandParent].right = sibling;
+			m_Nodes[sibling].parent = grandParent;
+			freeNode(parent);
+			refit(grandParent);
+		} else {
+			m_Root = sibling;
+			m_Nodes[sibling].parent = NULL_NODE;
+			freeNode(parent);
+		}
+	}
+
+	int AABBTree::balance(const int iA) {
+		Node& A = m_Nodes[iA];
+		if (A.isLeaf() || A.height < 2)
+			return iA;
+
+		int iB = A.left;
+		int iC = A.right;
+		Node& B = m_Nodes[iB];
+		Node& C = m_Nodes[iC];
+		int difference = C.height - B.height;
+
+		// Rotate C up.
+		if (difference > 1) {
+			int iF = C.left;
+			int iG = C.right;
+			Node& F = m_Nodes[iF];
+			Node& G = m_Nodes[iG];
+
+			C.left = iA;
+			C.parent = A.parent;
+			A.parent = iC;
+			if (C.parent != NULL_NODE) {
+				if (m_Nodes[C.parent].left == iA)
+					m_Nodes[C.parent].left = iC;
+				else
+					m_Nodes[C.parent].right = iC;
+			} else {
+				m_Root = iC;
+			}
+
+			// The taller grandchild stays under C, the other one moves to A.
+			if (F.height > G.height) {
+				C.right = iF;
+				A.right = iG;
+				G.parent = iA;
+				combine(iB, iG, iA);
+				combine(iA, iF, iC);
+				A.height = 1 + std::max(B.height, G.height);
+				C.height = 1 + std::max(A.height, F.height);
+			} else {
+				C.right = iG;
+				A.right = iF;
+				F.parent = iA;
+				combine(iB, iF, iA);
+				combine(iA, iG, iC);
+				A.height = 1 + std::max(B.height, F.height);
+				C.height = 1 + std::max(A.height, G.height);
+			}
+			return iC;
+		}
+
+		// Rotate B up.
+		if (difference < -1) {
+			int iD = B.left;
+			int iE = B.right;
+			Node& D = m_Nodes[iD];
+			Node& E = m_Nodes[iE];
+
+			B.left = iA;
+			B.parent = A.parent;
+			A.parent = iB;
+			if (B.parent != NULL_NODE) {
+				if (m_Nodes[B.parent].left == iA)
+					m_Nodes[B.parent].left = iB;
+				else
+					m_Nodes[B.parent].right = iB;
+			} else {
+				m_Root = iB;
+			}
+
+			if (D.height > E.height) {
+				B.right = iD;
+				A.left = iE;
+				E.parent = iA;
+				combine(iC, iE, iA);
+				combine(iA, iD, iB);
+				A.height = 1 + std::max(C.height, E.height);
+				B.height = 1 + std::max(A.height, D.height);
+			} else {
+				B.right = iE;
+				A.left = iD;
+				D.parent = iA;
+				combine(iC, iD, iA);
+				combine(iA, iE, iB);
+				A.height = 1 + std::max(C.height, D.height);
+				B.height = 1 + std::max(A.height, E.height);
+			}
+			return iB;
+		}
+
+		return iA;
+	}
+
+	void AABBTree::refit(int node) {
+		while (node != NULL_NODE) {
+			node = balance(node);
+			Node& current = m_Nodes[node];
+			current.height = 1 + std::max(m_Nodes[current.left].height, m_Nodes[current.right].height);
+			combine(current.left, current.right, node);
+			node = current.parent;
+		}
+	}
+
+	void AABBTree::combine(const int a, const int b, const int dest) {
+		const Node& nodeA = m_Nodes[a];
+		const Node& nodeB = m_Nodes[b];
+		Node& node = m_Nodes[dest];
+		node.min = Vector3f(std::min(nodeA.min.x, nodeB.min.x), std::min(nodeA.min.y, nodeB.min.y), std::min(nodeA.min.z, nodeB.min.z));
+		node.max = Vector3f(std::max(nodeA.max.x, nodeB.max.x), std::max(nodeA.max.y, nodeB.max.y), std::max(nodeA.max.z, nodeB.max.z));
+	}
+
+	float AABBTree::area(const Vector3f& min, const Vector3f& max) {
+		float x = max.x - min.x, y = max.y - min.y, z = max.z - min.z;
+		return 2.f * (x * y + y * z + z * x);
+	}
+
+	float AABBTree::combinedArea(const Node& a, const Node& b) {
+		Vector3f min(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z));
+		Vector3f max(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z));
+		return area(min, max);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <vector>
+#include "AABB.h"
+#include "ViewFrustum.h"
+
+namespace Pressure {
+
+	// Dynamic bounding volume hierarchy over fattened AABBs.
+	// Leaves are kept balanced with AVL rotations and placed by a surface area heuristic,
+	// so small movements only touch the tree when an object leaves its fat box.
+	class AABBTree {
+
+	public:
+		const static int NULL_NODE;
+		// Most frustums one multi-view query tests, one bit per view in the view masks.
+		const static unsigned int MAX_VIEWS = 16;
+
+	private:
+		struct Node {
+			Vector3f min;
+			Vector3f max;
+			int parent;		// Next free node while the node is in the free list.
+			int left;
+			int right;
+			int height;		// 0 for leaves, -1 for free nodes.
+			unsigned int userData;
+
+			inline bool isLeaf() const { return left == NULL_NODE; }
+		};
+
+		// How far leaf boxes are extended on every side, in world units.
+		const static float MARGIN;
+		// Balancing keeps the height around 1.44 log2(leaves), far below this.
+		const static int MAX_QUERY_DEPTH = 256;
+
+		std::vector<Node> m_Nodes;
+		int m_Root;
+		int m_FreeList;
+		unsigned int m_LeafCount;
+
+	public:
+		AABBTree();
+
+		// Returns the proxy used to move or remove the leaf.
+		int insert(const AABB& bounds, const unsigned int userData);
+		void remove(const int proxy);
+		// Returns true if the leaf had to be reinserted.
+		bool move(const int proxy, const AABB& bounds);
+
+		void clear();
+
+		// Calls visitor(userData) for every leaf that intersects the planes of the frustum set in planeMask.
+		// Subtrees that are fully inside are accepted without testing their children.
+		template <typename Visitor>
+		void query(const ViewFrustum& frustum, Visitor visitor, const unsigned int planeMask = ViewFrustum::ALL_PLANES) const;
+		// Tests the subtree below root against several frustums in one traversal, so every node is fetched once for all views.
+		// Only the views set in viewMask are tested, each against the planes in its planeMasks entry.
+		// Calls visitor(userData, viewMask) for every leaf visible in at least one view, with the bits of those views set.
+		template <typename Visitor>
+		void query(const ViewFrustum* const* frustums, const unsigned int* planeMasks, const unsigned int viewMask, const int root, Visitor visitor) const;
+
+		// Splits the tree into at least count disjoint subtrees covering every leaf, if it has that many.
+		// Used to spread a query over several threads.
+		void getSubtrees(const unsigned int count, std::vector<int>& roots) const;
+
+		inline unsigned int getUserData(const int proxy) const { return m_Nodes[proxy].userData; }
+		inline unsigned int getLeafCount() const { return m_LeafCount; }
+		inline int getRoot() const { return m_Root; }
+		inline int getHeight() const { return m_Root == NULL_NODE ? 0 : m_Nodes[m_Root].height; }
+
+	private:
+		int allocateNode();
+		void freeNode(const int node);
+
+		void insertLeaf(const int leaf);
+		void removeLeaf(const int leaf);
+		// Rotates the subtree rooted at node if it is imbalanced, returns the new root of the subtree.
+		int balance(const int node);
+		// Recomputes the bounds and height of the ancestors of node, balancing them on the way up.
+		void refit(int node);
+
+		void combine(const int a, const int b, const int dest);
+		static float area(const Vector3f& min, const Vector3f& max);
+		static float combinedArea(const Node& a, const Node& b);
+
+	};
+
+	template <typename Visitor>
+	void AABBTree::query(const ViewFrustum& frustum, Visitor visitor, const unsigned int planeMask) const {
+		if (m_Root == NULL_NODE)
+			return;
+
+		// Each entry carries the planes its node still has to be tested against, an empty mask means fully inside.
+		struct Entry {
+			int node;
+			unsigned int planeMask;
+		};
+		Entry stack[MAX_QUERY_DEPTH];
+		int size = 0;
+		stack[size++] = { m_Root, planeMask };
+
+		while (size > 0) {
+			Entry entry = stack[--size];
+			const Node& node = m_Nodes[entry.node];
+
+			if (entry.planeMask && frustum.classifyAABB(node.min, node.max, entry.planeMask) == ViewFrustum::OUTSIDE)
+				continue;
+
+			if (node.isLeaf()) {
+				visitor(node.userData);
+			} else {
+				stack[size++] = { node.right, entry.planeMask };
+				stack[size++] = { node.left, entry.planeMask };
+			}
+		}
+	}
+
+	template <typename Visitor>
+	void AABBTree::query(const ViewFrustum* const* frustums, const unsigned int* planeMasks, const unsigned int viewMask, const int root, Visitor visitor) const {
+		if (root == NULL_NODE || !viewMask)
+			return;
+
+		// Like the single view query, each entry carries the remaining planes of every view plus the views still active.
+		struct Entry {
+			int node;
+			unsigned int viewMask;
+			unsigned char planeMasks[MAX_VIEWS];
+		};
+		Entry stack[MAX_QUERY_DEPTH];
+		int size = 1;
+		stack[0].node = root;
+		stack[0].viewMask = viewMask;
+		for (unsigned int i = 0; i < MAX_VIEWS; i++)
+			stack[0].planeMasks[i] = viewMask & (1 << i) ? (unsigned char)planeMasks[i] : 0;
+
+		while (size > 0) {
+			Entry entry = stack[--size];
+			const Node& node = m_Nodes[entry.node];
+
+			for (unsigned int views = entry.viewMask; views; views &= views - 1) {
+				unsigned int view = 0;
+				while (!(views & (1 << view)))
+					view++;
+				if (!entry.planeMasks[view])
+					continue;
+				unsigned int planeMask = entry.planeMasks[view];
+				if (frustums[view]->classifyAABB(node.min, node.max, planeMask) == ViewFrustum::OUTSIDE)
+					entry.viewMask &= ~(1 << view);
+				else
+					entry.planeMasks[view] = (unsigned char)planeMask;
+			}
+			if (!entry.viewMask)
+				continue;
+
+			if (node.isLeaf()) {
+				visitor(node.userData, entry.viewMask);
+			} else {
+				stack[size] = entry;
+				stack[size++].node = node.right;
+				stack[size] = entry;
+				stack[size++].node = node.left;
+			}
+		}
+	}
+
+}
\ No newline at end of file
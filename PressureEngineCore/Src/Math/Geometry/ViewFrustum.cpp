@@ -1,15 +1,10 @@
 #include "ViewFrustum.h"
+#include <cmath>
+#include <immintrin.h>
 
 namespace Pressure {
 
-	ViewFrustum* ViewFrustum::m_Inst = nullptr;
-
-	ViewFrustum& ViewFrustum::Inst() {
-		if (!m_Inst)
-			m_Inst = new ViewFrustum();
-		return *m_Inst;
-		
-	}
+	const unsigned int ViewFrustum::ALL_PLANES = 0x3F;
 
 	void ViewFrustum::extractPlanes(const Matrix4f& projectionViewMatrix) {
 		Vector3f n;
@@ -56,12 +51,31 @@ namespace Pressure {
 		m_Planes[5].setNormal(n);
 		m_Planes[5].setDistance(projectionViewMatrix.get(3, 3) + projectionViewMatrix.get(3, 1));
 
-		for (Plane& p : m_Planes) {
-			p.normalize();
+		for (unsigned int i = 0; i < m_Planes.size(); i++) {
+			m_Planes[i].normalize();
+			Vector3f normal = m_Planes[i].getNormal();
+			m_PlaneX[i] = normal.getX();
+			m_PlaneY[i] = normal.getY();
+			m_PlaneZ[i] = normal.getZ();
+			m_PlaneDistance[i] = m_Planes[i].getDistance();
+			m_PlaneAbsX[i] = std::abs(m_PlaneX[i]);
+			m_PlaneAbsY[i] = std::abs(m_PlaneY[i]);
+			m_PlaneAbsZ[i] = std::abs(m_PlaneZ[i]);
 		}
 
 	}
 
+	void ViewFrustum::setClipPlane(const Vector4f& plane) {
+		float length = plane.getXYZ().length();
+		m_PlaneX[PLANE_CLIP] = plane.x / length;
+		m_PlaneY[PLANE_CLIP] = plane.y / length;
+		m_PlaneZ[PLANE_CLIP] = plane.z / length;
+		m_PlaneDistance[PLANE_CLIP] = plane.w / length;
+		m_PlaneAbsX[PLANE_CLIP] = std::abs(m_PlaneX[PLANE_CLIP]);
+		m_PlaneAbsY[PLANE_CLIP] = std::abs(m_PlaneY[PLANE_CLIP]);
+		m_PlaneAbsZ[PLANE_CLIP] = std::abs(m_PlaneZ[PLANE_CLIP]);
+	}
+
 	bool ViewFrustum::pointInFrustum(const Vector3f& point) const {
 		return sphereInFrustum(point, 0);
 	}
@@ -74,26 +88,72 @@ namespace Pressure {
 		return true;
 	}
 
-	bool ViewFrustum::aabbInFrustum(const AABB& bounds) const {
-		Vector3f corners[6];
-
-		corners[0] = Vector3f(bounds.getMax().getX(), bounds.getMax().getY(), bounds.getMin().getZ());
-		corners[1] = Vector3f(bounds.getMax().getX(), bounds.getMin().getY(), bounds.getMin().getZ());
-		corners[2] = Vector3f(bounds.getMax().getX(), bounds.getMin().getY(), bounds.getMax().getZ());
-		corners[3] = Vector3f(bounds.getMin().getX(), bounds.getMax().getY(), bounds.getMin().getZ());
-		corners[4] = Vector3f(bounds.getMin().getX(), bounds.getMin().getY(), bounds.getMin().getZ());
-		corners[5] = Vector3f(bounds.getMin().getX(), bounds.getMin().getY(), bounds.getMax().getZ());
-
-		
-		if (pointInFrustum(bounds.getMin()) || pointInFrustum(bounds.getMax())) {
-			return true;
+	unsigned int ViewFrustum::cullSpheres(const float* x, const float* y, const float* z, const float* radii, const unsigned int count, unsigned int* visible) const {
+		unsigned int visibleCount = 0;
+		unsigned int i = 0;
+
+#ifdef __AVX__
+		for (; i + 8 <= count; i += 8) {
+			__m256 cx = _mm256_loadu_ps(x + i);
+			__m256 cy = _mm256_loadu_ps(y + i);
+			__m256 cz = _mm256_loadu_ps(z + i);
+			__m256 r = _mm256_loadu_ps(radii + i);
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (unsigned int p = 0; p < 6; p++) {
+				__m256 distance = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(m_PlaneX[p])), _mm256_mul_ps(cy, _mm256_set1_ps(m_PlaneY[p])));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(cz, _mm256_set1_ps(m_PlaneZ[p])));
+				distance = _mm256_add_ps(distance, _mm256_add_ps(r, _mm256_set1_ps(m_PlaneDistance[p])));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+			}
+
+			// Branchless compaction, every lane writes but only visible lanes advance the output.
+			int mask = _mm256_movemask_ps(inside);
+			for (unsigned int lane = 0; lane < 8; lane++) {
+				visible[visibleCount] = i + lane;
+				visibleCount += (mask >> lane) & 1;
+			}
+		}
+#endif
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 cx = _mm_loadu_ps(x + i);
+			__m128 cy = _mm_loadu_ps(y + i);
+			__m128 cz = _mm_loadu_ps(z + i);
+			__m128 r = _mm_loadu_ps(radii + i);
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (unsigned int p = 0; p < 6; p++) {
+				__m128 distance = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(m_PlaneX[p])), _mm_mul_ps(cy, _mm_set1_ps(m_PlaneY[p])));
+				distance = _mm_add_ps(distance, _mm_mul_ps(cz, _mm_set1_ps(m_PlaneZ[p])));
+				distance = _mm_add_ps(distance, _mm_add_ps(r, _mm_set1_ps(m_PlaneDistance[p])));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+			}
+
+			int mask = _mm_movemask_ps(inside);
+			for (unsigned int lane = 0; lane < 4; lane++) {
+				visible[visibleCount] = i + lane;
+				visibleCount += (mask >> lane) & 1;
+			}
 		}
 
-		for (const Vector3f& v : corners) {
-			if (pointInFrustum(v)) return true;
+		// Remainder.
+		for (; i < count; i++) {
+			bool inside = true;
+			for (unsigned int p = 0; p < 6 && inside; p++)
+				inside = x[i] * m_PlaneX[p] + y[i] * m_PlaneY[p] + z[i] * m_PlaneZ[p] + radii[i] + m_PlaneDistance[p] >= 0;
+			if (inside)
+				visible[visibleCount++] = i;
 		}
 
-		return false;
+		return visibleCount;
+	}
+
+	ViewFrustum::Intersection ViewFrustum::classifyAABB(const Vector3f& min, const Vector3f& max) const {
+		unsigned int planeMask = ALL_PLANES;
+		return classifyAABB(min, max, planeMask);
+	}
+
+	bool ViewFrustum::aabbInFrustum(const AABB& bounds) const {
+		return classifyAABB(bounds.getMin(), bounds.getMax()) != OUTSIDE;
 	}
 
 }
\ No newline at end of file
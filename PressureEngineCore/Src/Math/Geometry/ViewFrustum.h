@@ -9,26 +9,77 @@ namespace Pressure {
 
 	class ViewFrustum {
 
+	public:
+		enum Intersection {
+			OUTSIDE,
+			INTERSECTING,
+			INSIDE
+		};
+
+		// Plane order of extractPlanes(), as bit indices of the plane masks.
+		// PLANE_CLIP is the optional plane of setClipPlane(), it is not part of ALL_PLANES.
+		enum PlaneIndex {
+			PLANE_NEAR,
+			PLANE_FAR,
+			PLANE_LEFT,
+			PLANE_RIGHT,
+			PLANE_UP,
+			PLANE_DOWN,
+			PLANE_CLIP
+		};
+
+		const static unsigned int ALL_PLANES;
+
 	private:
 		std::array<Plane, 6> m_Planes;
 
-	public:
-		static ViewFrustum& Inst();
+		// The same planes split per component, broadcast by the batched tests. Followed by the clip plane.
+		float m_PlaneX[7];
+		float m_PlaneY[7];
+		float m_PlaneZ[7];
+		float m_PlaneDistance[7];
+		// Absolute normal components, projecting box extents onto the planes.
+		float m_PlaneAbsX[7];
+		float m_PlaneAbsY[7];
+		float m_PlaneAbsZ[7];
 
+	public:
 		void extractPlanes(const Matrix4f& projectionViewMatrix);
+		// World space plane (normal, distance) only the box tests use, when PLANE_CLIP is set in their plane mask.
+		// Boxes fully on the negative side, which the clip distance of a water pass would discard anyway, are rejected.
+		void setClipPlane(const Vector4f& plane);
 
 		bool pointInFrustum(const Vector3f& point) const;
 		bool sphereInFrustum(const Vector3f center, const float radius) const;
-		
-		// Not working as intended.
-		bool aabbInFrustum(const AABB& bounds) const;
 
-	protected:
-		ViewFrustum() { }
-		ViewFrustum(const ViewFrustum& vm) = delete;
-		ViewFrustum& operator=(const ViewFrustum& vm) = delete;
+		// Batched sphere test over SoA arrays, 4 (SSE) or 8 (AVX) spheres at a time.
+		// Writes the indices of the visible spheres to visible, which must hold count entries, and returns how many there are.
+		unsigned int cullSpheres(const float* x, const float* y, const float* z, const float* radii, const unsigned int count, unsigned int* visible) const;
+
+		// Classifies a box against the planes whose bits are set in planeMask. Bits of planes the box is fully
+		// inside of are cleared, so the children of a box that is inside a plane skip testing against it again.
+		Intersection classifyAABB(const Vector3f& min, const Vector3f& max, unsigned int& planeMask) const;
+		Intersection classifyAABB(const Vector3f& min, const Vector3f& max) const;
+		bool aabbInFrustum(const AABB& bounds) const;
 
-		static ViewFrustum* m_Inst;
 	};
 
+	inline ViewFrustum::Intersection ViewFrustum::classifyAABB(const Vector3f& min, const Vector3f& max, unsigned int& planeMask) const {
+		float centerX = (max.x + min.x) * 0.5f, centerY = (max.y + min.y) * 0.5f, centerZ = (max.z + min.z) * 0.5f;
+		float extentX = (max.x - min.x) * 0.5f, extentY = (max.y - min.y) * 0.5f, extentZ = (max.z - min.z) * 0.5f;
+		for (int i = 0; i <= PLANE_CLIP; i++) {
+			if (!(planeMask & (1 << i)))
+				continue;
+
+			// Signed distance of the center against the box extent projected onto the normal.
+			float distance = m_PlaneX[i] * centerX + m_PlaneY[i] * centerY + m_PlaneZ[i] * centerZ + m_PlaneDistance[i];
+			float radius = m_PlaneAbsX[i] * extentX + m_PlaneAbsY[i] * extentY + m_PlaneAbsZ[i] * extentZ;
+			if (distance < -radius)
+				return OUTSIDE;
+			if (distance >= radius)
+				planeMask &= ~(1 << i);
+		}
+		return planeMask ? INTERSECTING : INSIDE;
+	}
+
 }
\ No newline at end of file
@@ -203,9 +203,7 @@ namespace Pressure {
 		return *this;
 	}
 
-	Matrix4f& Matrix4f::createProjectionMatrix(GLFWwindow* window) {
-		int width, height;
-		glfwGetWindowSize(window, &width, &height);
+	Matrix4f& Matrix4f::createProjectionMatrix(const int width, const int height) {
 		float aspectRatio = (float)width / (float)height;
 		float y_scale = 1.f / tanf((float)Math::toRadians(std::stof(Properties::get("fov")) / 2.f));
 		float x_scale = y_scale / aspectRatio;
@@ -221,6 +219,22 @@ namespace Pressure {
 		return *this;
 	}
 
+	Matrix4f& Matrix4f::setObliqueNearPlane(const Vector4f& clipPlane) {
+		// Lengyel, Oblique View Frustum Depth Projection and Clipping.
+		// q is the clip space corner opposite the plane, the far plane is moved to pass through it.
+		float qx = ((clipPlane.x > 0 ? 1.f : clipPlane.x < 0 ? -1.f : 0.f) + get(2, 0)) / get(0, 0);
+		float qy = ((clipPlane.y > 0 ? 1.f : clipPlane.y < 0 ? -1.f : 0.f) + get(2, 1)) / get(1, 1);
+		float qz = -1.f;
+		float qw = (1.f + get(2, 2)) / get(3, 2);
+		float scale = 2.f / (clipPlane.x * qx + clipPlane.y * qy + clipPlane.z * qz + clipPlane.w * qw);
+
+		set(0, 2, clipPlane.x * scale);
+		set(1, 2, clipPlane.y * scale);
+		set(2, 2, clipPlane.z * scale + 1.f);
+		set(3, 2, clipPlane.w * scale);
+		return *this;
+	}
+
 	Matrix4f& Matrix4f::createViewMatrix(Vector3f& position, float pitch, float yaw, float roll) {
 		identity();
 		rotate((float)Math::toRadians(pitch), Vector3f(1, 0, 0));
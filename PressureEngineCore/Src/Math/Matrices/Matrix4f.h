@@ -42,7 +42,10 @@ namespace Pressure {
 		/* MATRIX SPECIFIC FUNCTIONS */
 		Matrix4f& createTransformationMatrix(const Vector2f& translation, const Vector2f& scale);
 		Matrix4f& createTransformationMatrix(const Vector3f& translation, const Vector3f& rotation, const float scale);
-		Matrix4f& createProjectionMatrix(GLFWwindow* window);
+		Matrix4f& createProjectionMatrix(const int width, const int height);
+		// Replaces the near plane of this perspective projection with a view space clip plane, so geometry behind
+		// the plane is clipped by the rasterizer instead of a clip distance. Depth precision gets worse the steeper the plane.
+		Matrix4f& setObliqueNearPlane(const Vector4f& clipPlane);
 		Matrix4f& createViewMatrix(Vector3f& position, float pitch, float yaw, float roll);
 		Matrix4f& translate(const Vector3f& offset, Matrix4f& dest) const;
 		Matrix4f& translate(const Vector3f& offset);
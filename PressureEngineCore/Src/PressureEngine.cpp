@@ -1,8 +1,10 @@
 #include "PressureEngineCore/PressureEngine.h"
+#include "Graphics/Shaders/ProgramCache.h"
 
 namespace Pressure {
 
 	void PressureEngine::init() {
+		m_InitStart = std::chrono::steady_clock::now();
 		// Initialize GLFW.
 		int glfw = glfwInit();
 		PRESSURE_ASSERT(glfw, "GLFW Failed to initialize!");
@@ -13,6 +15,9 @@ namespace Pressure {
 		
 		int glad = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
 		PRESSURE_ASSERT(glad, "GLAD failed to load opengl!");
+		GLState::invalidate();
+		ProgramCache::init();
+		Shader::initParallelCompile();
 
 #ifdef PRESSURE_DEBUG
 		// Enable OpenGL debugging callback.
@@ -25,16 +30,20 @@ namespace Pressure {
 			::ShowWindow(::GetConsoleWindow(), SW_HIDE);
 #endif
 
+		const unsigned int threadCount = std::stoi(Properties::get("threadCount"));
+		m_ThreadPool = threadCount > 0 ? std::make_unique<ThreadPool>(threadCount - 1) : std::make_unique<ThreadPool>();
 		m_Loader = std::make_unique<Loader>();
 		m_Camera = std::make_unique<Camera>();
-		m_Renderer = std::make_unique<MasterRenderer>(*m_Window, *m_Loader, *m_Camera);
+		m_RenderCamera = std::make_unique<Camera>();
+		m_Frame = std::make_unique<FrameSnapshot>();
+		m_Renderer = std::make_unique<MasterRenderer>(*m_Window, *m_Loader, *m_RenderCamera, *m_ThreadPool);
 		m_GuiRenderer = std::make_unique<GuiRenderer>(*m_Loader);
-		ParticleMaster::init(*m_Loader, m_Window->getWindow());		
+		ParticleMaster::init(*m_Loader, *m_Window, *m_ThreadPool);		
 		
 		m_FrameBuffer = std::make_unique<FrameBuffer>(*m_Window, m_Window->getWidth(), m_Window->getHeight(), 2, 4, FrameBuffer::DepthBufferType::RENDER_BUFFER);
 		m_OutputBuffer = std::make_unique<FrameBuffer>(*m_Window, m_Window->getWidth(), m_Window->getHeight(), 1, 1, FrameBuffer::DepthBufferType::TEXTURE);
 		m_LightScatterBuffer = std::make_unique<FrameBuffer>(*m_Window, m_Window->getWidth(), m_Window->getHeight(), 1, 1, FrameBuffer::DepthBufferType::RENDER_BUFFER);
-		PostProcessing::init(*m_Window, *m_Camera, *m_Loader);
+		PostProcessing::init(*m_Window, *m_RenderCamera, *m_Loader);
 
 		m_Initialized = true;
 	}
@@ -43,32 +52,76 @@ namespace Pressure {
 		glfwPollEvents();
 		m_Camera->tick();
 
+		// The frame buffers are remade on the thread drawing the frame.
 		if (m_Window->resized) {
-			m_Renderer->updateProjectionMatrix();
-			PostProcessing::updateProjectionMatrix();
-			ParticleMaster::updateProjectionMatrix(*m_Window);
-			m_FrameBuffer = std::make_unique<FrameBuffer>(*m_Window, m_Window->getWidth(), m_Window->getHeight(), 2, 4, FrameBuffer::DepthBufferType::RENDER_BUFFER);
-			m_OutputBuffer = std::make_unique<FrameBuffer>(*m_Window, m_Window->getWidth(), m_Window->getHeight(), 1, 1, FrameBuffer::DepthBufferType::TEXTURE);
-			m_LightScatterBuffer = std::make_unique<FrameBuffer>(*m_Window, m_Window->getWidth(), m_Window->getHeight(), 1, 1, FrameBuffer::DepthBufferType::RENDER_BUFFER);
+			FrameSnapshot& frame = getFrame();
+			frame.resized = true;
+			m_Window->querySize(frame.width, frame.height);
 			m_Window->resized = false;
 		}
 
-		m_Renderer->tick();
+		// Wind and waves advance on the thread using them.
+		if (m_RenderThread)
+			getFrame().ticks++;
+		else
+			m_Renderer->tick();
 		ParticleMaster::tick(*m_Camera);
 	}
 
-	void PressureEngine::process(Entity& entity) {
-		m_Renderer->processEntity(entity);
+	SceneHandle PressureEngine::add(const Entity& entity) {
+		if (!m_RenderThread)
+			return m_Renderer->getScene().add(entity);
+
+		FrameSnapshot& frame = getFrame();
+		SceneHandle handle = m_RenderThread->allocate();
+		frame.edits.push_back({ FrameSnapshot::SceneEdit::ADD, handle, (unsigned int) frame.entities.size() });
+		frame.entities.push_back(entity);
+		return handle;
+	}
+
+	std::vector<SceneHandle> PressureEngine::add(const std::vector<Entity>& entities) {
+		std::vector<SceneHandle> handles;
+		handles.reserve(entities.size());
+		for (const auto& entity : entities) {
+			handles.push_back(add(entity));
+		}
+		return handles;
+	}
+
+	void PressureEngine::remove(const SceneHandle& handle) {
+		if (!m_RenderThread) {
+			m_Renderer->getScene().remove(handle);
+			return;
+		}
+
+		if (!m_RenderThread->release(handle)) {
+			PRESSURE_LOG(LOG_WARNING, "Tried to remove an entity through an invalid scene handle.");
+			return;
+		}
+		getFrame().edits.push_back({ FrameSnapshot::SceneEdit::REMOVE, handle, 0 });
 	}
 
-	void PressureEngine::process(std::vector<Entity>& entities) {
-		for (auto& entity : entities) {
-			process(entity);
+	void PressureEngine::update(const SceneHandle& handle, const Entity& entity) {
+		if (!m_RenderThread) {
+			m_Renderer->getScene().update(handle, entity);
+			return;
 		}
+
+		if (!m_RenderThread->isValid(handle)) {
+			PRESSURE_LOG(LOG_WARNING, "Tried to update an entity through an invalid scene handle.");
+			return;
+		}
+		FrameSnapshot& frame = getFrame();
+		frame.edits.push_back({ FrameSnapshot::SceneEdit::UPDATE, handle, (unsigned int) frame.entities.size() });
+		frame.entities.push_back(entity);
+	}
+
+	Scene& PressureEngine::getScene() {
+		return m_Renderer->getScene();
 	}
 
 	void PressureEngine::process(Water& water) {
-		m_Renderer->processWater(water);
+		getFrame().water.push_back(water);
 	}
 
 	void PressureEngine::process(std::vector<Water>& water) {
@@ -78,45 +131,174 @@ namespace Pressure {
 	}
 
 	void PressureEngine::process(Light& light) {
-		m_Lights.push_back(light);
+		getFrame().lights.push_back(light);
 	}
 
 	void PressureEngine::process(std::vector<Light>& light) {
-		m_Lights.insert(std::end(m_Lights), std::begin(light), std::end(light));
+		std::vector<Light>& lights = getFrame().lights;
+		lights.insert(std::end(lights), std::begin(light), std::end(light));
 	}
 
 	void PressureEngine::process(GuiTexture& gui) {
-		m_Guis.push_back(gui);
+		getFrame().guis.push_back(gui);
 	}
 
 	void PressureEngine::process(std::vector<GuiTexture>& gui) {
-		m_Guis.insert(std::end(m_Guis), std::begin(gui), std::end(gui));
+		std::vector<GuiTexture>& guis = getFrame().guis;
+		guis.insert(std::end(guis), std::begin(gui), std::end(gui));
 	}
 
 	void PressureEngine::render() {
-		if (m_Lights.size() > 0)
-			m_Renderer->renderShadowMap(m_Lights[0]);
-		m_Renderer->renderWaterFrameBuffers(m_Lights, *m_Camera);
+		FrameSnapshot& frame = getFrame();
+		frame.camera = *m_Camera;
+		if (!m_RenderThread) {
+			drawFrame(frame);
+			frame.clear();
+			return;
+		}
+
+		// The particles keep ticking on this thread while the render thread draws them.
+		frame.particles = ParticleMaster::getParticles();
+		m_RenderThread->submit();
+	}
+
+	void PressureEngine::startRenderThread() {
+		if (m_RenderThread)
+			return;
+
+		m_RenderThread = std::make_unique<RenderThread>();
+		// Whatever was processed so far goes into the first threaded frame.
+		m_RenderThread->getSnapshot() = std::move(*m_Frame);
+		m_Frame->clear();
+		m_RenderThread->start(m_Window->getWindow(), m_Renderer->getScene(), [this](FrameSnapshot& frame) { drawFrame(frame); });
+	}
+
+	FrameSnapshot& PressureEngine::getFrame() {
+		return m_RenderThread ? m_RenderThread->getSnapshot() : *m_Frame;
+	}
+
+	void PressureEngine::drawFrame(FrameSnapshot& frame) {
+		if (frame.resized) {
+			m_Window->resize(frame.width, frame.height);
+			glViewport(0, 0, m_Window->getWidth(), m_Window->getHeight());
+			m_Renderer->updateProjectionMatrix();
+			PostProcessing::updateProjectionMatrix();
+			ParticleMaster::updateProjectionMatrix(*m_Window);
+			m_FrameBuffer = std::make_unique<FrameBuffer>(*m_Window, m_Window->getWidth(), m_Window->getHeight(), 2, 4, FrameBuffer::DepthBufferType::RENDER_BUFFER);
+			m_OutputBuffer = std::make_unique<FrameBuffer>(*m_Window, m_Window->getWidth(), m_Window->getHeight(), 1, 1, FrameBuffer::DepthBufferType::TEXTURE);
+			m_LightScatterBuffer = std::make_unique<FrameBuffer>(*m_Window, m_Window->getWidth(), m_Window->getHeight(), 1, 1, FrameBuffer::DepthBufferType::RENDER_BUFFER);
+		}
+		for (unsigned int i = 0; i < frame.ticks; i++)
+			m_Renderer->tick();
+
+		Scene& scene = m_Renderer->getScene();
+		for (const FrameSnapshot::SceneEdit& edit : frame.edits) {
+			switch (edit.type) {
+			case FrameSnapshot::SceneEdit::ADD:
+				scene.add(edit.handle, frame.entities[edit.entity]);
+				break;
+			case FrameSnapshot::SceneEdit::UPDATE:
+				scene.update(edit.handle, frame.entities[edit.entity]);
+				break;
+			case FrameSnapshot::SceneEdit::REMOVE:
+				scene.remove(edit.handle);
+				break;
+			}
+		}
+		for (Water& water : frame.water)
+			m_Renderer->processWater(water);
+		*m_RenderCamera = frame.camera;
+
+		GLState::resetCounters();
+		Shader::resolveCompleted();
+		scene.flush(*m_ThreadPool);
+		m_Renderer->cullViews(frame.lights, *m_RenderCamera);
+		m_Renderer->recordPasses(frame.lights, *m_RenderCamera);
+		if (frame.lights.size() > 0)
+			m_Renderer->renderShadowMap();
+		m_Renderer->renderWaterFrameBuffers(frame.lights, *m_RenderCamera);
 
 		m_FrameBuffer->bind();
-		m_Renderer->render(m_Lights, *m_Camera);
-		ParticleMaster::renderParticles(*m_Camera);
+		m_Renderer->render(frame.lights, *m_RenderCamera);
+		if (m_RenderThread)
+			ParticleMaster::renderParticles(frame.particles, *m_RenderCamera);
+		else
+			ParticleMaster::renderParticles(*m_RenderCamera);
 		m_FrameBuffer->unbind();
 		m_FrameBuffer->resolve(0, *m_OutputBuffer);
 		m_FrameBuffer->resolve(1, *m_LightScatterBuffer);
-		PostProcessing::process(*m_OutputBuffer, m_LightScatterBuffer->getColorTexture(), m_Lights[0].getPosition());
+		PostProcessing::process(*m_OutputBuffer, m_LightScatterBuffer->getColorTexture(), frame.lights[0].getPosition());
 
-		m_GuiRenderer->render(m_Guis);
+		m_GuiRenderer->render(frame.guis);
 		
 		m_Window->swapBuffers();
-		m_Lights.clear();
-		m_Guis.clear();
+
+		// Published for the game thread, which may read them while the next frame is drawn.
+		m_OccludedCount = m_Renderer->getOccludedCount();
+		m_TriangleCount = m_Renderer->getRenderer().getStatistics().triangles;
+		m_ShadowTriangleCount = frame.lights.size() > 0 ? m_Renderer->getShadowStatistics().triangles : 0;
+		const EntityRenderer::Statistics& statistics = m_Renderer->getRenderer().getStatistics();
+		m_DrawCallCount = statistics.drawCalls;
+		m_StateChangeCount = statistics.vertexArrayBinds + statistics.textureBinds + statistics.cullingChanges + statistics.shaderBinds;
+		m_DepthPrePassTime = m_Renderer->getRenderer().getDepthPassTime();
+		m_EntityPassTime = m_Renderer->getRenderer().getColorPassTime();
+
+		if (m_TimeToFirstFrame == 0) {
+			// The shaders are only waited for when first used, so everything they cost shows up by now.
+			// A start that had to compile any program is cold, one served entirely by the shader cache is warm.
+			const float timeToFirstFrame = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_InitStart).count();
+			m_TimeToFirstFrame = timeToFirstFrame;
+			const ProgramCache::Statistics& shaders = ProgramCache::getStatistics();
+			PRESSURE_LOG(LOG_INFO, "First frame after " << timeToFirstFrame << " ms, " << (shaders.compiled > 0 ? "cold" : "warm") << " start. Shader programs: "
+				<< shaders.loaded << " from the cache in " << shaders.loadMilliseconds << " ms, " << shaders.compiled << " compiled in " << shaders.compileMilliseconds << " ms.");
+			ProgramCache::save();
+		}
+	}
+
+	unsigned int PressureEngine::getOccludedCount() const {
+		return m_OccludedCount;
+	}
+
+	unsigned int PressureEngine::getTriangleCount() const {
+		return m_TriangleCount;
+	}
+
+	unsigned int PressureEngine::getShadowTriangleCount() const {
+		return m_ShadowTriangleCount;
+	}
+
+	unsigned int PressureEngine::getDrawCallCount() const {
+		return m_DrawCallCount;
+	}
+
+	unsigned int PressureEngine::getStateChangeCount() const {
+		return m_StateChangeCount;
+	}
+
+	void PressureEngine::setDepthPrePass(const bool enabled) {
+		m_Renderer->getRenderer().setDepthPrePass(enabled);
+	}
+
+	float PressureEngine::getDepthPrePassTime() const {
+		return m_DepthPrePassTime;
+	}
+
+	float PressureEngine::getEntityPassTime() const {
+		return m_EntityPassTime;
 	}
 
 	RawModel PressureEngine::loadObjModel(const char* fileName) {
 		return OBJLoader::load(fileName, *m_Loader);	
 	}
 
+	RawModel PressureEngine::loadOccluderModel(const char* fileName) {
+		std::vector<float> positions;
+		std::vector<unsigned int> indices;
+		RawModel model = OBJLoader::load(fileName, *m_Loader, &positions, &indices);
+		m_Renderer->addOccluder(model, positions, indices);
+		return model;
+	}
+
 	ModelTexture PressureEngine::loadTexture(const char* filePath) {
 		return ModelTexture(m_Loader->loadTexture(filePath));		
 	}
@@ -125,6 +307,10 @@ namespace Pressure {
 		return TexturedModel(loadObjModel(objName), loadTexture(texturePath));
 	}
 
+	void PressureEngine::addImpostor(const TexturedModel& model, const float distance) {
+		m_Renderer->addImpostor(model, distance);
+	}
+
 	ParticleTexture PressureEngine::loadParticleTexture(const char* filePath, const unsigned int numberOfRows, const bool additiveBlending) {
 		return ParticleTexture(m_Loader->loadTexture(filePath), numberOfRows, additiveBlending);
 	}
@@ -151,8 +337,15 @@ namespace Pressure {
 	}
 
 	void PressureEngine::terminate() {
+		// Draws the last submitted frame and brings the context back to this thread.
+		if (m_RenderThread) {
+			m_RenderThread->stop();
+			m_RenderThread.reset();
+		}
 		m_Renderer->cleanUp();
 		ParticleMaster::cleanUp();
+		// The shader variants compiled while rendering have been stored by now.
+		ProgramCache::save(true);
 		glfwTerminate();
 	}
 
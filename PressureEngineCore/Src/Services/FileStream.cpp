@@ -34,4 +34,26 @@ namespace Pressure {
 		return true;
 	}
 
+	bool FileStream::readBinary(const char* filename, std::vector<char>& content) {
+		std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+		if (!file.is_open())
+			return false;
+
+		content.resize((const unsigned int)file.tellg());
+		file.seekg(0, std::ios::beg);
+		file.read(content.data(), content.size());
+		return !file.fail();
+	}
+
+	bool FileStream::writeBinary(const char* filename, const std::vector<char>& content) {
+		std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		file.write(content.data(), content.size());
+		return !file.fail();
+	}
+
 }
\ No newline at end of file
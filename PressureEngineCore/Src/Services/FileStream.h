@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace Pressure {
 
@@ -11,6 +12,9 @@ namespace Pressure {
 
 		static std::shared_ptr<std::string> read(const char* filename);
 		static bool write(const char* filename, const char* content);
+		// Without newline translation, for data that is not text.
+		static bool readBinary(const char* filename, std::vector<char>& content);
+		static bool writeBinary(const char* filename, const std::vector<char>& content);
 
 	};
 
@@ -19,7 +19,13 @@ namespace Pressure {
 	}
 
 	std::string Properties::get(const char* property) {
-		return std::string(Inst()->m_Properties[property]);
+		auto it = Inst()->m_Properties.find(property);
+		if (it != Inst()->m_Properties.end())
+			return it->second;
+
+		// Property files written before a property was added do not contain it.
+		auto fallback = s_Defaults.find(property);
+		return fallback != s_Defaults.end() ? fallback->second : std::string();
 	}
 
 	void Properties::set(const char* property, const char* value) {
@@ -71,6 +77,22 @@ namespace Pressure {
 
 		{ "renderGrass", "1" },
 		{ "useDepthOfField", "1" },
+		{ "waterObliqueClipping", "0" },	// Skips the clip distance, but changes the refraction depth the water edges fade with.
+
+		{ "shadowCascades", "3" },	// 1 - 4
+		{ "shadowMapSize", "2048" },
+		{ "multiDrawIndirect", "1" },	// Needs OpenGL 4.3, ignored otherwise.
+		{ "vertexQuantization", "1" },	// 16-bit texture coordinates and packed normals.
+		{ "lodLevels", "3" },	// Simplified levels generated per mesh, 0 - 3.
+		{ "lodShadowBias", "0.5" },	// Below 1 the shadow map uses coarser levels.
+		{ "lodWaterBias", "0.5" },	// Below 1 the water reflection and refraction use coarser levels.
+		{ "impostorResolution", "128" },	// Size of each of the views baked into an impostor atlas.
+		{ "occlusionCulling", "1" },	// Hides entities behind the models loaded as occluders, tested on the CPU.
+		{ "depthPrePass", "0" },	// Lays down the depth of opaque entities before shading them, pays off with a lot of overdraw.
+		{ "entityGeometryShader", "1" },	// Averages texture coordinates and normals per face in a geometry shader. 0 takes those of the last vertex instead, cheaper but not the same look.
+		{ "shaderCache", "pressure.shadercache" },	// Linked shader programs kept between runs, empty to always compile. Needs OpenGL 4.1.
+		{ "renderThread", "0" },	// Draws on a thread of its own one frame behind the game, assets have to be loaded before it starts.
+		{ "threadCount", "0" },	// Threads sharing the frame work, the one drawing included. 0 uses every core.
 
 		{ "mouseLookSensitivity", "1.0" }
 
@@ -0,0 +1,161 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace Pressure {
+
+	// Pool and deque of the worker running on this thread, nullptr outside of any pool.
+	static thread_local const ThreadPool* t_Pool = nullptr;
+	static thread_local unsigned int t_Queue = 0;
+
+	ThreadPool::Counter::Counter()
+		: m_Pending(0) {
+	}
+
+	ThreadPool::ThreadPool(unsigned int workerCount)
+		: m_Queued(0), m_Running(true) {
+		for (unsigned int i = 0; i <= workerCount; i++)
+			m_Queues.push_back(std::make_unique<Queue>());
+		for (unsigned int i = 0; i < workerCount; i++)
+			m_Workers.emplace_back(&ThreadPool::work, this, i);
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Running = false;
+		}
+		m_Condition.notify_all();
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	void ThreadPool::run(const std::function<void()>& job, Counter& counter) {
+		counter.m_Pending++;
+		push({ job, &counter });
+	}
+
+	void ThreadPool::run(const std::function<void()>& job, Counter& counter, Counter& dependency) {
+		counter.m_Pending++;
+		{
+			std::lock_guard<std::mutex> lock(dependency.m_Mutex);
+			if (dependency.m_Pending > 0) {
+				dependency.m_Dependents.push_back({ job, &counter });
+				return;
+			}
+		}
+		push({ job, &counter });
+	}
+
+	void ThreadPool::wait(Counter& counter) {
+		Job job;
+		while (!counter.isDone()) {
+			if (take(job))
+				execute(job);
+			else
+				std::this_thread::yield();
+		}
+		// The last job might still be releasing the counter's dependents.
+		std::lock_guard<std::mutex> lock(counter.m_Mutex);
+	}
+
+	void ThreadPool::parallelFor(const unsigned int count, const unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& function) {
+		if (count == 0)
+			return;
+
+		if (count <= grainSize || m_Workers.empty()) {
+			function(0, count);
+			return;
+		}
+
+		Counter counter;
+		split(0, count, grainSize, function, counter);
+		wait(counter);
+	}
+
+	unsigned int ThreadPool::getDefaultWorkerCount() {
+		return std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0;
+	}
+
+	void ThreadPool::push(const Job& job) {
+		{
+			// Counted first so m_Queued never drops below the jobs in the deques, under the lock so a worker about to sleep cannot miss it.
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Queued++;
+		}
+		Queue& queue = *m_Queues[getQueueIndex()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.jobs.push_back(job);
+		}
+		m_Condition.notify_one();
+	}
+
+	bool ThreadPool::take(Job& job) {
+		const unsigned int own = getQueueIndex();
+		for (unsigned int i = 0; i < m_Queues.size(); i++) {
+			// Own deque first, then the others in turn, starting past it so the thieves spread out.
+			Queue& queue = *m_Queues[(own + i) % m_Queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.jobs.empty())
+				continue;
+
+			if (i == 0) {
+				job = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+			} else {
+				job = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+			}
+			m_Queued--;
+			return true;
+		}
+		return false;
+	}
+
+	void ThreadPool::execute(Job& job) {
+		job.function();
+
+		Counter& counter = *job.counter;
+		std::vector<Job> dependents;
+		{
+			std::lock_guard<std::mutex> lock(counter.m_Mutex);
+			if (--counter.m_Pending == 0)
+				dependents.swap(counter.m_Dependents);
+		}
+		for (const Job& dependent : dependents)
+			push(dependent);
+	}
+
+	void ThreadPool::split(unsigned int begin, unsigned int end, const unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& function, Counter& counter) {
+		// Keeps the front half and forks the back half, until the range fits the grain.
+		while (end - begin > grainSize) {
+			const unsigned int middle = begin + (end - begin + 1) / 2;
+			run([this, middle, end, grainSize, &function, &counter]() { split(middle, end, grainSize, function, counter); }, counter);
+			end = middle;
+		}
+		function(begin, end);
+	}
+
+	unsigned int ThreadPool::getQueueIndex() const {
+		return t_Pool == this ? t_Queue : m_Workers.size();
+	}
+
+	void ThreadPool::work(const unsigned int index) {
+		t_Pool = this;
+		t_Queue = index;
+
+		Job job;
+		while (true) {
+			if (take(job)) {
+				execute(job);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]() { return !m_Running || m_Queued > 0; });
+			if (!m_Running && m_Queued == 0)
+				return;
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <vector>
+#include "../DllExport.h"
+
+namespace Pressure {
+
+	// Work-stealing scheduler for splitting CPU side frame work (culling, instance data, recording) into jobs.
+	// Every worker has a deque of its own, taking its newest job from the back while idle workers steal the oldest
+	// from the front of the others. Threads waiting for jobs run other jobs meanwhile, so jobs can fork and join jobs themselves.
+	// GL calls must stay on the thread owning the context, only hand plain data processing to the pool.
+	class PRESSURE_API ThreadPool {
+
+	public:
+		class Counter;
+
+	private:
+		struct Job {
+			std::function<void()> function;
+			Counter* counter;
+		};
+
+		struct Queue {
+			std::deque<Job> jobs;
+			std::mutex mutex;
+		};
+
+	public:
+		// Jobs of the counter that have not finished yet. Jobs depending on the counter start once it reaches zero.
+		class PRESSURE_API Counter {
+
+		private:
+			friend class ThreadPool;
+
+			std::atomic<unsigned int> m_Pending;
+			std::vector<Job> m_Dependents;
+			std::mutex m_Mutex;
+
+		public:
+			Counter();
+
+			inline bool isDone() const { return m_Pending == 0; }
+
+		private:
+			Counter(const Counter& counter) = delete;
+			Counter& operator=(const Counter& counter) = delete;
+
+		};
+
+	private:
+		std::vector<std::thread> m_Workers;
+		// One per worker, the last one is shared by the threads outside the pool.
+		std::vector<std::unique_ptr<Queue>> m_Queues;
+		// Jobs in all queues, idle workers sleep while there are none.
+		std::atomic<unsigned int> m_Queued;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Running;
+
+	public:
+		ThreadPool(unsigned int workerCount = getDefaultWorkerCount());
+		~ThreadPool();
+
+		// Queues job on the calling thread's deque, counter is done once it and every other job of the counter ran.
+		void run(const std::function<void()>& job, Counter& counter);
+		// Like run(), but the job is only queued once dependency is done.
+		void run(const std::function<void()>& job, Counter& counter, Counter& dependency);
+		// Runs queued jobs on the calling thread until the counter is done.
+		void wait(Counter& counter);
+
+		// Splits [0, count) into ranges of at most grainSize and runs function(begin, end) for each of them
+		// on the workers and the calling thread. Ranges are forked by halving, so idle threads steal large pieces first.
+		// Returns once every range is done, and can be called from within jobs.
+		void parallelFor(const unsigned int count, const unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& function);
+
+		// Workers plus the calling thread.
+		inline unsigned int getThreadCount() const { return m_Workers.size() + 1; }
+
+		// One worker less than the core count, the calling thread works as well.
+		static unsigned int getDefaultWorkerCount();
+
+	private:
+		ThreadPool(const ThreadPool& pool) = delete;
+		ThreadPool& operator=(const ThreadPool& pool) = delete;
+
+		void push(const Job& job);
+		// Newest job of the calling thread's deque, else the oldest of another one.
+		bool take(Job& job);
+		void execute(Job& job);
+		void split(unsigned int begin, unsigned int end, const unsigned int grainSize, const std::function<void(unsigned int, unsigned int)>& function, Counter& counter);
+		// Deque of the calling thread, the shared one for threads outside the pool.
+		unsigned int getQueueIndex() const;
+
+		void work(const unsigned int index);
+
+	};
+
+}
\ No newline at end of file
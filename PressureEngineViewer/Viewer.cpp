@@ -10,6 +10,7 @@ namespace PressureEngineViewer {
 		PressureEngine engine;
 
 		std::vector<Entity> entities;
+		std::vector<SceneHandle> handles;
 		std::vector<Light> lights;
 		ParticleSystem* particleSystem;
 		std::vector<Water> waters;
@@ -20,6 +21,9 @@ namespace PressureEngineViewer {
 		EngineViewer() : r(-2, 2) {
 			engine.init();
 			init();
+			// Everything is loaded by now, so the context can move to the render thread.
+			if (std::stoi(Properties::get("renderThread")))
+				engine.startRenderThread();
 			loop();
 		}
 
@@ -28,7 +32,7 @@ namespace PressureEngineViewer {
 			//entities.emplace_back(mclaren, Vector3f(0), Vector3f(0), 0.1);
 
 			// Island
-			RawModel islandModel = engine.loadObjModel("Island");
+			RawModel islandModel = engine.loadOccluderModel("Island");
 			ModelTexture islandTexture(engine.loadTexture("Island.png"));
 			islandTexture.setShineDamper(10);
 			islandTexture.setReflectivity(.1f);
@@ -52,9 +56,14 @@ namespace PressureEngineViewer {
 			treeModel.setWindAffected(true);
 			ModelTexture treeTexture = engine.loadTexture("Tree.png");
 			TexturedModel tree(treeModel, treeTexture);
+			// Mostly seen from across the island, so the coarser levels take over earlier than by default.
+			tree.setLodScreenSize(1, 0.4f);
+			tree.setLodScreenSize(2, 0.2f);
+			tree.setLodScreenSize(3, 0.08f);
+			engine.addImpostor(tree, 80);
 			entities.emplace_back(tree, Vector3f(-31.5, 12.2, -14), Vector3f(3, 0, 0), 8.0);
 
-			RawModel houseModel = engine.loadObjModel("House");
+			RawModel houseModel = engine.loadOccluderModel("House");
 			ModelTexture houseTexture = engine.loadTexture("House.png");
 			TexturedModel house(houseModel, houseTexture);
 			entities.emplace_back(house, Vector3f(22, 0.2, -3), Vector3f(0, -84, 0), 1.8);
@@ -83,6 +92,8 @@ namespace PressureEngineViewer {
 			bush2Model.setWindAffected(true);
 			TexturedModel bush(bushModel, bushTexture);
 			TexturedModel bush2(bush2Model, bushTexture);
+			engine.addImpostor(bush, 50);
+			engine.addImpostor(bush2, 50);
 			// Behind house
 			entities.emplace_back(bush2, Vector3f(34.5, 1, 0), Vector3f(0, 0, 0), 10.0);
 			entities.emplace_back(bush, Vector3f(37.5, 1, 4), Vector3f(0, 70, 0), 9.0);
@@ -106,6 +117,7 @@ namespace PressureEngineViewer {
 			RawModel tree2Model = engine.loadObjModel("Tree2");
 			tree2Model.setWindAffected(true);
 			TexturedModel tree2(tree2Model, treeTexture);
+			engine.addImpostor(tree2, 80);
 			entities.emplace_back(tree2, Vector3f(32.5, 12.4, -10.5), Vector3f(0, 0, 0), 8.0);
 
 			RawModel tombstoneModel = engine.loadObjModel("Tombstone");
@@ -169,6 +181,8 @@ namespace PressureEngineViewer {
 				ModelTexture grassTexture(engine.loadTexture("Grass.png"));
 				TexturedModel grass(grassModel, grassTexture);
 				TexturedModel grass2(grass2Model, grassTexture);
+				engine.addImpostor(grass, 35);
+				engine.addImpostor(grass2, 35);
 				setGrassPatch(-38, 1, -12, grass, grass2, -0.2, 0);
 				setGrassPatch(-39.5, 1.2, -9, grass, grass2, -0.25, .05);
 				setGrassPatch(-40, 1.1, -5, grass, grass2, -0.45, -.25);
@@ -209,6 +223,8 @@ namespace PressureEngineViewer {
 
 			ParticleTexture particleTex = engine.loadParticleTexture("WaterParticles.png", 4, false);
 			particleSystem = new ParticleSystem(particleTex, 128, (Vector3f&)Vector3f(-.09, 0, 0), 0.01, 1.4 * 60);
+
+			handles = engine.add(entities);
 		}
 
 		void loop() {
@@ -237,7 +253,9 @@ namespace PressureEngineViewer {
 				if (Math::getTimeMillis() - timer > 1000) {
 					timer += 1000;
 
-					PRESSURE_LOG(LOG_INFO, std::string("FPS: ") + std::to_string(frames));
+					PRESSURE_LOG(LOG_INFO, std::string("FPS: ") + std::to_string(frames) + ", triangles: " + std::to_string(engine.getTriangleCount())
+						+ ", shadow triangles: " + std::to_string(engine.getShadowTriangleCount()) + ", draw calls: " + std::to_string(engine.getDrawCallCount())
+						+ ", state changes: " + std::to_string(engine.getStateChangeCount()));
 					frames = 0;
 				}
 #endif
@@ -248,8 +266,11 @@ namespace PressureEngineViewer {
 			if (particleSystem)
 				particleSystem->generateParticles((Vector3f&)Vector3f(-41, 0, 3), Vector3f(.2, .1, 2));
 			engine.tick();
-			for (auto& entity : entities) {
-				entity.tick();
+			for (unsigned int i = 0; i < entities.size(); i++) {
+				if (entities[i].isMoving()) {
+					entities[i].tick();
+					engine.update(handles[i], entities[i]);
+				}
 			}
 
 			if (Keyboard::isPressed(GLFW_KEY_ESCAPE))
@@ -264,7 +285,6 @@ namespace PressureEngineViewer {
 		}
 
 		void render() {
-			engine.process(entities);
 			engine.process(waters);
 			engine.process(lights);
 			//GuiTexture gui(3, (Vector2f&)Vector2f(0.5), (Vector2f&)Vector2f(0.5), false);